@@ -21,6 +21,7 @@
 #define __KNOR_BIND_KMEANSPP_HPP__
 
 #include "kmeans_task_coordinator.hpp"
+#include "kmeans_multi_coordinator.hpp"
 
 namespace kprune = knor::prune;
 
@@ -104,5 +105,75 @@ std::pair<std::pair<unsigned, double>, cluster_t> kmeansPP(
     auto _ = std::pair<unsigned, double>(best_start, best_energy);
     return std::pair<std::pair<unsigned, double>, cluster_t>(_, best_cluster_t);
 }
+
+/**
+  * Run nstart restarts of kmeans concurrently, sharing each pass over the
+  *  data, and keep the restart with the lowest energy. With max_iters=0 this
+  *  is kmeansPP with all seedings computed in k passes instead of nstart*k.
+  */
+std::pair<std::pair<unsigned, double>, cluster_t> kmeans_multi(
+        double* data, const size_t nrow,
+        const size_t ncol, const unsigned k, const unsigned nstart=1,
+        const unsigned max_iters=0, unsigned nthread=get_num_omp_threads(),
+        std::string dist_type="eucl", const double tolerance=-1,
+        std::string init="kmeanspp") {
+
+    auto coord = std::static_pointer_cast<kmeans_multi_coordinator>(
+            kmeans_multi_coordinator::create(
+            "", nrow, ncol, k, max_iters, get_num_nodes(), nthread, nstart,
+            init, tolerance, dist_type));
+
+    cluster_t best_cluster_t = coord->run(data);
+
+    auto _ = std::pair<unsigned, double>(coord->get_best_start(),
+            coord->get_energy(coord->get_best_start()-1));
+    return std::pair<std::pair<unsigned, double>, cluster_t>(_, best_cluster_t);
+}
+
+std::pair<std::pair<unsigned, double>, cluster_t> kmeans_multi(
+        std::string datafn, const size_t nrow,
+        const size_t ncol, const unsigned k, const unsigned nstart=1,
+        const unsigned max_iters=0, unsigned nthread=get_num_omp_threads(),
+        std::string dist_type="eucl", const double tolerance=-1,
+        std::string init="kmeanspp") {
+
+    auto coord = std::static_pointer_cast<kmeans_multi_coordinator>(
+            kmeans_multi_coordinator::create(
+            datafn, nrow, ncol, k, max_iters, get_num_nodes(), nthread,
+            nstart, init, tolerance, dist_type));
+
+    cluster_t best_cluster_t = coord->run();
+
+    auto _ = std::pair<unsigned, double>(coord->get_best_start(),
+            coord->get_energy(coord->get_best_start()-1));
+    return std::pair<std::pair<unsigned, double>, cluster_t>(_, best_cluster_t);
+}
+
+/**
+  * Cluster the data for every k in ks in the same passes over the data.
+  *  Returns ((energy, BIC), clustering) for each k, in the order of ks.
+  */
+std::vector<std::pair<std::pair<double, double>, cluster_t> > kmeans_sweep(
+        std::string datafn, const size_t nrow, const size_t ncol,
+        const std::vector<unsigned>& ks, const unsigned max_iters,
+        unsigned nthread=get_num_omp_threads(),
+        std::string init="kmeanspp", const double tolerance=-1,
+        std::string dist_type="eucl", double* data=NULL) {
+
+    auto coord = std::static_pointer_cast<kmeans_multi_coordinator>(
+            kmeans_multi_coordinator::create(
+            datafn, nrow, ncol, ks, max_iters, get_num_nodes(), nthread,
+            init, tolerance, dist_type));
+    coord->run(data);
+
+    std::vector<std::pair<std::pair<double, double>, cluster_t> > ret;
+    for (unsigned start = 0; start < coord->get_nstart(); start++) {
+        auto _ = std::pair<double, double>(coord->get_energy(start),
+                coord->get_bic(start));
+        ret.push_back(std::pair<std::pair<double, double>, cluster_t>(
+                    _, coord->get_start(start)));
+    }
+    return ret;
+}
 } } // End namespace knor::base
 #endif
@@ -45,6 +45,7 @@ int main(int argc, char* argv[]) {
     std::string outdir = "";
     unsigned min_clust_size = 2;
     short strictness = 4;
+    size_t ad_bins = 0;
 
     cxxopts::Options options(argv[0],
             "gmeans data-file nsamples dim kmax [alg-options]\n");
@@ -75,6 +76,8 @@ int main(int argc, char* argv[]) {
             cxxopts::value<std::string>())
       ("S,strictness", "Anderson Darling Strictness",
             cxxopts::value<short>(strictness))
+      ("b,ad_bins", "Approximate the AD statistic with this many buckets "
+            "instead of sorting (0)", cxxopts::value<size_t>(ad_bins))
       ("o,outdir", "Write output to an output directory of this name",
             cxxopts::value<std::string>(outdir))
       ("h,help", "Print help");
@@ -131,7 +134,8 @@ int main(int argc, char* argv[]) {
     auto coord =
         knor::gmeans_coordinator::create(datafn, nrow, ncol, kmax,
                 max_iters, nnodes, nthread,(centers.size() ? &centers[0] : NULL),
-                init, tolerance, dist_type, min_clust_size, strictness);
+                init, tolerance, dist_type, min_clust_size, strictness,
+                ad_bins);
 
     auto ret = coord->run();
     if (!outdir.empty()) {
@@ -40,9 +40,10 @@ int main(int argc, char* argv[]) {
         std::string centersfn = "";
         unsigned max_iters=std::numeric_limits<unsigned>::max();
         std::string init = "random";
-        double tolerance = -1;
+        double tolerance = 1E-3;
         unsigned nnodes = kbase::get_num_nodes();
         double cov_regularizer = 1E-6;
+        std::string cov_type = "full";
         std::string outdir = "";
 
         cxxopts::Options options(argv[0],
@@ -64,6 +65,8 @@ int main(int argc, char* argv[]) {
              cxxopts::value<unsigned>(max_iters))
             ("c,cov_reg", "covariance regularizer",
              cxxopts::value<std::string>())
+            ("s,cov_type", "Covariance type [full,diag,spherical,tied]",
+             cxxopts::value<std::string>(cov_type))
             ("C,centersfn", "Path to centroids on disk",
              cxxopts::value<std::string>(centersfn), "FILE")
             ("t,init", "The type of initialization",
@@ -72,7 +75,7 @@ int main(int argc, char* argv[]) {
              cxxopts::value<unsigned>(nnodes))
             ("d,dist", "Distance metric [eucl,cos,taxi]",
              cxxopts::value<std::string>(dist_type))
-            ("l,tol", "tolerance for convergence (1E-6)",
+            ("l,tol", "Mean log-likelihood convergence tolerance (1E-3)",
              cxxopts::value<std::string>())
             ("o,outdir", "Write output to an output directory of this name",
              cxxopts::value<std::string>(outdir))
@@ -132,7 +135,7 @@ int main(int argc, char* argv[]) {
         knor::coordinator::ptr kc =
             knor::gmm_coordinator::create(datafn, nrow, ncol, k,
                     max_iters, p_centers, nnodes, nthread,
-                    init, tolerance, dist_type, cov_regularizer);
+                    init, tolerance, dist_type, cov_regularizer, cov_type);
         ret = std::static_pointer_cast<knor::gmm_coordinator>(kc)->soft_run();
 
         //if (!outdir.empty()) {
@@ -45,6 +45,9 @@ int main(int argc, char* argv[]) {
     unsigned nthread = kbase::get_num_omp_threads();
     std::string dist_type = "eucl";
     unsigned nstarts = 10;
+    unsigned max_iters = 0;
+    double tolerance = -1;
+    bool concurrent = false;
 
     unsigned nnodes = kbase::get_num_nodes();
     std::string outdir = "";
@@ -66,6 +69,12 @@ int main(int argc, char* argv[]) {
             cxxopts::value<unsigned>(nthread))
       ("s,num_starts", "maximum number of iterations",
             cxxopts::value<unsigned>(nstarts))
+      ("c,concurrent", "Run all starts together in shared data passes",
+            cxxopts::value<bool>(concurrent))
+      ("i,iters", "Lloyd iterations per start (only with -c)",
+            cxxopts::value<unsigned>(max_iters))
+      ("l,tol", "Convergence tolerance per start (only with -c)",
+            cxxopts::value<std::string>())
       ("N,nnodes", "No. of numa nodes you want to use",
             cxxopts::value<unsigned>(nnodes))
       ("d,dist", "Distance metric [eucl,cos]",
@@ -94,6 +103,8 @@ int main(int argc, char* argv[]) {
             "Data file name doesn't exit!");
     size_t nrow = atol(options["nsamples"].as<std::string>().c_str());
     size_t ncol = atol(options["dim"].as<std::string>().c_str());
+    if (options.count("tol"))
+        tolerance = std::stod(options["tol"].as<std::string>());
 
     if (outdir.empty())
         fprintf(stderr, "\n\n**[WARNING]**: No output dir specified with '-o' "
@@ -103,8 +114,10 @@ int main(int argc, char* argv[]) {
         throw kbase::io_exception("File size does not match input size.");
 
 
-    auto ret = kbase::kmeansPP(datafn, nrow, ncol, k, nstarts,
-            nthread, dist_type);
+    auto ret = concurrent ?
+        kbase::kmeans_multi(datafn, nrow, ncol, k, nstarts, max_iters,
+                nthread, dist_type, tolerance) :
+        kbase::kmeansPP(datafn, nrow, ncol, k, nstarts, nthread, dist_type);
     printf("Best start: %u, Best energy: %f\n", ret.first.first, ret.first.second);
     printf("Best Clustering: \n") ;
     kbase::print(ret.second.assignment_count);
@@ -25,6 +25,12 @@
 
 #include "dist_task_coordinator.hpp"
 #include "dist_coordinator.hpp"
+#include "dist_hclust_coordinator.hpp"
+#include "dist_xmeans_coordinator.hpp"
+#include "dist_gmeans_coordinator.hpp"
+#include "dist_fcm_coordinator.hpp"
+#include "dist_gmm_coordinator.hpp"
+#include "shm_transport.hpp"
 #include "io.hpp"
 #include "util.hpp"
 
@@ -46,22 +52,36 @@ int main(int argc, char* argv[]) {
     size_t ncol = atol(argv[3]);
     unsigned k = atol(argv[4]);
 
-    std::string dist_type = "eucl";
+    std::string dist_type = ""; // Per alg default, sqeucl for fcm
     std::string centersfn = "";
 	unsigned max_iters=std::numeric_limits<unsigned>::max();
-	std::string init = "kmeanspp";
+	std::string init = ""; // Per alg default, e.g. kmeanspp for kmeans
 	unsigned nthread = kbase::get_num_omp_threads();
 	int num_opts = 0;
 	double tolerance = -1;
     bool no_prune = false;
+    unsigned overlap_chunks = 0;
+    std::string read_mode = "thread";
+    std::string partition = "even";
+    double rebalance_tol = 0;
+    unsigned mb_size = 0;
+    bool float_reduce = false;
+    std::string alg = "kmeans";
+    unsigned min_clust_size = 2;
+    short strictness = 4;
+    size_t ad_bins = 1024;
+    unsigned fuzzindex = 2;
+    std::string cov_type = "full";
+    double cov_regularizer = 1E-6;
     unsigned nnodes = kbase::get_num_nodes();
     std::string outdir = "";
+    int local_procs = 0;
 
     // Increase by 3 -- getopt ignores argv[0]
 	argv += 3;
 	argc -= 3;
 
-	while ((opt = getopt(argc, argv, "l:i:t:T:d:C:PN:o:")) != -1) {
+	while ((opt = getopt(argc, argv, "l:i:t:T:d:C:PN:o:O:R:W:B:M:FA:s:S:b:z:c:V:L:")) != -1) {
 		num_opts++;
 		switch (opt) {
 			case 'l':
@@ -103,43 +123,214 @@ int main(int argc, char* argv[]) {
 				outdir = std::string(optarg);
 				num_opts++;
 				break;
+			case 'O':
+				overlap_chunks = atoi(optarg);
+				num_opts++;
+				break;
+			case 'R':
+				read_mode = std::string(optarg);
+				num_opts++;
+				break;
+			case 'W':
+				partition = std::string(optarg);
+				num_opts++;
+				break;
+			case 'B':
+				rebalance_tol = atof(optarg);
+				num_opts++;
+				break;
+			case 'M':
+				mb_size = atoi(optarg);
+				num_opts++;
+				break;
+			case 'F':
+				float_reduce = true;
+				num_opts++;
+				break;
+			case 'A':
+				alg = std::string(optarg);
+				num_opts++;
+				break;
+			case 's':
+				min_clust_size = atoi(optarg);
+				num_opts++;
+				break;
+			case 'S':
+				strictness = atoi(optarg);
+				num_opts++;
+				break;
+			case 'b':
+				ad_bins = atol(optarg);
+				num_opts++;
+				break;
+			case 'z':
+				fuzzindex = atoi(optarg);
+				num_opts++;
+				break;
+			case 'c':
+				cov_regularizer = atof(optarg);
+				num_opts++;
+				break;
+			case 'V':
+				cov_type = std::string(optarg);
+				num_opts++;
+				break;
+			case 'L':
+				local_procs = atoi(optarg);
+				num_opts++;
+				break;
 			default:
 				print_usage();
                 exit(EXIT_FAILURE);
 		}
 	}
 
+    const bool hierarchical = alg == "hmeans" || alg == "xmeans" ||
+        alg == "gmeans";
+    const bool mixture = alg == "fcm" || alg == "gmm";
+    if (!hierarchical && !mixture && alg != "kmeans")
+        throw kbase::parameter_exception("Unknown algorithm '" + alg + "'");
+    if (init.empty())
+        init = alg == "kmeans" ? "kmeanspp" :
+            (alg == "gmm" ? "random" : "forgy");
+    // As the single node fcm
+    if (dist_type.empty())
+        dist_type = alg == "fcm" ? "sqeucl" : "eucl";
+    // Soft algs only stop on tolerance, so give them a sane one
+    if (mixture && tolerance < 0)
+        tolerance = alg == "fcm" ? 1E-6 : 1E-3;
+    // Sampled means keep moving ~1/iteration so -l alone may never stop it
+    if (mb_size && max_iters == std::numeric_limits<unsigned>::max())
+        throw kbase::parameter_exception(
+                "Mini-batch (-M) needs a maximum number of iterations (-i)");
+
     kbase::assert_msg(!(init=="none" && centersfn.empty()),
             "Centers file name doesn't exit!");
 
     if (kbase::filesize(datafn.c_str()) != (sizeof(double)*nrow*ncol))
         throw kbase::io_exception("File size does not match input size.");
 
+    // Only the forked procs go on, the launcher waits for them
+    int status;
+    if (local_procs && !knor::mpi::shm_transport::launch(local_procs, status))
+        return status;
+
     double* p_centers = NULL;
 
     if (kbase::is_file_exist(centersfn.c_str())) {
-        p_centers = new double [k*ncol];
-        kbase::bin_io<double> br2(centersfn, k, ncol);
+        // The hierarchical algs start from the 2 centers of the first split
+        const unsigned ncenters = hierarchical ? 2 : k;
+        p_centers = new double [ncenters*ncol];
+        kbase::bin_io<double> br2(centersfn, ncenters, ncol);
         br2.read(p_centers);
         printf("Read centers!\n");
     }
 
-    kbase::cluster_t ret; // Only root fills this
+    kbase::cluster_t ret; // Centroids & counts, assignments go to outdir
+
+    if (alg != "kmeans") {
+        if (no_prune || overlap_chunks || read_mode != "thread" ||
+                rebalance_tol > 0 || mb_size || float_reduce)
+            fprintf(stderr, "[WARNING]: -P, -O, -R, -B, -M and -F only apply"
+                    " to kmeans, ignoring them\n");
+
+        if (alg == "hmeans") {
+            knor::coordinator::ptr dc =
+                knor::dist::dist_hclust_coordinator::create(argc, argv,
+                        datafn, nrow, ncol, k, max_iters, nnodes, nthread,
+                        p_centers, init, tolerance, dist_type, min_clust_size,
+                        partition);
+            std::static_pointer_cast<knor::dist::dist_hclust_coordinator>(
+                    dc)->run(ret, outdir);
+        } else if (alg == "xmeans") {
+            knor::coordinator::ptr dc =
+                knor::dist::dist_xmeans_coordinator::create(argc, argv,
+                        datafn, nrow, ncol, k, max_iters, nnodes, nthread,
+                        p_centers, init, tolerance, dist_type, min_clust_size,
+                        partition);
+            std::static_pointer_cast<knor::dist::dist_xmeans_coordinator>(
+                    dc)->run(ret, outdir);
+        } else if (alg == "gmeans") {
+            knor::coordinator::ptr dc =
+                knor::dist::dist_gmeans_coordinator::create(argc, argv,
+                        datafn, nrow, ncol, k, max_iters, nnodes, nthread,
+                        p_centers, init, tolerance, dist_type, min_clust_size,
+                        strictness, ad_bins, partition);
+            std::static_pointer_cast<knor::dist::dist_gmeans_coordinator>(
+                    dc)->run(ret, outdir);
+        } else if (alg == "fcm") {
+            knor::coordinator::ptr dc =
+                knor::dist::dist_fcm_coordinator::create(argc, argv,
+                        datafn, nrow, ncol, k, max_iters, nnodes, nthread,
+                        p_centers, init, tolerance, dist_type, fuzzindex,
+                        partition);
+            std::static_pointer_cast<knor::dist::dist_fcm_coordinator>(
+                    dc)->run(ret, outdir);
+        } else {
+            knor::coordinator::ptr dc =
+                knor::dist::dist_gmm_coordinator::create(argc, argv,
+                        datafn, nrow, ncol, k, max_iters, p_centers, nnodes,
+                        nthread, init, tolerance, dist_type, cov_regularizer,
+                        cov_type, partition);
+            std::static_pointer_cast<knor::dist::dist_gmm_coordinator>(
+                    dc)->run(ret, outdir);
+        }
+
+        if (p_centers) delete [] p_centers;
+        return EXIT_SUCCESS;
+    }
+
+    if (rebalance_tol > 0 && !no_prune)
+        fprintf(stderr, "[WARNING]: Rebalancing (-B) needs -P, ignoring it\n");
+
+    if (overlap_chunks && no_prune)
+        fprintf(stderr, "[WARNING]: With -P there is no work to overlap the"
+                " chunked (-O) reduction with\n");
+
+    if (float_reduce && overlap_chunks)
+        fprintf(stderr, "[WARNING]: Overlapped (-O) reductions stay double,"
+                " ignoring -F\n");
+
+    if (mb_size && no_prune) {
+        fprintf(stderr, "[WARNING]: Mini-batch (-M) ignores -P\n");
+        no_prune = false;
+    }
 
     if (no_prune) {
         knor::dist::dist_coordinator::ptr dc =
             knor::dist::dist_coordinator::create(argc, argv,
                     datafn, nrow, ncol, k, max_iters, nnodes, nthread,
-                    p_centers, init, tolerance, dist_type);
+                    p_centers, init, tolerance, dist_type, partition);
+        std::static_pointer_cast<knor::dist::dist_coordinator>(
+                dc)->set_overlap(overlap_chunks);
+        std::static_pointer_cast<knor::dist::dist_coordinator>(
+                dc)->set_read_mode(read_mode);
+        std::static_pointer_cast<knor::dist::dist_coordinator>(
+                dc)->set_float_reduce(float_reduce);
+        std::static_pointer_cast<knor::dist::dist_coordinator>(
+                dc)->set_rebalance(rebalance_tol);
         std::static_pointer_cast<knor::dist::dist_coordinator>(
                 dc)->run(ret, outdir);
     } else {
         knor::prune::dist_task_coordinator::ptr dc =
             knor::prune::dist_task_coordinator::create(argc, argv,
                     datafn, nrow, ncol, k, max_iters, nnodes, nthread,
-                    p_centers, init, tolerance, dist_type);
+                    p_centers, init, tolerance, dist_type, partition);
         std::static_pointer_cast<knor::prune::dist_task_coordinator>(
-                dc)->run(ret, outdir);
+                dc)->set_overlap(overlap_chunks);
+        std::static_pointer_cast<knor::prune::dist_task_coordinator>(
+                dc)->set_read_mode(read_mode);
+        std::static_pointer_cast<knor::prune::dist_task_coordinator>(
+                dc)->set_float_reduce(float_reduce);
+        if (mb_size) {
+            std::static_pointer_cast<knor::prune::dist_task_coordinator>(
+                    dc)->set_mini_batch_size(mb_size);
+            std::static_pointer_cast<knor::prune::dist_task_coordinator>(
+                    dc)->mb_run(ret, outdir);
+        } else {
+            std::static_pointer_cast<knor::prune::dist_task_coordinator>(
+                    dc)->run(ret, outdir);
+        }
     }
 
     if (p_centers) delete [] p_centers;
@@ -149,15 +340,53 @@ int main(int argc, char* argv[]) {
 void print_usage() {
 	fprintf(stderr,
             "mpirun.mpich -n NUM_PROCS knord data-file nsamples"
-            " dim k [alg-options]\n");
-    fprintf(stderr, "-t type: type of initialization for kmeans"
-           " ['random', 'forgy', 'kmeanspp', 'none']\n");
+            " dim k [alg-options]\n"
+            "   or: knord data-file nsamples dim k -L NUM_PROCS"
+            " [alg-options]\n");
+    fprintf(stderr, "-t type: type of initialization for kmeans & gmm"
+           " ['random', 'forgy', 'kmeanspp', 'none'], the hierarchical algs"
+           " & fcm support 'forgy' & 'none'\n");
     fprintf(stderr, "-T num_thread: The number of threads per process\n");
     fprintf(stderr, "-i iters: maximum number of iterations\n");
     fprintf(stderr, "-C File with initial clusters in same format as data\n");
     fprintf(stderr, "-l tolerance for convergence (1E-6)\n");
-    fprintf(stderr, "-d Distance metric [eucl,cos]\n");
+    fprintf(stderr, "-d Distance metric [eucl,sqeucl,cos] (eucl, sqeucl for"
+            " fcm)\n");
     fprintf(stderr, "-P DO NOT use the minimal triangle inequality (~Elkan's alg)\n");
     fprintf(stderr, "-N No. of numa nodes you want to use\n");
     fprintf(stderr, "-o Write output to an output directory of this name\n");
+    fprintf(stderr, "-O nchunks: Reduce centroids in this many non-blocking"
+            " chunks (0 = blocking). Only the pruned path gains, it computes"
+            " each chunk's centroid distances while later chunks are in"
+            " flight\n");
+    fprintf(stderr, "-R mode: How procs read the data ['thread' each thread"
+            " freads, 'mpiio' one collective read per proc, 'node' one"
+            " reader per node]\n");
+    fprintf(stderr, "-W partition: Rows per proc ['even', 'auto' by"
+            " calibrated throughput, or per proc weights e.g. '1,1,2']\n");
+    fprintf(stderr, "-B tol: With -P, move rows between procs when the"
+            " slowest E-step exceeds the mean by this fraction for 3"
+            " iterations running, or by twice it once (0 = never)\n");
+    fprintf(stderr, "-F Reduce centroids as float offsets from the last"
+            " means (half the bytes) until under 0.1%% of rows change, then"
+            " recompute them and reduce in double\n");
+    fprintf(stderr, "-M mb_size: Run mini-batch kmeans drawing batches of"
+            " ~mb_size rows across all procs, requires -i\n");
+    fprintf(stderr, "-A alg: The algorithm ['kmeans', 'fcm', 'gmm', or"
+            " 'hmeans', 'xmeans', 'gmeans' with k the max number of"
+            " clusters]\n");
+    fprintf(stderr, "-s min_clust_size: hmeans, xmeans & gmeans don't split"
+            " smaller clusters (2)\n");
+    fprintf(stderr, "-S strictness: gmeans Anderson Darling strictness"
+            " [0-4] (4)\n");
+    fprintf(stderr, "-b ad_bins: gmeans bins the AD statistic of larger"
+            " partitions in this many buckets, smaller ones are gathered"
+            " and sorted (1024, 0 = always gather)\n");
+    fprintf(stderr, "-z fuzzindex: fcm fuzziness index [1,inf) (2)\n");
+    fprintf(stderr, "-c cov_reg: gmm covariance regularizer (1E-6)\n");
+    fprintf(stderr, "-V cov_type: gmm covariance type [full,diag,spherical,"
+            "tied] (full). It is -s in gmm but -s is min_clust_size here\n");
+    fprintf(stderr, "-L nprocs: Fork nprocs local procs that communicate"
+            " over shared memory instead of launching with mpirun. -R must"
+            " be 'thread'\n");
 }
\ No newline at end of file
@@ -31,6 +31,9 @@
 
 #include "kmeans_coordinator.hpp"
 #include "kmeans_task_coordinator.hpp"
+#include "kmeans_multi_coordinator.hpp"
+#include "coreset.hpp"
+#include "row_dedup.hpp"
 #include "util.hpp"
 
 #include "cxxopts/cxxopts.hpp"
@@ -53,6 +56,11 @@ int main(int argc, char* argv[])
     std::string init = "kmeanspp";
     double tolerance = -1;
 
+    unsigned kmin = 0;
+    size_t coreset_size = 0;
+    bool unique = false;
+    unsigned approx_degree = 0;
+    unsigned ef_search = 32;
     bool no_prune = false;
     bool omp = false;
 
@@ -81,6 +89,18 @@ int main(int argc, char* argv[])
             cxxopts::value<std::string>(centersfn), "FILE")
       ("t,init", "The type of initialization",
             cxxopts::value<std::string>(init))
+      ("K,kmin", "Sweep every k in kmin..k over the data in one run",
+            cxxopts::value<unsigned>(kmin))
+      ("S,coreset-size", "Cluster a weighted coreset of this many draws, "
+            "then assign all rows in one pass (kmeans only, no other knor"
+            " algorithm weighs rows)", cxxopts::value<std::string>())
+      ("u,unique", "Collapse duplicate rows into weighted unique rows",
+            cxxopts::value<bool>(unique))
+      ("A,approx", "Approximate assignment via a centroid graph of this "
+            "degree, for very large k (implies -P)",
+            cxxopts::value<unsigned>(approx_degree))
+      ("e,ef", "Search beam width with -A: higher is slower, more exact",
+            cxxopts::value<unsigned>(ef_search))
       ("O,omp", "Use OpenMP for ||ization rather than fast pthreads",
             cxxopts::value<bool>(omp))
       ("P,prune", "DO NOT use the minimal triangle inequality (~Elkan's alg)",
@@ -117,6 +137,9 @@ int main(int argc, char* argv[])
     size_t ncol = atol(options["dim"].as<std::string>().c_str());
     if (options.count("tol"))
         tolerance = std::stod(options["tol"].as<std::string>());
+    if (options.count("coreset-size"))
+        coreset_size = atol(
+                options["coreset-size"].as<std::string>().c_str());
     if (options.count("centersfn")) {
         kbase::assert_msg(kbase::is_file_exist(centersfn.c_str()),
                 "Centers file name doesn't exit!");
@@ -133,6 +156,77 @@ int main(int argc, char* argv[])
     if (kbase::filesize(datafn.c_str()) != (sizeof(double)*nrow*ncol))
         throw kbase::io_exception("File size does not match input size.");
 
+    if (kmin) {
+        kbase::assert_msg(kmin <= k, "kmin must be <= k");
+        std::vector<unsigned> ks;
+        for (unsigned sk = kmin; sk <= k; sk++)
+            ks.push_back(sk);
+
+        std::shared_ptr<knor::kmeans_multi_coordinator> kc =
+            std::static_pointer_cast<knor::kmeans_multi_coordinator>(
+                knor::kmeans_multi_coordinator::create(datafn, nrow, ncol,
+                    ks, max_iters, nnodes, nthread, init, tolerance,
+                    dist_type));
+        kc->run();
+        printf("Best k by BIC: %u\n", kc->get_k(kc->get_best_start()-1));
+
+        if (!outdir.empty()) {
+            for (unsigned start = 0; start < kc->get_nstart(); start++) {
+                std::string kdir = outdir + "/k" +
+                    std::to_string(kc->get_k(start));
+                printf("\nWriting output to '%s'\n", kdir.c_str());
+                kc->get_start(start).write(kdir);
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (coreset_size) {
+        kbase::assert_msg(centersfn.empty() && !omp,
+                "A coreset can't be used with '-C' or '-O'");
+        knor::coreset::ptr cs = knor::coreset::create(datafn, nrow, ncol, k,
+                coreset_size, nnodes, nthread, dist_type);
+        kbase::assert_msg(cs->get_nrow() >= k,
+                "Coreset has fewer distinct rows than 'k'");
+
+        // Cluster the in-memory weighted coreset. kmeans++ reuses the seeds
+        //  the coreset was sampled with.
+        const double* cs_centers = NULL;
+        if (init == "kmeanspp") {
+            cs_centers = cs->get_seeds();
+            init = "none";
+        }
+
+        kbase::cluster_t cs_ret;
+        if (no_prune) {
+            knor::kmeans_coordinator::ptr kc =
+                knor::kmeans_coordinator::create("", cs->get_nrow(), ncol, k,
+                    max_iters, nnodes, nthread, cs_centers, init, tolerance,
+                    dist_type);
+            kc->set_thd_weights_ptr(cs->get_weights());
+            cs_ret = kc->run(cs->get_data());
+        } else {
+            kprune::kmeans_task_coordinator::ptr kc =
+                kprune::kmeans_task_coordinator::create("", cs->get_nrow(),
+                    ncol, k, max_iters, nnodes, nthread, cs_centers, init,
+                    tolerance, dist_type);
+            kc->set_thd_weights_ptr(cs->get_weights());
+            cs_ret = kc->run(cs->get_data());
+        }
+
+        // Map back onto the full data with one assignment pass
+        knor::kmeans_coordinator::ptr kc = knor::kmeans_coordinator::create(
+                datafn, nrow, ncol, k, 1, nnodes, nthread,
+                &cs_ret.centroids[0], "none", tolerance, dist_type);
+        kbase::cluster_t ret = kc->run();
+
+        if (!outdir.empty()) {
+            printf("\nWriting output to '%s'\n", outdir.c_str());
+            ret.write(outdir);
+        }
+        return EXIT_SUCCESS;
+    }
+
     double* p_centers = NULL;
     kbase::cluster_t ret;
 
@@ -171,17 +265,33 @@ int main(int argc, char* argv[])
         delete [] p_data;
     } else {
 #endif
-        if (no_prune) {
-            knor::kmeans_coordinator::ptr kc =
-                knor::kmeans_coordinator::create(datafn,
-                    nrow, ncol, k, max_iters, nnodes, nthread, p_centers,
-                    init, tolerance, dist_type);
-            ret = kc->run();
+        // Cluster the weighted unique rows & expand the result
+        kbase::row_dedup::ptr dedup = nullptr;
+        if (unique) {
+            kbase::bin_io<double> br(datafn, nrow, ncol);
+            std::vector<double> p_data(nrow*ncol);
+            br.read(&p_data[0]);
+            dedup = kbase::row_dedup::create(&p_data[0], nrow, ncol);
+            kbase::assert_msg(dedup->get_nrow() >= k,
+                    "Fewer unique rows than 'k'");
+        }
+        const std::string run_fn = dedup ? "" : datafn;
+        const size_t run_nrow = dedup ? dedup->get_nrow() : nrow;
+
+        knor::coordinator::ptr kc = (no_prune || approx_degree) ?
+            knor::kmeans_coordinator::create(run_fn,
+                    run_nrow, ncol, k, max_iters, nnodes, nthread, p_centers,
+                    init, tolerance, dist_type) :
+            kprune::kmeans_task_coordinator::create(
+                    run_fn, run_nrow, ncol, k, max_iters, nnodes, nthread,
+                    p_centers, init, tolerance, dist_type);
+        if (approx_degree)
+            std::static_pointer_cast<knor::kmeans_coordinator>(
+                    kc)->set_approx_assign(approx_degree, ef_search);
+        if (dedup) {
+            kc->set_thd_weights_ptr(dedup->get_weights());
+            ret = dedup->expand(kc->run(dedup->get_data()));
         } else {
-            kprune::kmeans_task_coordinator::ptr kc =
-                kprune::kmeans_task_coordinator::create(
-                    datafn, nrow, ncol, k, max_iters, nnodes, nthread, p_centers,
-                    init, tolerance, dist_type);
             ret = kc->run();
         }
 #ifdef _OPENMP
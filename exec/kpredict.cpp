@@ -0,0 +1,151 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/time.h>
+
+#include "io.hpp"
+#include "util.hpp"
+#include "predictor.hpp"
+
+#include "cxxopts/cxxopts.hpp"
+
+namespace kbase = knor::base;
+
+int main(int argc, char* argv[]) {
+  try {
+    // positional args
+    std::string datafn = "";
+    std::string centersfn = "";
+    unsigned k = 0;
+
+    // optional args
+    size_t block_nrow = 1 << 20;
+    std::string dist_type = "eucl";
+    unsigned index_degree = 0;
+    unsigned ef_search = 32;
+    std::string outfn = "";
+    std::string distfn = "";
+
+    cxxopts::Options options(argv[0],
+            "kpredict data-file nsamples dim k -C centers-file [options]\n");
+    options.positional_help("[optional args]");
+
+    options.add_options()
+      ("f,datafn", "Path to data-file on disk",
+            cxxopts::value<std::string>(datafn), "FILE")
+      ("n,nsamples", "Number of samples in the dataset (rows)",
+            cxxopts::value<std::string>())
+      ("m,dim", "Number of features in the dataset (columns)",
+            cxxopts::value<std::string>())
+      ("k,nclust", "Number of trained centroids",
+            cxxopts::value<unsigned>(k))
+      ("C,centers", "Path to the k x dim trained centroids",
+            cxxopts::value<std::string>(centersfn))
+      ("b,block", "Rows read and assigned per block",
+            cxxopts::value<size_t>(block_nrow))
+      ("A,approx", "Search a centroid graph of this degree (eucl only)",
+            cxxopts::value<unsigned>(index_degree))
+      ("e,ef", "Beam width of the centroid graph search",
+            cxxopts::value<unsigned>(ef_search))
+      ("d,dist", "Distance metric [eucl,sqeucl,cos,taxi]",
+            cxxopts::value<std::string>(dist_type))
+      ("o,outfn", "Write assignments (unsigned) to this binary file",
+            cxxopts::value<std::string>(outfn))
+      ("D,distfn", "Write distances (double) to this binary file",
+            cxxopts::value<std::string>(distfn))
+      ("h,help", "Print help")
+    ;
+
+    options.parse_positional({"datafn", "nsamples", "dim", "nclust"});
+    int nargs = argc;
+    options.parse(argc, argv);
+
+    if (options.count("help") || (nargs == 1)) {
+        std::cout << options.help() << std::endl;
+        exit(EXIT_SUCCESS);
+    }
+
+    if (nargs < 4 || centersfn.empty()) {
+        std::cout << "[ERROR]: Not enough default arguments\n";
+        std::cout << options.help() << std::endl;
+        exit(EXIT_SUCCESS);
+    }
+
+    kbase::assert_msg(kbase::is_file_exist(datafn.c_str()),
+            "Data file name doesn't exit!");
+    kbase::assert_msg(kbase::is_file_exist(centersfn.c_str()),
+            "Centers file name doesn't exit!");
+    size_t nrow = atol(options["nsamples"].as<std::string>().c_str());
+    size_t ncol = atol(options["dim"].as<std::string>().c_str());
+
+    if (kbase::filesize(datafn.c_str()) != (sizeof(double)*nrow*ncol))
+        throw kbase::io_exception("File size does not match input size.");
+    if (kbase::filesize(centersfn.c_str()) != (sizeof(double)*k*ncol))
+        throw kbase::io_exception("Centers file size does not match k x dim.");
+
+    std::vector<double> centers(k*ncol);
+    kbase::bin_io<double> br(centersfn, k, ncol);
+    br.read(&centers);
+
+    auto pred = kbase::predictor::create(&centers[0], k, ncol,
+            kbase::get_dist_type(dist_type));
+    if (index_degree)
+        pred->build_index(index_degree, ef_search);
+
+    std::shared_ptr<kbase::bin_io<unsigned> > asgn_out;
+    std::shared_ptr<kbase::bin_io<double> > dist_out;
+    if (!outfn.empty())
+        asgn_out = std::make_shared<kbase::bin_io<unsigned> >(outfn, "wb");
+    if (!distfn.empty())
+        dist_out = std::make_shared<kbase::bin_io<double> >(distfn, "wb");
+
+    std::vector<size_t> counts(k);
+    double sum_dist = 0;
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+    size_t nassigned = pred->predict(datafn, nrow, block_nrow,
+            [&](const size_t first, const size_t len,
+                const unsigned* asgn, const double* dists) {
+            for (size_t row = 0; row < len; row++) {
+                counts[asgn[row]]++;
+                sum_dist += dists[row];
+            }
+            if (asgn_out)
+                asgn_out->write(asgn, len);
+            if (dist_out)
+                dist_out->write(dists, len);
+            });
+    gettimeofday(&end, NULL);
+    float secs = kbase::time_diff(start, end);
+
+    printf("Assigned %lu rows in %.6f sec (%.0f rows/s)%s\n", nassigned,
+            secs, nassigned / std::max(secs, 1e-6f),
+            index_degree ? " through the centroid graph" : "");
+    printf("Mean distance: %f\n", nassigned ? sum_dist / nassigned : 0);
+    printf("Cluster sizes: \n");
+    kbase::print(counts);
+
+  } catch (const cxxopts::OptionException& e)
+  {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+    return EXIT_SUCCESS;
+}
@@ -45,6 +45,9 @@ int main(int argc, char* argv[]) {
     std::string init = "forgy";
     double tolerance = -1;
     double sample_rate = .2;
+    std::string alg = "alternate";
+    size_t clara_nsamples = 0;
+    size_t cache_mb = 0;
 
     unsigned nnodes = kbase::get_num_nodes();
     std::string outdir = "";
@@ -74,8 +77,17 @@ int main(int argc, char* argv[]) {
             cxxopts::value<std::string>(dist_type))
       ("l,tol", "tolerance for convergence (1E-6)",
             cxxopts::value<std::string>())
-      ("s,srate", "Sample rate for the medoid step (.2)",
+      ("s,srate", "Sample rate for the medoid step, fastpam & clara"
+            " draw at most k*log2(n) swap candidates (.2)",
             cxxopts::value<std::string>())
+      ("a,alg", "Medoid update [alternate, fastpam, clara]",
+            cxxopts::value<std::string>(alg))
+      ("c,clara_nsamples", "Rows in the CLARA sample (40 + 2k)",
+            cxxopts::value<size_t>(clara_nsamples))
+      ("M,cache_mb", "Medoid step distance cache budget in MB, off by"
+            " default since rows are only reused if a candidate is resampled"
+            " into an unchanged cluster (0)",
+            cxxopts::value<size_t>(cache_mb))
       ("o,outdir", "Write output to an output directory of this name",
             cxxopts::value<std::string>(outdir))
       ("h,help", "Print help");
@@ -120,13 +132,15 @@ int main(int argc, char* argv[]) {
     knor::medoid_coordinator::ptr kc =
         knor::medoid_coordinator::create(datafn,
                 nrow, ncol, k, max_iters, nnodes, nthread, p_centers,
-                init, tolerance, dist_type, sample_rate);
+                init, tolerance, dist_type, sample_rate, alg, clara_nsamples,
+                cache_mb*1024*1024);
     ret = kc->run();
 #else
     knor::medoid_coordinator::ptr kc =
         knor::medoid_coordinator::create("",
                 nrow, ncol, k, max_iters, nnodes, nthread, p_centers,
-                init, tolerance, dist_type, sample_rate);
+                init, tolerance, dist_type, sample_rate, alg, clara_nsamples,
+                cache_mb*1024*1024);
     std::vector<double> data(nrow*ncol);
     kbase::bin_io<double> br(datafn, nrow, ncol);
     br.read(&data);
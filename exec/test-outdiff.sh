@@ -19,19 +19,62 @@
 OUTDIR_IM=outdir-IM
 OUTDIR_DM=outdir-DM
 OUTDIR_FDM=outdir-FDM
+OUTDIR_ODM=outdir-ODM
+OUTDIR_OFDM=outdir-OFDM
+OUTDIR_RDM=outdir-RDM
+OUTDIR_NFDM=outdir-NFDM
+OUTDIR_WDM=outdir-WDM
+OUTDIR_BFDM=outdir-BFDM
+OUTDIR_XDM=outdir-XDM
+OUTDIR_XFDM=outdir-XFDM
+OUTDIR_MBSM=outdir-MBSM
+OUTDIR_MBDM=outdir-MBDM
+OUTDIR_HIM=outdir-HIM
+OUTDIR_HDM=outdir-HDM
+OUTDIR_XMIM=outdir-XMIM
+OUTDIR_XMDM=outdir-XMDM
+OUTDIR_GIM=outdir-GIM
+OUTDIR_GDM=outdir-GDM
+OUTDIR_FCIM=outdir-FCIM
+OUTDIR_FCDM=outdir-FCDM
+OUTDIR_GMSM=outdir-GMSM
+OUTDIR_GMDM=outdir-GMDM
+OUTDIR_LDM=outdir-LDM
+OUTDIR_LFDM=outdir-LFDM
+OUTDIR_LHDM=outdir-LHDM
+OUTDIR_LGMDM=outdir-LGMDM
 
-if [ "$(diff $OUTDIR_IM/* $OUTDIR_DM/*)" = "" ];
-then
-    echo "knord PRUNED test success!"
-else
-    echo "knord PRUNED release test failure!"
-    exit 1
-fi
+# Both runs must have written their output and it must match
+check() {
+    if [ -f $1/cluster_t.yml ] && [ -f $2/cluster_t.yml ] && \
+        diff -q $1/cluster_t.yml $2/cluster_t.yml > /dev/null;
+    then
+        echo "knord $3 test success!"
+    else
+        echo "knord $3 release test failure!"
+        exit 1
+    fi
+}
 
-if [ "$(diff $OUTDIR_IM/* $OUTDIR_FDM/*)" = "" ];
-then
-    echo "knord FULL test success!"
-else
-    echo "knord FULL release test failure!"
-    exit 1
-fi
+check $OUTDIR_IM $OUTDIR_DM "PRUNED"
+check $OUTDIR_IM $OUTDIR_FDM "FULL"
+check $OUTDIR_IM $OUTDIR_ODM "PRUNED overlapped"
+check $OUTDIR_IM $OUTDIR_OFDM "FULL overlapped"
+check $OUTDIR_IM $OUTDIR_RDM "PRUNED MPI-IO read"
+check $OUTDIR_IM $OUTDIR_NFDM "FULL node read"
+check $OUTDIR_IM $OUTDIR_WDM "PRUNED weighted partition"
+check $OUTDIR_IM $OUTDIR_BFDM "FULL rebalanced"
+check $OUTDIR_IM $OUTDIR_XDM "PRUNED float reduction"
+check $OUTDIR_IM $OUTDIR_XFDM "FULL float reduction"
+# A batch of every row samples the same rows whatever the number of procs
+check $OUTDIR_MBSM $OUTDIR_MBDM "mini-batch"
+check $OUTDIR_HIM $OUTDIR_HDM "hmeans"
+check $OUTDIR_XMIM $OUTDIR_XMDM "xmeans"
+check $OUTDIR_GIM $OUTDIR_GDM "gmeans"
+check $OUTDIR_FCIM $OUTDIR_FCDM "fcm"
+# Single-node gmm writes no output, so compare against one proc
+check $OUTDIR_GMSM $OUTDIR_GMDM "gmm"
+check $OUTDIR_IM $OUTDIR_LDM "PRUNED shared memory"
+check $OUTDIR_IM $OUTDIR_LFDM "FULL shared memory"
+check $OUTDIR_HIM $OUTDIR_LHDM "hmeans shared memory"
+check $OUTDIR_GMSM $OUTDIR_LGMDM "gmm shared memory"
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "cluster_allreduce.hpp"
+#include "exception.hpp"
+
+namespace knor { namespace mpi {
+
+cluster_allreduce::cluster_allreduce(const unsigned k, const size_t ncol,
+        const unsigned nchunks) : k(k),
+    nchunks(std::max(1U, std::min(nchunks, k))),
+    chunk_k((k + this->nchunks - 1) / this->nchunks),
+    ncol(ncol), rec_len(ncol+1), send_changed(0), recv_changed(0),
+    blocking(!transport::get()->is_mpi()) {
+    send.resize(k*rec_len);
+    recv.resize(k*rec_len);
+    reqs.assign(this->nchunks+1, MPI_REQUEST_NULL);
+}
+
+void cluster_allreduce::post(
+        const std::vector<std::shared_ptr<base::clusters> >& parts,
+        const size_t nchanged) {
+    // nchanged first so it is not stuck behind the large chunks
+    send_changed = nchanged;
+    int ret;
+    if (blocking) {
+        transport::get()->allreduce(&send_changed, &recv_changed, 1, DOUBLE);
+    } else {
+        ret = MPI_Iallreduce(&send_changed, &recv_changed, 1, MPI_DOUBLE,
+                MPI_SUM, MPI_COMM_WORLD, &reqs[nchunks]);
+        if (ret)
+            throw base::mpi_exception("Iallreduce failure of nchanged", ret);
+    }
+
+    for (unsigned chunk = 0; chunk < nchunks; chunk++) {
+        const unsigned begin = chunk_begin(chunk);
+        const unsigned end = chunk_end(chunk);
+        double* rec = &send[begin*rec_len];
+        std::fill(rec, &send[end*rec_len], 0);
+
+        for (size_t part = 0; part < parts.size(); part++) {
+            const double* means = &(parts[part]->get_means()[begin*ncol]);
+            for (unsigned c = 0; c < end - begin; c++) {
+                double* crec = &rec[c*rec_len];
+                for (size_t col = 0; col < ncol; col++)
+                    crec[col] += means[c*ncol+col];
+                crec[ncol] += parts[part]->get_num_members(begin+c);
+            }
+        }
+
+        if (blocking) {
+            transport::get()->allreduce(rec, &recv[begin*rec_len],
+                    (end-begin)*rec_len, DOUBLE);
+            continue;
+        }
+        ret = MPI_Iallreduce(rec, &recv[begin*rec_len],
+                (end-begin)*rec_len, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD,
+                &reqs[chunk]);
+        if (ret)
+            throw base::mpi_exception("Iallreduce failure of chunk", ret);
+    }
+}
+
+void cluster_allreduce::wait(const unsigned chunk) {
+    if (blocking)
+        return;
+    int ret = MPI_Wait(&reqs[chunk], MPI_STATUS_IGNORE);
+    if (ret)
+        throw base::mpi_exception("Wait failure on chunk", ret);
+}
+
+size_t cluster_allreduce::wait_nchanged() {
+    if (blocking)
+        return recv_changed;
+    int ret = MPI_Wait(&reqs[nchunks], MPI_STATUS_IGNORE);
+    if (ret)
+        throw base::mpi_exception("Wait failure on nchanged", ret);
+    return static_cast<size_t>(recv_changed);
+}
+} } // End namespace knor::mpi
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_CLUSTER_ALLREDUCE_HPP__
+#define __KNOR_CLUSTER_ALLREDUCE_HPP__
+
+#include <mpi.h>
+#include <memory>
+#include <vector>
+
+#include "clusters.hpp"
+#include "transport.hpp"
+
+namespace knor { namespace mpi {
+
+/**
+  * Non-blocking allreduce (sum) of the per proc cluster sums that follow
+  *  an E-step, split into chunks of clusters. Each chunk is summed over the
+  *  threads' local clusters and its MPI_Iallreduce started before the next
+  *  chunk is summed, so packing and the caller's per chunk work overlap
+  *  with the chunks still in flight. All threads must have finished the
+  *  E-step before the first chunk is posted, so the gain comes from the
+  *  caller's work: the pruned coordinator computes each chunk's centroid
+  *  distances for the next iteration, the full one only finalizes means.
+  *  Counts travel as doubles next to the means.
+  *  Transports other than MPI reduce each chunk as it is posted.
+  */
+class cluster_allreduce {
+private:
+    const unsigned k, nchunks, chunk_k;
+    const size_t ncol, rec_len; // rec_len = ncol + count
+    std::vector<double> send, recv; // k records
+    std::vector<MPI_Request> reqs; // One per chunk + nchanged
+    double send_changed, recv_changed;
+    const bool blocking; // No non-blocking reductions on the transport
+
+    cluster_allreduce(const unsigned k, const size_t ncol,
+            const unsigned nchunks);
+
+public:
+    typedef std::shared_ptr<cluster_allreduce> ptr;
+
+    static ptr create(const unsigned k, const size_t ncol,
+            const unsigned nchunks) {
+        return ptr(new cluster_allreduce(k, ncol, nchunks));
+    }
+
+    /**
+      * Start reducing the unfinalized sums of parts and this proc's number
+      *  of changed assignments. parts must be untouched until every chunk
+      *  was waited on.
+      */
+    void post(const std::vector<std::shared_ptr<base::clusters> >& parts,
+            const size_t nchanged);
+    // Block until chunk is reduced across all procs
+    void wait(const unsigned chunk);
+    // Block until the global number of changed assignments is known
+    size_t wait_nchanged();
+
+    const unsigned get_nchunks() const { return nchunks; }
+    const unsigned chunk_begin(const unsigned chunk) const {
+        return chunk*chunk_k;
+    }
+    const unsigned chunk_end(const unsigned chunk) const {
+        return std::min(k, (chunk+1)*chunk_k);
+    }
+    // Global sums of cluster c once its chunk was waited on
+    const double* get_mean(const unsigned c) const {
+        return &recv[c*rec_len];
+    }
+    const llong_t get_count(const unsigned c) const {
+        return static_cast<llong_t>(recv[c*rec_len + ncol]);
+    }
+};
+} } // End namespace knor::mpi
+#endif
@@ -22,54 +22,60 @@
 #include "clusters.hpp"
 #include "io.hpp"
 #include "mpi.hpp"
+#include "cluster_allreduce.hpp"
+#include "dist_io.hpp"
 #include "util.hpp"
 #include "types.hpp"
 
 namespace kmpi = knor::mpi;
 
+// E-steps in a row over the rebalance tolerance before rows move
+#define REBALANCE_PERSIST 3
+// Or move at once when the slowest proc is over this many tolerances
+#define REBALANCE_MARGIN 2
+// Fraction of changed assignments under which -F goes back to double
+#define FLOAT_REDUCE_STOP 0.001
+
 namespace knor { namespace dist {
 
 dist_coordinator::dist_coordinator(
-        int argc, char* argv[],
-        const std::string fn, const size_t nrow,
+        kbase::row_partition::ptr part,
+        const std::string fn,
         const size_t ncol, const unsigned k, const unsigned max_iters,
         const unsigned nnodes, const unsigned nthreads,
         const double* centers, const kbase::init_t it,
         const double tolerance, const kbase::dist_t dt) :
-    kmeans_coordinator(fn, this->init(argc, argv, nrow), ncol, k, max_iters, nnodes,
+    kmeans_coordinator(fn, this->init(part), ncol, k, max_iters, nnodes,
             nthreads, centers, it, tolerance, dt) {
 
-        this->g_nrow = nrow;
+        this->part = part;
+        this->g_nrow = part->get_g_nrow();
+        this->overlap_chunks = 0;
+        this->read_mode = kmpi::read_mode_t::THREAD_READ;
+        this->float_reduce = false;
+        this->rebalance_tol = 0;
+        this->rebalance_streak = 0;
 
         for (thread_iter it = threads.begin(); it < threads.end(); ++it)
             (*it)->set_start_rid((*it)->get_start_rid()
-                    + (nrow / nprocs) * mpi_rank);
+                    + part->first(mpi_rank));
 }
 
 /**
   * A method called prior to calling the superclass constructor.
-  * This takes the global number of samples in the *entire* dataset, `g_nrow'
-  *     and gives the coordinator it's partition.
-  * \param g_nrow: the global number of rows
+  * This takes the partition of the *entire* dataset's rows across procs
+  *     and gives the coordinator it's share.
+  * \param part: the rows every proc owns
   * \return the local number of rows for this process
   */
-const size_t dist_coordinator::init(int argc, char* argv[],
-        const size_t g_nrow) {
-    if (MPI_Init(&argc, &argv) != MPI_SUCCESS)
-        throw std::runtime_error("MPI_Init error\n");
-
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs); // Set the num_procs
-    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-
-    if (mpi_rank == (nprocs - 1)) // The last proc always has more
-        return (g_nrow / nprocs) + (g_nrow % nprocs);
-    else
-        return (g_nrow / nprocs);
+const size_t dist_coordinator::init(kbase::row_partition::ptr part) {
+    nprocs = mpi::transport::get()->get_nprocs(); // Set the num_procs
+    mpi_rank = mpi::transport::get()->get_rank();
+    return part->nrow(mpi_rank);
 }
 
 void dist_coordinator::random_partition_init() {
-    kbase::rand123emulator<unsigned> gen(0, k-1,
-            ((g_nrow / nprocs) * mpi_rank));
+    kbase::rand123emulator<unsigned> gen(0, k-1, part->first(mpi_rank));
     for (size_t row = 0; row < nrow; row++) {
         unsigned asgnd_clust = gen.next();
         const double* dp = this->get_thd_data(row);
@@ -94,7 +100,7 @@ void dist_coordinator::random_partition_init() {
 void dist_coordinator::shift_thread_start_rid() {
     size_t c = 0;
     for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
-        size_t shift = (*it)->get_start_rid() - ((g_nrow / nprocs) * mpi_rank);
+        size_t shift = (*it)->get_start_rid() - part->first(mpi_rank);
 #if VERBOSE
 #ifndef BIND
         printf("P: %u, T: %lu, start_rid: %lu\n", mpi_rank, c++, shift);
@@ -104,20 +110,172 @@ void dist_coordinator::shift_thread_start_rid() {
     }
 }
 
+void dist_coordinator::load_data() {
+    for (thread_iter it = threads.begin(); it < threads.end(); ++it)
+        (*it)->set_defer_read(read_mode != kmpi::read_mode_t::THREAD_READ);
+    wake4run(knor::thread_state_t::ALLOC_DATA);
+    wait4complete();
+
+    if (read_mode == kmpi::read_mode_t::THREAD_READ)
+        return;
+
+    // Thread start_rids are still global here
+    std::vector<kmpi::row_block> blocks;
+    for (thread_iter it = threads.begin(); it < threads.end(); ++it) {
+        kmpi::row_block b = { (*it)->get_local_data(), (*it)->get_start_rid(),
+            (*it)->get_data_size() / (sizeof(double)*ncol) };
+        blocks.push_back(b);
+    }
+    kmpi::read_rows(fn, ncol, blocks, read_mode);
+}
+
+const bool dist_coordinator::rebalance(const double secs) {
+    std::vector<double> secs_v(nprocs);
+    kmpi::mpi::allgather_double(&secs, &secs_v[0], 1);
+
+    // Every proc sees the same times so the streak agrees across procs
+    const double mean = std::accumulate(secs_v.begin(), secs_v.end(), 0.0)
+        / nprocs;
+    const double slowest = *std::max_element(secs_v.begin(), secs_v.end());
+    if (slowest <= mean * (1 + rebalance_tol)) {
+        rebalance_streak = 0;
+        return false;
+    }
+    // One noisy E-step shouldn't move rows unless it is far off
+    if (++rebalance_streak < REBALANCE_PERSIST &&
+            slowest <= mean * (1 + REBALANCE_MARGIN*rebalance_tol))
+        return false;
+    rebalance_streak = 0;
+
+    std::vector<double> rates(nprocs);
+    for (int proc = 0; proc < nprocs; proc++)
+        rates[proc] = part->nrow(proc) / std::max(secs_v[proc], 1e-9);
+    kbase::row_partition::ptr next =
+        kbase::row_partition::create(g_nrow, rates);
+
+    if (*next == *part)
+        return false;
+    for (int proc = 0; proc < nprocs; proc++)
+        if (next->nrow(proc) < nthreads)
+            return false; // Every thread keeps at least 1 row
+
+    // Assignments follow their rows to the new owners
+    std::vector<int> scounts(nprocs), sdispls(nprocs),
+        rcounts(nprocs), rdispls(nprocs);
+    for (int proc = 0; proc < nprocs; proc++) {
+        size_t begin;
+        scounts[proc] = part->overlap(mpi_rank, *next, proc, begin);
+        sdispls[proc] = begin - part->first(mpi_rank);
+        rcounts[proc] = next->overlap(mpi_rank, *part, proc, begin);
+        rdispls[proc] = begin - next->first(mpi_rank);
+    }
+    std::vector<unsigned> asgn(next->nrow(mpi_rank));
+    mpi::transport::get()->alltoallv(&cluster_assignments[0], &scounts[0],
+            &sdispls[0], &asgn[0], &rcounts[0], &rdispls[0], mpi::UNSIGNED);
+
+    // Only rows that change owner are sent. Rows a proc keeps are copied
+    //  from its old threads below.
+    std::vector<int> srow_counts(nprocs), srow_displs(nprocs),
+        rrow_counts(nprocs), rrow_displs(nprocs);
+    size_t nsend = 0, nrecv = 0;
+    for (int proc = 0; proc < nprocs; proc++) {
+        if (proc == mpi_rank)
+            continue;
+        srow_counts[proc] = scounts[proc]*ncol;
+        srow_displs[proc] = nsend*ncol;
+        nsend += scounts[proc];
+        rrow_counts[proc] = rcounts[proc]*ncol;
+        rrow_displs[proc] = nrecv*ncol;
+        nrecv += rcounts[proc];
+    }
+    std::vector<double> sbuf(nsend*ncol), rbuf(nrecv*ncol);
+    for (int proc = 0; proc < nprocs; proc++) {
+        if (proc == mpi_rank)
+            continue;
+        for (int i = 0; i < scounts[proc]; i++) {
+            const double* row = get_thd_data(sdispls[proc] + i);
+            std::copy(row, row + ncol, &sbuf[srow_displs[proc] + i*ncol]);
+        }
+    }
+    mpi::transport::get()->alltoallv(sbuf.empty() ? NULL : &sbuf[0],
+            &srow_counts[0], &srow_displs[0],
+            rbuf.empty() ? NULL : &rbuf[0], &rrow_counts[0], &rrow_displs[0],
+            mpi::DOUBLE);
+    std::vector<double>().swap(sbuf);
+
+    // Build threads over the new rows, keeping the old ones to copy from
+    std::vector<thread::ptr> old_threads;
+    std::vector<unsigned> old_max_row_idx;
+    old_threads.swap(threads);
+    old_max_row_idx.swap(thd_max_row_idx);
+    const size_t old_nrow = nrow;
+
+    part = next;
+    nrow = part->nrow(mpi_rank);
+    cluster_assignments.swap(asgn);
+    build_thread_state();
+    for (thread_iter it = threads.begin(); it < threads.end(); ++it)
+        (*it)->set_defer_read(true);
+    wake4run(knor::thread_state_t::ALLOC_DATA);
+    wait4complete();
+
+    // As get_thd_data, for either set of threads
+    auto thd_row = [&](std::vector<thread::ptr>& thds,
+            const std::vector<unsigned>& max_row_idx, const size_t nrows,
+            const size_t lrid) -> double* {
+        const size_t thd = std::upper_bound(max_row_idx.begin(),
+                max_row_idx.end(), lrid) - max_row_idx.begin();
+        return &((thds[thd]->get_local_data())
+                [(lrid - thd*(nrows/nthreads))*ncol]);
+    };
+
+    for (int proc = 0; proc < nprocs; proc++) {
+        for (int i = 0; i < rcounts[proc]; i++) {
+            const double* row = proc == mpi_rank ?
+                thd_row(old_threads, old_max_row_idx, old_nrow,
+                        sdispls[proc] + i) :
+                &rbuf[rrow_displs[proc] + i*ncol];
+            std::copy(row, row + ncol, thd_row(threads, thd_max_row_idx,
+                        nrow, rdispls[proc] + i));
+        }
+    }
+
+    // Retire the old threads. They join as they're freed
+    threads.swap(old_threads);
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        (*it)->destroy_numa_mem();
+    destroy_threads();
+    threads.swap(old_threads);
+
+#ifndef BIND
+    if (mpi_rank == root) {
+        printf("Rebalanced rows:");
+        for (int proc = 0; proc < nprocs; proc++)
+            printf(" %lu", part->nrow(proc));
+        printf(" (%lu moved here)\n", nrecv);
+    }
+#endif
+    return true;
+}
+
 const size_t dist_coordinator::global_rid(const size_t local_rid) const {
-    return ((g_nrow / nprocs) * mpi_rank) + local_rid;
+    return part->first(mpi_rank) + local_rid;
 }
 
 const size_t dist_coordinator::local_rid(const size_t global_rid) const {
-    size_t rid = global_rid - (mpi_rank * (g_nrow / nprocs));
+    size_t rid = global_rid - part->first(mpi_rank);
     if (rid > this->nrow)
         throw kbase::thread_exception("Row: " + std::to_string(rid) +
                 " out of bounds for Proc: " + std::to_string( mpi_rank));
     return rid;
 }
 
+const int dist_coordinator::owner(const size_t global_rid) const {
+    return part->owner(global_rid);
+}
+
 const bool dist_coordinator::is_local(const size_t global_rid) const {
-    size_t rid = global_rid - (mpi_rank * (g_nrow / nprocs));
+    size_t rid = global_rid - part->first(mpi_rank);
     if (rid >= this->nrow)
         return false;
     return true;
@@ -132,9 +290,9 @@ void const dist_coordinator::print_thread_data() {
 void dist_coordinator::kmeanspp_init() {
     struct timeval start, end;
 
-    std::vector<double> buff(k*ncol);
+    std::vector<double> center(ncol);
+    std::vector<double> rank_sums(nprocs);
     std::vector<double> dist_v;
-    std::vector<double> g_dist_v(g_nrow);
     dist_v.assign(get_nrow(), std::numeric_limits<double>::max()); // local nrow
     set_thd_dist_v_ptr(&dist_v[0]);
 
@@ -146,14 +304,14 @@ void dist_coordinator::kmeanspp_init() {
 
     // If proc owns the row -- get it ...
     if (is_local(selected_idx)) {
-        cltrs->set_mean(get_thd_data(local_rid(selected_idx)), 0);
-        dist_v[local_rid(selected_idx)] = 0.0;
-        cluster_assignments[local_rid(selected_idx)] = 0;
+        const size_t lrid = local_rid(selected_idx);
+        std::copy(get_thd_data(lrid), get_thd_data(lrid) + ncol, &center[0]);
+        dist_v[lrid] = 0;
+        cluster_assignments[lrid] = 0;
     }
 
-    kmpi::mpi::reduce_double(&(cltrs->get_means()[0]),
-            &buff[0], cltrs->size());
-    cltrs->set_mean(&buff[0]);
+    kmpi::mpi::bcast_double(&center[0], owner(selected_idx), ncol);
+    cltrs->set_mean(&center[0], 0);
 
 #if VERBOSE
 #ifndef BIND
@@ -164,62 +322,45 @@ void dist_coordinator::kmeanspp_init() {
 
     std::uniform_real_distribution<double> ur_distribution(0.0, 1.0);
 
-    // Choose next center c_i with weighted prob
+    // Choose next center c_i with weighted prob. Only the per proc sums of
+    //  dist_v are exchanged: every proc walks them with the same draw to the
+    //  owning proc, which walks its own dist_v and broadcasts the row.
     while (true) {
         set_thread_clust_idx(clust_idx); // Set the current cluster index
         wake4run(KMSPP_INIT); // Run || distance comp to clust_idx
         wait4complete();
         double local_cuml_dist = reduction_on_cuml_sum(); // Per proc cuml dists
 
-        double cuml_dist; // Recepticle
-        kmpi::mpi::reduce_double(&local_cuml_dist, &cuml_dist);
+        kmpi::mpi::allgather_double(&local_cuml_dist, &rank_sums[0], 1);
+        double cuml_dist = 0;
+        for (int proc = 0; proc < nprocs; proc++)
+            cuml_dist += rank_sums[proc];
 
         // All procs do this ...
-        cuml_dist = (cuml_dist * ur_distribution(generator)) / (RAND_MAX - 1.0);
+        cuml_dist *= ur_distribution(generator);
         if (++clust_idx >= k)  // No more centers needed
             break;
 
-        // Gather the g_dist_v
-        kmpi::mpi::allgather_double(&dist_v[0],
-                &g_dist_v[0], g_nrow/nprocs);
-
-        // Gather the remaining entries from the last proc which *may* have more
-        if (g_nrow % nprocs) {
-            const size_t tail_idx = (g_nrow/nprocs);
-            const size_t numel = (g_nrow % nprocs);
-
-            if (mpi_rank == nprocs - 1)
-                std::copy(&dist_v[tail_idx], &dist_v[tail_idx+numel],
-                        &g_dist_v[g_nrow-numel]);
-
-            kmpi::mpi::bcast_double(&g_dist_v[g_nrow-numel], nprocs-1, numel);
+        const int owner_proc = static_cast<int>(
+                kbase::weighted_select(&rank_sums[0], nprocs, cuml_dist));
+        if (owner_proc == mpi_rank) {
+            const size_t lrid = kbase::weighted_select(&dist_v[0],
+                    get_nrow(), cuml_dist);
+            std::copy(get_thd_data(lrid), get_thd_data(lrid) + ncol,
+                    &center[0]);
+            cluster_assignments[lrid] = clust_idx;
+            selected_idx = global_rid(lrid);
         }
 
-        for (size_t row = 0; row < g_nrow; row++) {
-            cuml_dist -= g_dist_v[row];
-            if (cuml_dist <= 0) {
+        kmpi::mpi::bcast_double(&center[0], owner_proc, ncol);
+        cltrs->set_mean(&center[0], clust_idx);
 #if VERBOSE
-                if (mpi_rank == 0)
+        if (owner_proc == mpi_rank)
 #ifndef BIND
-                    printf("Choosing %lu as center k = %u\n", row, clust_idx);
+            printf("Choosing %u as center k = %u\n", selected_idx,
+                    clust_idx);
 #endif
 #endif
-
-                if (is_local(row)) {
-                    cltrs->set_mean(get_thd_data(local_rid(row)), clust_idx);
-                    cluster_assignments[local_rid(row)] = clust_idx;
-                } else {
-                    cltrs->clear();
-                }
-
-                break;
-            }
-        }
-
-        kmpi::mpi::reduce_double(&(cltrs->get_means()[0]),
-                &buff[0], cltrs->size());
-        cltrs->set_mean(&buff[0]);
-        assert(cuml_dist <= 0);
     }
 
 #if VERBOSE
@@ -262,8 +403,7 @@ void dist_coordinator::run(kbase::cluster_t& ret,
     }
 
     // Give processes their data
-    wake4run(knor::thread_state_t::ALLOC_DATA);
-    wait4complete();
+    load_data();
 
     shift_thread_start_rid();
 
@@ -275,6 +415,7 @@ void dist_coordinator::run(kbase::cluster_t& ret,
     bool converged = false;
     size_t iters = 0;
     size_t nchanged = 0;
+    bool reduce_float = float_reduce; // Until the resync below
 
     kbase::clusters::ptr cltrs_ptr = get_gcltrs();
 
@@ -283,6 +424,10 @@ void dist_coordinator::run(kbase::cluster_t& ret,
 
     double* clstr_buff = new double[k*ncol];
     size_t* nmemb_buff = new size_t[k];
+    kmpi::cluster_allreduce::ptr reducer = overlap_chunks ?
+        kmpi::cluster_allreduce::create(k, ncol, overlap_chunks) : nullptr;
+    std::vector<double> center; // Float reductions are offsets from it
+    std::vector<kbase::clusters::ptr> parts(threads.size());
 
     if (_init_t == kbase::init_t::RANDOM ||
             _init_t == kbase::init_t::FORGY) {
@@ -322,26 +467,62 @@ void dist_coordinator::run(kbase::cluster_t& ret,
             printf("Running iteration %lu ...\n", iters);
 #endif
 
+        struct timeval estart, eend;
+        gettimeofday(&estart, NULL);
         wake4run(knor::thread_state_t::EM);
         wait4complete();
+        gettimeofday(&eend, NULL);
         // NOTE: Unfinalized diffs on this proc
 
-        pp_aggregate();
-
-        // NOTE: cltrs_ptr has this procs diff (agg of threads from this proc)
-        // NOTE: clstr_buff has agg of all procs diff
-        kmpi::mpi::reduce_double(&(cltrs_ptr->get_means()[0]),
-                clstr_buff, cltrs_ptr->size());
+        if (reducer) {
+            // Chunks are finalized as they arrive while later ones are
+            //  still being reduced. Finalizing is all there is to overlap
+            //  here, only the pruned coordinator gains from chunking.
+            num_changed = 0;
+            for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+                num_changed += (*it)->get_num_changed();
+                parts[it - threads.begin()] = (*it)->get_local_clusters();
+            }
+            cltrs_ptr->clear();
+            reducer->post(parts, num_changed);
+
+            for (unsigned chunk = 0; chunk < reducer->get_nchunks(); chunk++) {
+                reducer->wait(chunk);
+                for (unsigned c = reducer->chunk_begin(chunk);
+                        c < reducer->chunk_end(chunk); c++) {
+                    cltrs_ptr->set_mean(reducer->get_mean(c), c);
+                    cltrs_ptr->get_num_members_v()[c] = reducer->get_count(c);
+                    cltrs_ptr->finalize(c);
+                }
+            }
+            nchanged = reducer->wait_nchanged();
+        } else {
+            if (reduce_float) // The means of this E-step
+                center.assign(cltrs_ptr->get_means().begin(),
+                        cltrs_ptr->get_means().end());
+            pp_aggregate();
 
-        // nmemb_buff has agg of all procs diff on membership count
-        kmpi::mpi::reduce_llong_t(&(cltrs_ptr->get_num_members_v()[0]),
-                nmemb_buff, cltrs_ptr->get_num_members_v().size());
-        cltrs_ptr->set_mean(clstr_buff);
-        cltrs_ptr->set_num_members_v(nmemb_buff);
+            // nmemb_buff has agg of all procs diff on membership count
+            kmpi::mpi::reduce_llong_t(&(cltrs_ptr->get_num_members_v()[0]),
+                    nmemb_buff, cltrs_ptr->get_num_members_v().size());
 
-        // NOTE: Now finalized
-        auto pp_num_changed = get_num_changed();
-        kmpi::mpi::reduce_size_t(&pp_num_changed, &nchanged);
+            // NOTE: cltrs_ptr has this procs diff (agg of threads from this proc)
+            // NOTE: clstr_buff has agg of all procs diff
+            if (reduce_float)
+                kmpi::mpi::reduce_delta_float(&(cltrs_ptr->get_means()[0]),
+                        clstr_buff, &center[0],
+                        &(cltrs_ptr->get_num_members_v()[0]), nmemb_buff,
+                        k, ncol);
+            else
+                kmpi::mpi::reduce_double(&(cltrs_ptr->get_means()[0]),
+                        clstr_buff, cltrs_ptr->size());
+            cltrs_ptr->set_mean(clstr_buff);
+            cltrs_ptr->set_num_members_v(nmemb_buff);
+
+            // NOTE: Now finalized
+            auto pp_num_changed = get_num_changed();
+            kmpi::mpi::reduce_size_t(&pp_num_changed, &nchanged);
+        }
 
         if (mpi_rank == root) {
 #ifndef BIND
@@ -355,9 +536,22 @@ void dist_coordinator::run(kbase::cluster_t& ret,
                     cltrs_ptr->get_num_members_v().end(), 0) == g_nrow);
 
         perc_changed = (double)nchanged/g_nrow; // Global perc change
+
+        // Near convergence float drift in the means could decide the last
+        //  assignments. Recompute the means in double and reduce in double
+        //  from here on, so convergence is judged by an exact E-step.
+        bool resynced = false;
+        if (reduce_float &&
+                perc_changed <= std::max(tolerance, FLOAT_REDUCE_STOP)) {
+            kmpi::mpi::exact_means(get_gcltrs(), nrow,
+                    &cluster_assignments[0],
+                    [this](const size_t row) { return get_thd_data(row); });
+            reduce_float = false;
+            resynced = true;
+        }
         cltrs_ptr->finalize_all();
 
-        if (nchanged == 0 || perc_changed <= tolerance) {
+        if (!resynced && (nchanged == 0 || perc_changed <= tolerance)) {
             converged = true;
             if (mpi_rank == root)
 #ifndef BIND
@@ -366,8 +560,13 @@ void dist_coordinator::run(kbase::cluster_t& ret,
             break;
         }
 
+        if (rebalance_tol > 0)
+            rebalance(kbase::time_diff(estart, eend));
+
+        // Re-running an E-step that changed nothing isn't a new iteration
+        if (!resynced || nchanged)
+            iters++;
         nchanged = 0;
-        iters++;
     }
 
     if (!converged && mpi_rank == root)
@@ -375,6 +574,10 @@ void dist_coordinator::run(kbase::cluster_t& ret,
         printf("Algorithm failed to converge in %lu iterations\n", iters);
 #endif
 
+    if (reduce_float) // Stopped at max_iters before the resync
+        kmpi::mpi::exact_means(get_gcltrs(), nrow, &cluster_assignments[0],
+                [this](const size_t row) { return get_thd_data(row); });
+
     gettimeofday(&end, NULL);
     if (mpi_rank == root)
 #ifndef BIND
@@ -383,45 +586,18 @@ void dist_coordinator::run(kbase::cluster_t& ret,
 #endif
 
     if (!outdir.empty()) {
-        // Collect cluster assignments
-        const unsigned* local_assignments = get_cluster_assignments();
-
-        if (mpi_rank != root) {
-            int rc = MPI_Ssend(local_assignments, get_nrow(),
-                    MPI::UNSIGNED, root, 0, MPI_COMM_WORLD);
-            kbase::assert_msg(!rc,
-                    "Failure to send local assignments to root");
-        } else {
-            std::vector<unsigned> assignments(g_nrow);
-            std::copy(local_assignments, local_assignments+get_nrow(),
-                    assignments.begin());
-
-            for (int pid = 1; pid < int(nprocs); pid++) {
-                // Account for an uneven # of rows per process
-                unsigned count;
-                if (pid == (nprocs - 1))
-                    count = get_nrow() + (g_nrow % nprocs);
-                else
-                    count = get_nrow();
-
-                int rc = MPI_Recv(&assignments[pid*(g_nrow/nprocs)],
-                        count, MPI::UNSIGNED, pid,
-                        0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                kbase::assert_msg(!rc,
-                        "Root Failure receive local assignments");
-            }
+        // Root keeps only the centroids and counts. Every proc writes its
+        //  own cluster assignments straight to the output file.
+        ret = kbase::cluster_t(g_nrow, ncol, iters, k, NULL,
+                &(cltrs_ptr->get_num_members_v()[0]),
+                cltrs_ptr->get_means());
 
-            ret = kbase::cluster_t(g_nrow, ncol, iters, k, &assignments[0],
-                    &(cltrs_ptr->get_num_members_v()[0]),
-                    cltrs_ptr->get_means());
-
-            if (!outdir.empty()) {
 #ifndef BIND
-                printf("\nWriting output to '%s'\n", outdir.c_str());
+        if (mpi_rank == root)
+            printf("\nWriting output to '%s'\n", outdir.c_str());
 #endif
-                ret.write(outdir);
-            }
-        }
+        kmpi::write_cluster_t(ret, get_cluster_assignments(), get_nrow(),
+                global_rid(0), outdir);
     }
 
     // MPI cleanup and graceful exit
@@ -430,7 +606,7 @@ void dist_coordinator::run(kbase::cluster_t& ret,
 }
 
 dist_coordinator::~dist_coordinator() {
-    MPI_Finalize();
+    mpi::mpi::finalize();
 }
 
 // Aggregate per process from threads &
@@ -20,9 +20,12 @@
 #define __KNOR_DIST_COORDINATOR_HPP__
 
 #include "exception.hpp"
+#include "dist_io.hpp"
+#include "dist_partition.hpp"
 #include "kmeans_coordinator.hpp"
 
 namespace kbase = knor::base;
+namespace kmpi = knor::mpi;
 
 namespace knor { namespace dist {
 
@@ -30,8 +33,8 @@ constexpr unsigned root = 0;
 
 class dist_coordinator : public knor::kmeans_coordinator {
 private:
-    dist_coordinator(int argc, char* argv[],
-            const std::string fn, const size_t nrow,
+    dist_coordinator(kbase::row_partition::ptr part,
+            const std::string fn,
             const size_t ncol, const unsigned k, const unsigned max_iters,
             const unsigned nnodes, const unsigned nthreads,
             const double* centers, const kbase::init_t it,
@@ -40,6 +43,19 @@ private:
     int mpi_rank;
     int nprocs;
     size_t g_nrow;
+    kbase::row_partition::ptr part; // The rows every proc owns
+    unsigned overlap_chunks; // 0 for blocking reductions
+    kmpi::read_mode_t read_mode;
+    bool float_reduce; // Reduce centroid sums as float deltas
+    double rebalance_tol; // 0 keeps the initial partition
+    unsigned rebalance_streak; // Consecutive E-steps over rebalance_tol
+
+    // Allocate thread memory and fill it from `fn' per the read_mode
+    void load_data();
+    // Repartition rows by the throughput each proc had in an E-step that
+    //  took it `secs', sending only the rows that change owner. Returns
+    //  true if the rows moved.
+    const bool rebalance(const double secs);
 
 public:
     static coordinator::ptr create(int argc, char* argv[],
@@ -47,13 +63,16 @@ public:
             const size_t ncol, const unsigned k, const unsigned max_iters,
             const unsigned nnodes, const unsigned nthreads,
             const double* centers=NULL, const std::string init="kmeanspp",
-            const double tolerance=-1, const std::string dist_type="eucl") {
+            const double tolerance=-1, const std::string dist_type="eucl",
+            const std::string partition="even") {
 
         kbase::init_t _init_t = kbase::get_init_type(init);
         kbase::dist_t _dist_t = kbase::get_dist_type(dist_type);
+        kbase::row_partition::ptr part = kmpi::partition_rows(argc, argv,
+                partition, fn, nrow, ncol, k, nthreads, _dist_t);
 
         return coordinator::ptr(
-                new dist_coordinator(argc, argv, fn, nrow, ncol, k, max_iters,
+                new dist_coordinator(part, fn, ncol, k, max_iters,
                     nnodes, nthreads, centers,
                     _init_t, tolerance, _dist_t));
     }
@@ -69,11 +88,29 @@ public:
 
     const size_t global_rid(const size_t local_rid) const;
     const size_t local_rid(const size_t global_rid) const;
+    // The rank that owns a global row
+    const int owner(const size_t global_rid) const;
     void pp_aggregate();
+    // Reduce centroids in nchunks non-blocking chunks overlapped with
+    //  finalizing the means. 0 restores blocking reductions.
+    void set_overlap(const unsigned nchunks) { overlap_chunks = nchunks; }
+    // Move rows between procs once the slowest proc's E-step has taken
+    //  more than (1 + tol) times the mean for a few iterations in a row,
+    //  or far more than that once. 0 disables.
+    void set_rebalance(const double tol) { rebalance_tol = tol; }
+    // Send blocking centroid reductions as float offsets from the last
+    //  means, then recompute the final means in double
+    void set_float_reduce(const bool float_reduce) {
+        this->float_reduce = float_reduce;
+    }
+    // How ranks read their rows: "thread", "mpiio" or "node"
+    void set_read_mode(const std::string mode) {
+        read_mode = kmpi::get_read_mode(mode);
+    }
     void shift_thread_start_rid();
 
     const int get_nprocs() const { return nprocs; }
-    const size_t init(int argc, char* argv[], const size_t g_nrow);
+    const size_t init(kbase::row_partition::ptr part);
     ~dist_coordinator();
 };
 } } // End namespace knor::dist
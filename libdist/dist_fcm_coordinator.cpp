@@ -0,0 +1,150 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+
+#include "dist_fcm_coordinator.hpp"
+#include "dense_matrix.hpp"
+#include "mpi.hpp"
+#include "util.hpp"
+
+namespace knor { namespace dist {
+
+dist_fcm_coordinator::dist_fcm_coordinator(row_comm::ptr comm,
+        const std::string fn,
+        const size_t ncol, const unsigned k, const unsigned max_iters,
+        const unsigned nnodes, const unsigned nthreads,
+        const double* centers, const kbase::init_t it,
+        const double tolerance, const kbase::dist_t dt,
+        const unsigned fuzzindex) :
+    fcm_coordinator(fn, comm->get_nrow(), ncol, k, max_iters, nnodes,
+            nthreads, centers, it, tolerance, dt, fuzzindex),
+    comm(comm) {
+}
+
+void dist_fcm_coordinator::forgy_init() {
+    // Every proc draws the same global rows
+    std::default_random_engine generator;
+    std::uniform_int_distribution<unsigned> distribution(0,
+            comm->get_g_nrow()-1);
+    std::vector<double> row(ncol);
+
+    for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) { // 0...k
+        comm->bcast_row(*this, distribution(generator), &row[0]);
+        centers->set_row(&row[0], clust_idx);
+    }
+}
+
+void dist_fcm_coordinator::reduce_sums() {
+    // One reduction for the center numerators and membership sums
+    const size_t nelem = k*ncol;
+    sums_buff.resize(nelem + k);
+    std::copy(centers->as_pointer(), centers->as_pointer() + nelem,
+            sums_buff.begin());
+    std::copy(um_sum.begin(), um_sum.end(), sums_buff.begin() + nelem);
+
+    comm->reduce(sums_buff);
+
+    std::copy(sums_buff.begin(), sums_buff.begin() + nelem,
+            centers->as_pointer());
+    std::copy(sums_buff.begin() + nelem, sums_buff.end(), um_sum.begin());
+}
+
+void dist_fcm_coordinator::run(kbase::cluster_t& ret,
+        const std::string outdir) {
+    if (comm->is_root()) {
+        if (outdir.empty())
+            fprintf(stderr, "\n**[WARNING]**: No output dir specified with "
+                    "'-o' flag means no output will be saved!\n");
+#ifndef BIND
+        printf("Running distributed fcm\n");
+#endif
+    }
+
+    comm->shift_start_rids(threads, true);
+    wake4run(ALLOC_DATA);
+    wait4complete();
+    comm->shift_start_rids(threads, false);
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+    run_init(); // Initialize clusters
+
+    bool converged = false;
+    size_t iter = 0;
+
+    if (max_iters > 0)
+        iter++;
+
+    while (iter <= max_iters && max_iters > 0) {
+#ifndef BIND
+        if (comm->is_root())
+            printf("Running iteration: %lu\n", iter);
+#endif
+        // Compute new um and the per-thread center sums
+        wake4run(E);
+        wait4complete();
+
+        prev_centers->copy_from(centers);
+        update_centers(); // Sums are reduced over all procs
+
+        // Identical on every proc
+        auto frob_norm = centers->frobenius_diff(*prev_centers);
+#ifndef BIND
+        if (comm->is_root())
+            printf("Centers frob diff: %f\n\n", frob_norm);
+#endif
+
+        if (frob_norm < tolerance) {
+            converged = true;
+            break;
+        }
+
+        iter++;
+    }
+
+    gettimeofday(&end, NULL);
+#ifndef BIND
+    if (comm->is_root()) {
+        printf("\n\nAlgorithmic time taken = %.6f sec\n",
+                kbase::time_diff(start, end));
+        if (converged)
+            printf("Fuzzy C-means converged in %lu iterations\n", iter);
+        else
+            printf("[Warning]: Fuzzy C-means failed to converge in %lu"
+                    " iterations\n", iter);
+    }
+#endif
+
+    // Assignments are from the last Estep
+    comm->write_result(ret, ncol, iter, k, &cluster_assignments[0],
+            centers->as_vector(), outdir);
+
+#ifndef BIND
+    if (comm->is_root()) {
+        printf("Final cluster assignment count:\n");
+        kbase::print(ret.assignment_count);
+    }
+#endif
+}
+
+dist_fcm_coordinator::~dist_fcm_coordinator() {
+    mpi::mpi::finalize();
+}
+} } // End namespace knor::dist
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <numeric>
+
+#include "dist_gmeans_coordinator.hpp"
+#include "gmeans.hpp"
+#include "AndersonDarling.hpp"
+#include "member_index.hpp"
+#include "mpi.hpp"
+
+namespace knor { namespace dist {
+
+dist_gmeans_coordinator::dist_gmeans_coordinator(hclust_comm::ptr comm,
+        const std::string fn,
+        const size_t ncol, const unsigned k, const unsigned max_iters,
+        const unsigned nnodes, const unsigned nthreads,
+        const double* centers, const kbase::init_t it,
+        const double tolerance, const kbase::dist_t dt,
+        const unsigned min_clust_size, const short strictness,
+        const size_t ad_bins) :
+    dist_split_base<gmeans_coordinator>(comm, fn, ncol, k, max_iters, nnodes,
+            nthreads, centers, it, tolerance, dt, min_clust_size, strictness,
+            ad_bins) { }
+
+void dist_gmeans_coordinator::end_round() {
+    compute_cluster_diffs();
+    wake4run(H_SPLIT);
+    wait4complete();
+
+    // Decide on split or not here. AD inputs come from every proc.
+    partition_decision();
+}
+
+void dist_gmeans_coordinator::assemble_ad_vecs() {
+    gmeans_coordinator::assemble_ad_vecs();
+
+    std::vector<llong_t> sizes(part_index->get_nclust());
+    for (size_t pid = 0; pid < sizes.size(); pid++)
+        sizes[pid] = part_index->size(pid);
+    g_part_sizes.resize(sizes.size());
+    kmpi::mpi::reduce_llong_t(&sizes[0], &g_part_sizes[0], sizes.size());
+}
+
+const size_t dist_gmeans_coordinator::count_partitions() const {
+    size_t nparts = 0;
+    for (auto const& size : g_part_sizes)
+        if (size)
+            nparts++;
+    return nparts;
+}
+
+void dist_gmeans_coordinator::compute_ad_stats(
+        const std::vector<size_t>& pids, std::vector<double>& scores) {
+    scores.resize(pids.size());
+
+    // Partitions that a single proc would sort are gathered, the rest are
+    //  binned. The bucket sums of each proc's rows add up over all procs.
+    std::vector<size_t> exact, binned;
+    for (size_t idx = 0; idx < pids.size(); idx++) {
+        if (ad_bins && g_part_sizes[pids[idx]] > ad_bins)
+            binned.push_back(idx);
+        else
+            exact.push_back(idx);
+    }
+
+    gather_ad_stats(pids, exact, scores);
+    bin_ad_stats(pids, binned, scores);
+}
+
+void dist_gmeans_coordinator::gather_ad_stats(
+        const std::vector<size_t>& pids, const std::vector<size_t>& idxs,
+        std::vector<double>& scores) {
+    if (idxs.empty())
+        return;
+
+    const int nprocs = mpi::transport::get()->get_nprocs();
+    const size_t nparts = idxs.size();
+
+    std::vector<int> lens(nparts);
+    std::vector<double> send;
+    for (size_t i = 0; i < nparts; i++) {
+        const unsigned pid = pids[idxs[i]];
+        lens[i] = part_index->size(pid);
+        auto begin = ad_buf.begin() + part_index->offset(pid);
+        send.insert(send.end(), begin, begin + lens[i]);
+    }
+
+    std::vector<int> all_lens(nprocs*nparts);
+    mpi::transport::get()->allgather(&lens[0], &all_lens[0], nparts,
+            mpi::INT);
+
+    std::vector<int> counts(nprocs, 0), displs(nprocs, 0);
+    for (int proc = 0; proc < nprocs; proc++) {
+        for (size_t i = 0; i < nparts; i++)
+            counts[proc] += all_lens[proc*nparts + i];
+        if (proc)
+            displs[proc] = displs[proc-1] + counts[proc-1];
+    }
+    std::vector<double> recv(displs.back() + counts.back());
+    mpi::transport::get()->allgatherv(send.empty() ? NULL : &send[0],
+            send.size(), recv.empty() ? NULL : &recv[0], &counts[0],
+            &displs[0], mpi::DOUBLE);
+
+    // Group each partition's projections from every proc
+    std::vector<size_t> offsets(nparts + 1, 0);
+    for (size_t i = 0; i < nparts; i++)
+        offsets[i+1] = offsets[i] + g_part_sizes[pids[idxs[i]]];
+    std::vector<double> X(offsets.back());
+    std::vector<size_t> pos(offsets.begin(), offsets.end() - 1);
+    for (int proc = 0; proc < nprocs; proc++) {
+        const double* src = &recv[displs[proc]];
+        for (size_t i = 0; i < nparts; i++) {
+            const int len = all_lens[proc*nparts + i];
+            std::copy(src, src + len, &X[pos[i]]);
+            pos[i] += len;
+            src += len;
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t i = 0; i < nparts; i++)
+        scores[idxs[i]] = kbase::AndersonDarling::compute_statistic(
+                offsets[i+1] - offsets[i], &X[offsets[i]]);
+}
+
+void dist_gmeans_coordinator::bin_ad_stats(
+        const std::vector<size_t>& pids, const std::vector<size_t>& idxs,
+        std::vector<double>& scores) {
+    if (idxs.empty())
+        return;
+    const size_t nparts = idxs.size();
+
+    // Mean, then the standard deviation about it, over all procs
+    std::vector<double> moments(nparts, 0), g_avg(nparts), g_sig(nparts);
+    for (size_t i = 0; i < nparts; i++) {
+        const unsigned pid = pids[idxs[i]];
+        const double* X = &ad_buf[part_index->offset(pid)];
+        moments[i] = std::accumulate(X, X + part_index->size(pid), 0.0);
+    }
+    kmpi::mpi::reduce_double(&moments[0], &g_avg[0], nparts);
+    for (size_t i = 0; i < nparts; i++) {
+        const unsigned pid = pids[idxs[i]];
+        const double* X = &ad_buf[part_index->offset(pid)];
+        g_avg[i] /= static_cast<double>(g_part_sizes[pid]);
+        moments[i] = 0;
+        for (size_t row = 0; row < part_index->size(pid); row++)
+            moments[i] += (X[row] - g_avg[i]) * (X[row] - g_avg[i]);
+    }
+    kmpi::mpi::reduce_double(&moments[0], &g_sig[0], nparts);
+
+    std::vector<double> sums(nparts*4*ad_bins, 0), g_sums(sums.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t i = 0; i < nparts; i++) {
+        const unsigned pid = pids[idxs[i]];
+        g_sig[i] = std::sqrt(g_sig[i] / (g_part_sizes[pid] - 1));
+        kbase::AndersonDarling::bin_sums(part_index->size(pid),
+                &ad_buf[part_index->offset(pid)], g_avg[i], g_sig[i], ad_bins,
+                &sums[i*4*ad_bins]);
+    }
+    kmpi::mpi::reduce_double(&sums[0], &g_sums[0], sums.size());
+
+    for (size_t i = 0; i < nparts; i++)
+        scores[idxs[i]] = kbase::AndersonDarling::binned_statistic(
+                g_part_sizes[pids[idxs[i]]], ad_bins, &g_sums[i*4*ad_bins]);
+}
+} } // End namespace knor::dist
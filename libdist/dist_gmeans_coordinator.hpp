@@ -0,0 +1,84 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_DIST_GMEANS_COORDINATOR_HPP__
+#define __KNOR_DIST_GMEANS_COORDINATOR_HPP__
+
+#include "gmeans_coordinator.hpp"
+#include "dist_partition.hpp"
+#include "dist_hclust_base.hpp"
+
+namespace kbase = knor::base;
+namespace kmpi = knor::mpi;
+
+namespace knor { namespace dist {
+
+class dist_gmeans_coordinator :
+    public dist_split_base<knor::gmeans_coordinator> {
+private:
+    dist_gmeans_coordinator(hclust_comm::ptr comm, const std::string fn,
+            const size_t ncol, const unsigned k, const unsigned max_iters,
+            const unsigned nnodes, const unsigned nthreads,
+            const double* centers, const kbase::init_t it,
+            const double tolerance, const kbase::dist_t dt,
+            const unsigned min_clust_size, const short strictness,
+            const size_t ad_bins);
+
+    std::vector<size_t> g_part_sizes; // Rows in each partition on all procs
+
+    // AD statistics of the partitions pids[idxs] from all their projections
+    void gather_ad_stats(const std::vector<size_t>& pids,
+            const std::vector<size_t>& idxs, std::vector<double>& scores);
+    // Binned AD statistics of the partitions pids[idxs] from bucket sums
+    void bin_ad_stats(const std::vector<size_t>& pids,
+            const std::vector<size_t>& idxs, std::vector<double>& scores);
+
+protected:
+    const char* get_name() const override { return "gmeans"; }
+    // Splits are tested on the partitions' projections, from every proc
+    void end_round() override;
+
+public:
+    static coordinator::ptr create(int argc, char* argv[],
+            const std::string fn, const size_t nrow,
+            const size_t ncol, const unsigned k, const unsigned max_iters,
+            const unsigned nnodes, const unsigned nthreads,
+            const double* centers=NULL, const std::string init="forgy",
+            const double tolerance=-1, const std::string dist_type="eucl",
+            const unsigned min_clust_size=2, const short strictness=4,
+            const size_t ad_bins=0, const std::string partition="even") {
+
+        kbase::init_t _init_t = kbase::get_init_type(init);
+        kbase::dist_t _dist_t = kbase::get_dist_type(dist_type);
+        kbase::row_partition::ptr part = kmpi::partition_rows(argc, argv,
+                partition, fn, nrow, ncol, k, nthreads, _dist_t);
+
+        return coordinator::ptr(
+                new dist_gmeans_coordinator(hclust_comm::create(part), fn,
+                    ncol, k, max_iters, nnodes, nthreads, centers, _init_t,
+                    tolerance, _dist_t, min_clust_size, strictness, ad_bins));
+    }
+
+    void assemble_ad_vecs() override;
+    const size_t count_partitions() const override;
+    void compute_ad_stats(const std::vector<size_t>& pids,
+            std::vector<double>& scores) override;
+};
+} } // End namespace knor::dist
+#endif
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <limits>
+#include <cmath>
+
+#include "dist_gmm_coordinator.hpp"
+#include "dense_matrix.hpp"
+#include "mpi.hpp"
+#include "util.hpp"
+
+namespace knor { namespace dist {
+
+dist_gmm_coordinator::dist_gmm_coordinator(row_comm::ptr comm,
+        const std::string fn,
+        const size_t ncol, const unsigned k, const unsigned max_iters,
+        double* mu_k, const unsigned nnodes, const unsigned nthreads,
+        const kbase::init_t it, const double tolerance,
+        const kbase::dist_t dt, const double cov_regularizer,
+        const kbase::cov_t ct) :
+    gmm_coordinator(fn, comm->get_nrow(), ncol, k, max_iters, mu_k, nnodes,
+            nthreads, it, tolerance, dt, cov_regularizer, ct),
+    comm(comm) {
+        this->g_nrow = comm->get_g_nrow();
+}
+
+void dist_gmm_coordinator::forgy_init() {
+    // Every proc draws the same global rows
+    std::default_random_engine generator;
+    std::uniform_int_distribution<unsigned> distribution(0, g_nrow-1);
+    std::vector<double> row(ncol);
+
+    for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) { // 0...k
+        comm->bcast_row(*this, distribution(generator), &row[0]);
+        mu_k->set_row(&row[0], clust_idx);
+    }
+}
+
+void dist_gmm_coordinator::kmeanspp_init() {
+    const unsigned nprocs = comm->get_nprocs();
+    std::vector<double> center(ncol);
+    std::vector<double> rank_sums(nprocs);
+    std::vector<double> dist_v;
+    dist_v.assign(nrow, std::numeric_limits<double>::max()); // local nrow
+    set_thd_dist_v_ptr(&dist_v[0]);
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<unsigned> distribution(0, g_nrow-1);
+
+    // Choose c1 uniformly at random
+    unsigned selected_idx = distribution(generator);
+    if (comm->is_local(selected_idx)) {
+        const size_t lrid = comm->local_rid(selected_idx);
+        dist_v[lrid] = 0;
+        cluster_assignments[lrid] = 0;
+    }
+    comm->bcast_row(*this, selected_idx, &center[0]);
+    mu_k->set_row(&center[0], 0);
+
+    unsigned clust_idx = 0; // The number of clusters assigned
+
+    std::uniform_real_distribution<double> ur_distribution(0.0, 1.0);
+
+    // Choose next center c_i with weighted prob. Every proc walks the per
+    //  proc sums of dist_v with the same draw, the owner walks its own rows.
+    while (true) {
+        set_thread_clust_idx(clust_idx); // Set the current cluster index
+        wake4run(KMSPP_INIT); // Run || distance comp to clust_idx
+        wait4complete();
+        double local_cuml_dist = reduction_on_cuml_sum();
+
+        kmpi::mpi::allgather_double(&local_cuml_dist, &rank_sums[0], 1);
+        double cuml_dist = 0;
+        for (unsigned proc = 0; proc < nprocs; proc++)
+            cuml_dist += rank_sums[proc];
+
+        cuml_dist *= ur_distribution(generator);
+        if (++clust_idx >= k)  // No more  needed
+            break;
+
+        const int owner_proc = static_cast<int>(
+                kbase::weighted_select(&rank_sums[0], nprocs, cuml_dist));
+        if (owner_proc == comm->get_rank()) {
+            const size_t lrid = kbase::weighted_select(&dist_v[0],
+                    nrow, cuml_dist);
+            std::copy(get_thd_data(lrid), get_thd_data(lrid) + ncol,
+                    &center[0]);
+            cluster_assignments[lrid] = clust_idx;
+        }
+
+        kmpi::mpi::bcast_double(&center[0], owner_proc, ncol);
+        mu_k->set_row(&center[0], clust_idx);
+    }
+}
+
+void dist_gmm_coordinator::reduce_stats() {
+    gmm_coordinator::reduce_stats();
+    comm->reduce(stats); // Sums, log-likelihood and changed over all procs
+}
+
+void dist_gmm_coordinator::run(kbase::cluster_t& ret,
+        const std::string outdir) {
+    if (comm->is_root()) {
+        if (outdir.empty())
+            fprintf(stderr, "\n**[WARNING]**: No output dir specified with "
+                    "'-o' flag means no output will be saved!\n");
+#ifndef BIND
+        printf("Running distributed gmm\n");
+#endif
+    }
+
+    comm->shift_start_rids(threads, true);
+    wake4run(ALLOC_DATA);
+    wait4complete();
+    comm->shift_start_rids(threads, false);
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+    run_init(); // Initialize clusters
+
+    compute_shared_linalg();
+
+    // Run EM loop
+    bool converged = false;
+    size_t iter = 0;
+
+    if (max_iters > 0)
+        iter++;
+
+    while (iter <= max_iters && max_iters > 0) {
+        if (iter == 1)
+            clear_cluster_assignments();
+
+        wake4run(E);
+        wait4complete();
+
+        double prev_L = L;
+        update_clusters(); // Statistics are reduced over all procs
+
+#if VERBOSE
+#ifndef BIND
+        if (comm->is_root())
+            printf("Iter: %lu, log-likelihood: %.6f, changed: %lu\n",
+                    iter, L, num_changed);
+#endif
+#endif
+
+        // Converge when the mean log-likelihood stops improving
+        if (iter > 1 && std::abs(L - prev_L)/g_nrow <= tolerance) {
+            converged = true;
+            break;
+        }
+        iter++;
+    }
+
+    gettimeofday(&end, NULL);
+#ifndef BIND
+    if (comm->is_root()) {
+        printf("\n\nAlgorithmic time taken = %.6f sec\n",
+                kbase::time_diff(start, end));
+        if (converged)
+            printf("GMM converged in %lu iterations\n", iter);
+        else
+            printf("[Warning]: GMM failed to converge in %lu"
+                    " iterations\n", iter);
+    }
+#endif
+
+    comm->write_result(ret, ncol, iter, k, &cluster_assignments[0],
+            mu_k->as_vector(), outdir);
+
+#ifndef BIND
+    if (comm->is_root()) {
+        printf("Final log-likelihood: %.6f\n", L);
+        printf("Final cluster counts: \n");
+        kbase::print(ret.assignment_count);
+    }
+#endif
+}
+
+dist_gmm_coordinator::~dist_gmm_coordinator() {
+    mpi::mpi::finalize();
+}
+} } // End namespace knor::dist
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_DIST_GMM_COORDINATOR_HPP__
+#define __KNOR_DIST_GMM_COORDINATOR_HPP__
+
+#include "gmm_coordinator.hpp"
+#include "dist_partition.hpp"
+#include "row_comm.hpp"
+
+namespace kbase = knor::base;
+namespace kmpi = knor::mpi;
+
+namespace knor { namespace dist {
+
+/**
+  * EM for a gaussian mixture over the rows of all procs. Each proc keeps the
+  *  responsibilities of its own rows (nrow x k), only the E-step sufficient
+  *  statistics are reduced each iteration.
+  */
+class dist_gmm_coordinator : public knor::gmm_coordinator {
+private:
+    dist_gmm_coordinator(row_comm::ptr comm, const std::string fn,
+            const size_t ncol, const unsigned k, const unsigned max_iters,
+            double* mu_k, const unsigned nnodes, const unsigned nthreads,
+            const kbase::init_t it, const double tolerance,
+            const kbase::dist_t dt, const double cov_regularizer,
+            const kbase::cov_t ct);
+
+    row_comm::ptr comm;
+
+public:
+    static coordinator::ptr create(int argc, char* argv[],
+            const std::string fn, const size_t nrow,
+            const size_t ncol, const unsigned k, const unsigned max_iters,
+            double* mu_k, const unsigned nnodes, const unsigned nthreads,
+            const std::string init="random", const double tolerance=1E-3,
+            const std::string dist_type="eucl",
+            const double cov_regularizer=1E-6,
+            const std::string cov_type="full",
+            const std::string partition="even") {
+
+        kbase::init_t _init_t = kbase::get_init_type(init);
+        kbase::dist_t _dist_t = kbase::get_dist_type(dist_type);
+        kbase::cov_t _cov_t = kbase::get_cov_type(cov_type);
+        kbase::row_partition::ptr part = kmpi::partition_rows(argc, argv,
+                partition, fn, nrow, ncol, k, nthreads, _dist_t);
+
+        return coordinator::ptr(
+                new dist_gmm_coordinator(row_comm::create(part), fn,
+                    ncol, k, max_iters, mu_k, nnodes, nthreads, _init_t,
+                    tolerance, _dist_t, cov_regularizer, _cov_t));
+    }
+
+    void forgy_init() override;
+    void kmeanspp_init() override;
+    void reduce_stats() override;
+    // Hard assignment of each row to its most likely component
+    void run(kbase::cluster_t& ret, const std::string outdir="");
+    ~dist_gmm_coordinator();
+};
+} } // End namespace knor::dist
+#endif
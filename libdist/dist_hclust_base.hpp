@@ -0,0 +1,232 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_DIST_HCLUST_BASE_HPP__
+#define __KNOR_DIST_HCLUST_BASE_HPP__
+
+#include <numeric>
+#include <utility>
+
+#include "hclust_comm.hpp"
+#include "hclust_id_generator.hpp"
+#include "hcluster_arena.hpp"
+#include "clusters.hpp"
+#include "mpi.hpp"
+#include "util.hpp"
+
+namespace kbase = knor::base;
+
+namespace knor { namespace dist {
+
+/**
+  * What every distributed divisive coordinator adds to its single-node
+  *  base: seeds and accumulators go through an hclust_comm, and run()
+  *  drives the rounds of EM steps and splits over all procs.
+  * \param Base hclust_coordinator or one of its subclasses
+  */
+template <typename Base>
+class dist_hclust_base : public Base {
+protected:
+    hclust_comm::ptr comm;
+
+    // args are the Base constructor's after nrow
+    template <typename... Args>
+    dist_hclust_base(hclust_comm::ptr comm, const std::string fn,
+            Args&&... args) :
+        Base(fn, comm->get_nrow(), std::forward<Args>(args)...),
+        comm(comm) {
+            // Every proc draws the same global rows
+            this->ui_distribution = std::uniform_int_distribution<unsigned>(
+                    0, comm->get_g_nrow()-1);
+    }
+
+    // Algorithm name for the banner
+    virtual const char* get_name() const = 0;
+    // Before the EM steps of every round
+    virtual void begin_round() { }
+    // After each EM step
+    virtual void end_iter() { }
+    // After a round's EM steps, before checking the cluster cap
+    virtual void end_round() { }
+
+public:
+    void forgy_init() override {
+        auto splits = this->ider->get_split_ids();
+        std::vector<double> row(this->ncol);
+
+        comm->bcast_row(*this, this->ui_distribution(this->ui_generator),
+                &row[0]);
+        this->hcltrs->set_mean(0, 0, &row[0]);
+        this->hcltrs->set_zeroid(0, splits.first);
+        this->activate(splits.first);
+
+        comm->bcast_row(*this, this->ui_distribution(this->ui_generator),
+                &row[0]);
+        this->hcltrs->set_mean(0, 1, &row[0]);
+        this->hcltrs->set_oneid(0, splits.second);
+        this->activate(splits.second);
+    }
+
+    void reduce_accumulators() override {
+        comm->reduce(this->threads, this->hcltrs, this->nchanged);
+    }
+
+    void init_splits() override {
+        this->build_member_index();
+        comm->gather_seeds(*this, this->hcltrs, this->memb_index);
+        hclust_coordinator::init_splits();
+    }
+
+    const bool get_split_seeds(const unsigned cid,
+            unsigned& s0, unsigned& s1) override {
+        return comm->get_seeds(cid, s0, s1);
+    }
+
+    const double* get_seed(const unsigned rid) override {
+        return comm->get_seed(rid);
+    }
+
+    void run(kbase::cluster_t& ret, const std::string outdir="") {
+        if (comm->is_root()) {
+            if (outdir.empty())
+                fprintf(stderr, "\n**[WARNING]**: No output dir specified "
+                        "with '-o' flag means no output will be saved!\n");
+#ifndef BIND
+            printf("Running distributed %s\n", get_name());
+#endif
+        }
+
+        this->build_thread_state();
+        comm->shift_start_rids(this->threads, true);
+        this->wake4run(ALLOC_DATA);
+        this->wait4complete();
+        comm->shift_start_rids(this->threads, false);
+
+        struct timeval start, end;
+        gettimeofday(&start , NULL);
+
+        this->run_hinit(); // Initialize clusters
+
+        size_t iter = 0;
+        while (true) {
+#ifndef BIND
+            if (comm->is_root())
+                printf("\n\nNCLUST: %lu, Iteration: ", this->curr_nclust);
+#endif
+            begin_round();
+
+            for (iter = 0; iter < this->max_iters; iter++) {
+#ifndef BIND
+                if (comm->is_root())
+                    printf("%lu ", iter);
+#endif
+                this->hcltrs->assign_slots();
+                this->wake4run(H_EM);
+                this->wait4complete();
+                this->update_clusters();
+                end_iter();
+            }
+
+            end_round();
+
+            if (this->at_cluster_cap()) {
+#ifndef BIND
+                if (comm->is_root())
+                    printf("\n\nCLUSTER SIZE EXIT @ %lu!\n",
+                            this->curr_nclust);
+#endif
+                break;
+            }
+
+            init_splits(); // Seeds are gathered from every proc
+
+            if (this->hcltrs->keyless()) {
+#ifndef BIND
+                if (comm->is_root())
+                    printf("\n\nSTEADY STATE EXIT!\n");
+#endif
+                break;
+            }
+        }
+
+        this->complete_final_centroids();
+        assert((size_t)std::accumulate(
+                    this->cluster_assignment_counts.begin(),
+                    this->cluster_assignment_counts.end(), (llong_t)0) ==
+                comm->get_g_nrow());
+
+        gettimeofday(&end, NULL);
+#ifndef BIND
+        if (comm->is_root()) {
+            printf("\n\nAlgorithmic time taken = %.6f sec\n",
+                    kbase::time_diff(start, end));
+            printf("Final cluster counts: \n");
+            kbase::sparse_print(this->cluster_assignment_counts);
+        }
+#endif
+
+        comm->write_result(ret, this->ncol, iter,
+                this->cluster_assignments, this->cluster_assignment_counts,
+                this->final_centroids, outdir);
+    }
+
+    virtual ~dist_hclust_base() {
+        mpi::mpi::finalize();
+    }
+};
+
+/**
+  * The xmeans family, which also re-means each partition over all procs
+  *  before a round and decides which partitions split after it.
+  * \param Base xmeans_coordinator or one of its subclasses
+  */
+template <typename Base>
+class dist_split_base : public dist_hclust_base<Base> {
+protected:
+    template <typename... Args>
+    dist_split_base(hclust_comm::ptr comm, const std::string fn,
+            Args&&... args) :
+        dist_hclust_base<Base>(comm, fn, std::forward<Args>(args)...) { }
+
+    void begin_round() override {
+        this->wake4run(MEAN);
+        this->wait4complete();
+        combine_partition_means();
+        this->compute_pdist = true;
+    }
+
+    void end_iter() override {
+        if (this->compute_pdist)
+            this->compute_pdist = false;
+    }
+
+    // Decide on split or not here
+    void end_round() override {
+        this->partition_decision();
+    }
+
+public:
+    void combine_partition_means() override {
+        this->cltrs->unfinalize_all();
+        this->comm->reduce_partitions(this->threads, this->cltrs);
+        this->cltrs->finalize_all();
+    }
+};
+} } // End namespace knor::dist
+#endif
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dist_hclust_coordinator.hpp"
+
+namespace knor { namespace dist {
+
+dist_hclust_coordinator::dist_hclust_coordinator(hclust_comm::ptr comm,
+        const std::string fn,
+        const size_t ncol, const unsigned k, const unsigned max_iters,
+        const unsigned nnodes, const unsigned nthreads,
+        const double* centers, const kbase::init_t it,
+        const double tolerance, const kbase::dist_t dt,
+        const unsigned min_clust_size) :
+    dist_hclust_base<hclust_coordinator>(comm, fn, ncol, k, max_iters, nnodes,
+            nthreads, centers, it, tolerance, dt, min_clust_size) { }
+} } // End namespace knor::dist
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_DIST_HCLUST_COORDINATOR_HPP__
+#define __KNOR_DIST_HCLUST_COORDINATOR_HPP__
+
+#include "hclust_coordinator.hpp"
+#include "dist_partition.hpp"
+#include "dist_hclust_base.hpp"
+
+namespace kbase = knor::base;
+namespace kmpi = knor::mpi;
+
+namespace knor { namespace dist {
+
+class dist_hclust_coordinator :
+    public dist_hclust_base<knor::hclust_coordinator> {
+private:
+    dist_hclust_coordinator(hclust_comm::ptr comm, const std::string fn,
+            const size_t ncol, const unsigned k, const unsigned max_iters,
+            const unsigned nnodes, const unsigned nthreads,
+            const double* centers, const kbase::init_t it,
+            const double tolerance, const kbase::dist_t dt,
+            const unsigned min_clust_size);
+
+protected:
+    const char* get_name() const override { return "hmeans"; }
+
+public:
+    static coordinator::ptr create(int argc, char* argv[],
+            const std::string fn, const size_t nrow,
+            const size_t ncol, const unsigned k, const unsigned max_iters,
+            const unsigned nnodes, const unsigned nthreads,
+            const double* centers=NULL, const std::string init="forgy",
+            const double tolerance=-1, const std::string dist_type="eucl",
+            const unsigned min_clust_size=2,
+            const std::string partition="even") {
+
+        kbase::init_t _init_t = kbase::get_init_type(init);
+        kbase::dist_t _dist_t = kbase::get_dist_type(dist_type);
+        kbase::row_partition::ptr part = kmpi::partition_rows(argc, argv,
+                partition, fn, nrow, ncol, k, nthreads, _dist_t);
+
+        return coordinator::ptr(
+                new dist_hclust_coordinator(hclust_comm::create(part), fn,
+                    ncol, k, max_iters, nnodes, nthreads, centers, _init_t,
+                    tolerance, _dist_t, min_clust_size));
+    }
+};
+} } // End namespace knor::dist
+#endif
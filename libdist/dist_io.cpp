@@ -0,0 +1,308 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mpi.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cerrno>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "dist_io.hpp"
+#include "transport.hpp"
+#include "exception.hpp"
+
+namespace knor { namespace mpi {
+
+// Largest single MPI-IO request, counts are ints
+static const size_t MAX_IO_BYTES = 1UL << 30;
+
+static void check(const int ret, const std::string msg) {
+    if (ret != MPI_SUCCESS)
+        throw base::mpi_exception(msg, ret);
+}
+
+static void pwrite_all(const int fd, const char* buf, size_t nbytes,
+        off_t offset, const std::string& fn) {
+    while (nbytes) {
+        ssize_t n = pwrite(fd, buf, nbytes, offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw base::io_exception("Cannot write " + fn);
+        }
+        buf += n;
+        nbytes -= n;
+        offset += n;
+    }
+}
+
+// Procs without MPI-IO share the file system of one machine
+static void write_posix(const std::string fn, const std::string& head,
+        const std::string& body, const std::string& tail,
+        const size_t offset, const size_t total) {
+    transport::ptr comm = transport::get();
+    const int rank = comm->get_rank();
+
+    if (rank == 0) {
+        int fd = open(fn.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if (fd < 0)
+            throw base::io_exception("Cannot open " + fn);
+        close(fd);
+    }
+    comm->barrier(); // Truncated before anyone writes
+
+    int fd = open(fn.c_str(), O_WRONLY);
+    if (fd < 0)
+        throw base::io_exception("Cannot open " + fn);
+    pwrite_all(fd, body.data(), body.size(), head.size() + offset, fn);
+    if (rank == 0) {
+        pwrite_all(fd, head.data(), head.size(), 0, fn);
+        pwrite_all(fd, tail.data(), tail.size(), head.size() + total, fn);
+    }
+    close(fd);
+    comm->barrier();
+}
+
+void write_cluster_t(const base::cluster_t& ret,
+        const unsigned* local_assignments, const size_t local_nrow,
+        const size_t first_row, const std::string dirname) {
+    transport::ptr comm = transport::get();
+    const int rank = comm->get_rank();
+
+    // Only root creates the directory
+    std::vector<char> fn(4096, 0);
+    if (rank == 0) {
+        std::string path = base::cluster_t::make_outfn(dirname);
+        if (path.size() >= fn.size())
+            throw base::io_exception("Output path too long: " + path);
+        std::copy(path.begin(), path.end(), fn.begin());
+    }
+    comm->bcast(&fn[0], fn.size(), CHAR, 0);
+
+    const std::string head = ret.yml_head();
+    const std::string body = base::cluster_t::yml_assignments(
+            local_assignments, local_nrow, first_row == 0);
+
+    // Procs hold consecutive rows so their text is laid out in rank order
+    unsigned long long len = body.size();
+    std::vector<unsigned long long> lens(comm->get_nprocs());
+    comm->allgather(&len, &lens[0], 1, ULLONG);
+    const unsigned long long offset = std::accumulate(lens.begin(),
+            lens.begin() + rank, 0ULL);
+    const unsigned long long total = std::accumulate(lens.begin(),
+            lens.end(), 0ULL);
+
+    if (!comm->is_mpi()) {
+        write_posix(&fn[0], head, body, ret.yml_tail(), offset, total);
+        return;
+    }
+
+    MPI_File fh;
+    check(MPI_File_open(MPI_COMM_WORLD, &fn[0],
+                MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh),
+            std::string("Cannot open ") + &fn[0]);
+    check(MPI_File_set_size(fh, 0), "Cannot truncate output file");
+
+    // Every proc must make the same number of collective calls
+    unsigned long long nwrites = (len + MAX_IO_BYTES - 1) / MAX_IO_BYTES;
+    unsigned long long max_nwrites = 0;
+    check(MPI_Allreduce(&nwrites, &max_nwrites, 1, MPI_UNSIGNED_LONG_LONG,
+                MPI_MAX, MPI_COMM_WORLD), "Allreduce failure of nwrites");
+
+    for (size_t i = 0; i < max_nwrites; i++) {
+        const size_t start = std::min(i*MAX_IO_BYTES, body.size());
+        const size_t nbytes = std::min(MAX_IO_BYTES, body.size() - start);
+        check(MPI_File_write_at_all(fh, head.size() + offset + start,
+                    body.data() + start, nbytes, MPI_CHAR,
+                    MPI_STATUS_IGNORE), "Collective write of assignments");
+    }
+
+    if (rank == 0) {
+        const std::string tail = ret.yml_tail();
+        check(MPI_File_write_at(fh, 0, head.data(), head.size(), MPI_CHAR,
+                    MPI_STATUS_IGNORE), "Write of output header");
+        check(MPI_File_write_at(fh, head.size() + total, tail.data(),
+                    tail.size(), MPI_CHAR, MPI_STATUS_IGNORE),
+                "Write of output trailer");
+    }
+    check(MPI_File_close(&fh), "Cannot close output file");
+}
+
+read_mode_t get_read_mode(const std::string mode) {
+    if (mode == "thread")
+        return read_mode_t::THREAD_READ;
+    else if (mode == "mpiio")
+        return read_mode_t::COLLECTIVE_READ;
+    else if (mode == "node")
+        return read_mode_t::NODE_READ;
+    else
+        throw base::parameter_exception(std::string("read mode must be one"
+                    " of: [thread | mpiio | node]. It is '") + mode + "'");
+}
+
+// Hints asking ROMIO to aggregate reads into few large aligned requests
+static MPI_Info read_hints() {
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, const_cast<char*>("romio_cb_read"),
+            const_cast<char*>("enable"));
+    MPI_Info_set(info, const_cast<char*>("cb_buffer_size"),
+            const_cast<char*>("16777216"));
+    return info;
+}
+
+static int row_count(const size_t nrow) {
+    if (nrow > INT_MAX)
+        throw base::parameter_exception("Too many rows for one MPI read");
+    return nrow;
+}
+
+// One datatype describing every thread buffer by absolute address
+static MPI_Datatype block_type(const std::vector<row_block>& blocks,
+        MPI_Datatype row_t) {
+    std::vector<int> lens;
+    std::vector<MPI_Aint> disps;
+    for (const row_block& b : blocks) {
+        if (!b.nrow)
+            continue;
+        MPI_Aint addr;
+        MPI_Get_address(b.data, &addr);
+        lens.push_back(row_count(b.nrow));
+        disps.push_back(addr);
+    }
+
+    MPI_Datatype type;
+    check(MPI_Type_create_hindexed(lens.size(), lens.empty() ? NULL : &lens[0],
+                disps.empty() ? NULL : &disps[0], row_t, &type),
+            "Cannot create thread buffer type");
+    check(MPI_Type_commit(&type), "Cannot commit thread buffer type");
+    return type;
+}
+
+void read_rows(const std::string fn, const size_t ncol,
+        std::vector<row_block> blocks, const read_mode_t mode) {
+    if (mode == read_mode_t::THREAD_READ)
+        throw base::parameter_exception("Threads read their own rows");
+    if (!transport::get()->is_mpi())
+        throw base::parameter_exception("Reading rows through MPI-IO needs"
+                " procs launched with MPI");
+
+    std::sort(blocks.begin(), blocks.end(),
+            [](const row_block& a, const row_block& b) {
+            return a.start_rid < b.start_rid; });
+
+    unsigned long long range[2] = {0, 0}; // first row, nrow
+    if (!blocks.empty())
+        range[0] = blocks[0].start_rid;
+    for (const row_block& b : blocks) {
+        if (b.start_rid != range[0] + range[1])
+            throw base::parameter_exception("Thread rows are not contiguous");
+        range[1] += b.nrow;
+    }
+
+    MPI_Datatype row_t;
+    check(MPI_Type_contiguous(row_count(ncol), MPI_DOUBLE, &row_t),
+            "Cannot create row type");
+    check(MPI_Type_commit(&row_t), "Cannot commit row type");
+    MPI_Datatype mem_t = block_type(blocks, row_t);
+    MPI_Info info = read_hints();
+    const MPI_Offset row_bytes = sizeof(double)*ncol;
+
+    if (mode == read_mode_t::COLLECTIVE_READ) {
+        MPI_File fh;
+        check(MPI_File_open(MPI_COMM_WORLD, const_cast<char*>(fn.c_str()),
+                    MPI_MODE_RDONLY, info, &fh),
+                std::string("Cannot open ") + fn);
+        check(MPI_File_read_at_all(fh, range[0]*row_bytes, MPI_BOTTOM,
+                    range[1] ? 1 : 0, mem_t, MPI_STATUS_IGNORE),
+                "Collective read of rows");
+        check(MPI_File_close(&fh), std::string("Cannot close ") + fn);
+    } else {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm node_comm, reader_comm;
+        check(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                    MPI_INFO_NULL, &node_comm), "Cannot split procs by node");
+        int node_rank, node_size;
+        MPI_Comm_rank(node_comm, &node_rank);
+        MPI_Comm_size(node_comm, &node_size);
+        const bool reader = node_rank == 0;
+
+        std::vector<unsigned long long> ranges(reader ? 2*node_size : 0);
+        check(MPI_Gather(range, 2, MPI_UNSIGNED_LONG_LONG,
+                    reader ? &ranges[0] : NULL, 2, MPI_UNSIGNED_LONG_LONG,
+                    0, node_comm), "Gather of node row ranges");
+        check(MPI_Comm_split(MPI_COMM_WORLD, reader ? 0 : MPI_UNDEFINED,
+                    rank, &reader_comm), "Cannot split node readers");
+
+        std::vector<double> buf;
+        std::vector<int> counts, offsets;
+        if (reader) {
+            // Each member's range lands back to back in buf
+            std::vector<int> lens;
+            std::vector<MPI_Aint> disps;
+            size_t nrow = 0;
+            for (int i = 0; i < node_size; i++) {
+                counts.push_back(row_count(ranges[2*i+1]));
+                offsets.push_back(row_count(nrow));
+                nrow += ranges[2*i+1];
+                if (ranges[2*i+1]) {
+                    lens.push_back(counts.back());
+                    disps.push_back(ranges[2*i]*row_bytes);
+                }
+            }
+            buf.resize(nrow*ncol);
+
+            MPI_Datatype file_t;
+            check(MPI_Type_create_hindexed(lens.size(),
+                        lens.empty() ? NULL : &lens[0],
+                        disps.empty() ? NULL : &disps[0], row_t, &file_t),
+                    "Cannot create node file type");
+            check(MPI_Type_commit(&file_t), "Cannot commit node file type");
+
+            MPI_File fh;
+            check(MPI_File_open(reader_comm, const_cast<char*>(fn.c_str()),
+                        MPI_MODE_RDONLY, info, &fh),
+                    std::string("Cannot open ") + fn);
+            check(MPI_File_set_view(fh, 0, row_t, file_t,
+                        const_cast<char*>("native"), info),
+                    "Cannot set node file view");
+            check(MPI_File_read_all(fh, buf.empty() ? NULL : &buf[0],
+                        row_count(nrow), row_t, MPI_STATUS_IGNORE),
+                    "Collective read of node rows");
+            check(MPI_File_close(&fh), std::string("Cannot close ") + fn);
+            MPI_Type_free(&file_t);
+            MPI_Comm_free(&reader_comm);
+        }
+
+        check(MPI_Scatterv(reader && !buf.empty() ? &buf[0] : NULL,
+                    reader ? &counts[0] : NULL, reader ? &offsets[0] : NULL,
+                    row_t, MPI_BOTTOM, range[1] ? 1 : 0, mem_t, 0, node_comm),
+                "Scatter of node rows");
+        MPI_Comm_free(&node_comm);
+    }
+
+    MPI_Info_free(&info);
+    MPI_Type_free(&mem_t);
+    MPI_Type_free(&row_t);
+}
+} } // End namespace knor::mpi
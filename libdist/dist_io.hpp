@@ -0,0 +1,69 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_DIST_IO_HPP__
+#define __KNOR_DIST_IO_HPP__
+
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace knor { namespace mpi {
+
+enum read_mode_t {
+    THREAD_READ, /*Every thread freads its own rows*/
+    COLLECTIVE_READ, /*One MPI-IO collective read per proc*/
+    NODE_READ /*One MPI-IO reader per node scatters to its node's procs*/
+};
+
+read_mode_t get_read_mode(const std::string mode);
+
+// Rows [start_rid, start_rid + nrow) of the data go to data
+struct row_block {
+    double* data;
+    size_t start_rid;
+    size_t nrow;
+};
+
+/**
+  * Collectively read this proc's rows of the row-major file fn straight
+  *  into its threads' (NUMA-local) buffers. The blocks must cover one
+  *  contiguous range of rows, as the procs' row ranges do.
+  * \param mode COLLECTIVE_READ has every proc issue a single read of its
+  *  range. NODE_READ has one proc per node read for all procs sharing
+  *  the node and scatter the rows over shared memory.
+  */
+void read_rows(const std::string fn, const size_t ncol,
+        std::vector<row_block> blocks, const read_mode_t mode);
+
+/**
+  * Collectively write dirname/cluster_t.yml without gathering the
+  *  assignments. Every proc formats its own contiguous block of rows and
+  *  writes it at its byte offset of the shared file through MPI-IO (pwrite
+  *  for local procs); root only writes the header (counts) and trailer
+  *  (centroids) around them.
+  * \param ret the clustering minus its assignments, the same on all procs.
+  * \param first_row the global id of this proc's first row.
+  */
+void write_cluster_t(const base::cluster_t& ret,
+        const unsigned* local_assignments, const size_t local_nrow,
+        const size_t first_row, const std::string dirname);
+} } // End namespace knor::mpi
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include "dist_partition.hpp"
+#include "transport.hpp"
+#include "exception.hpp"
+#include "util.hpp"
+
+namespace knor { namespace mpi {
+
+// Calibration rows per proc & the least time a calibration may take
+static const size_t CALIB_ROWS = 8192;
+static const double CALIB_SECS = .05;
+
+double calibrate(const std::string fn, const size_t first_row,
+        const size_t nrow, const size_t ncol, const unsigned k,
+        const unsigned nthreads, const base::dist_t dt) {
+    std::vector<double> data(nrow*ncol);
+    FILE* f = fopen(fn.c_str(), "rb");
+    if (!f)
+        throw base::io_exception("Cannot open " + fn);
+    fseek(f, first_row*ncol*sizeof(double), SEEK_SET);
+    size_t nread = fread(&data[0], sizeof(double)*ncol, nrow, f);
+    fclose(f);
+    if (nread != nrow)
+        throw base::io_exception("Calibration read failed on " + fn);
+
+    // Centers spread over the sample stand in for the centroids
+    const unsigned ncent = std::min(static_cast<size_t>(k), nrow);
+    std::vector<double> centers(ncent*ncol);
+    for (unsigned c = 0; c < ncent; c++)
+        std::copy(&data[((c*nrow)/ncent)*ncol],
+                &data[((c*nrow)/ncent + 1)*ncol], &centers[c*ncol]);
+
+    std::vector<unsigned> asgn(nrow);
+    size_t npasses = 0;
+    double secs = 0;
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    do {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads)
+#endif
+        for (size_t row = 0; row < nrow; row++) {
+            double best = std::numeric_limits<double>::max();
+            for (unsigned c = 0; c < ncent; c++) {
+                double dist = base::dist_comp_raw<double>(&data[row*ncol],
+                        &centers[c*ncol], ncol, dt);
+                if (dist < best) {
+                    best = dist;
+                    asgn[row] = c;
+                }
+            }
+        }
+        npasses++;
+        gettimeofday(&end, NULL);
+        secs = base::time_diff(start, end);
+    } while (secs < CALIB_SECS);
+
+    return (npasses*nrow) / std::max(secs, 1e-9);
+}
+
+static std::vector<double> parse_weights(const std::string spec) {
+    std::vector<double> weights;
+    std::stringstream ss(spec);
+    std::string tok;
+    while (std::getline(ss, tok, ',')) {
+        char* end;
+        weights.push_back(strtod(tok.c_str(), &end));
+        if (tok.empty() || *end != '\0')
+            throw base::parameter_exception("partition must be one of:"
+                    " [even | auto | w0,w1,...]. It is '" + spec + "'");
+    }
+    return weights;
+}
+
+base::row_partition::ptr partition_rows(int argc, char* argv[],
+        const std::string spec, const std::string fn, const size_t g_nrow,
+        const size_t ncol, const unsigned k, const unsigned nthreads,
+        const base::dist_t dt) {
+    mpi::transport::init(argc, argv);
+    const int nprocs = mpi::transport::get()->get_nprocs();
+    const int rank = mpi::transport::get()->get_rank();
+
+    if (spec == "even")
+        return base::row_partition::create(g_nrow, nprocs);
+
+    std::vector<double> weights(nprocs);
+    if (spec == "auto") {
+        // Every proc times the same amount of work on its own rows
+        const size_t nrow = std::min(CALIB_ROWS, g_nrow / nprocs);
+        double rate = calibrate(fn, (g_nrow / nprocs) * rank, nrow, ncol, k,
+                nthreads, dt);
+        mpi::transport::get()->allgather(&rate, &weights[0], 1, mpi::DOUBLE);
+    } else {
+        weights = parse_weights(spec);
+        if (weights.size() != static_cast<size_t>(nprocs))
+            throw base::parameter_exception("Need one partition weight per"
+                    " proc, got " + std::to_string(weights.size()) + " for " +
+                    std::to_string(nprocs) + " procs");
+    }
+
+    base::row_partition::ptr part =
+        base::row_partition::create(g_nrow, weights);
+#ifndef BIND
+    if (rank == 0) {
+        printf("Row partition:");
+        for (int proc = 0; proc < nprocs; proc++)
+            printf(" %lu", part->nrow(proc));
+        printf("\n");
+    }
+#endif
+    return part;
+}
+} } // End namespace knor::mpi
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_DIST_PARTITION_HPP__
+#define __KNOR_DIST_PARTITION_HPP__
+
+#include <string>
+
+#include "row_partition.hpp"
+#include "types.hpp"
+
+namespace knor { namespace mpi {
+
+/**
+  * Start MPI (if it isn't already) and decide which rows each proc owns.
+  * \param spec "even" for g_nrow/nprocs rows each, "auto" to weight procs by
+  *  their throughput on a calibration pass over their own rows, or comma
+  *  separated per-proc weights, e.g. relative node speeds "1,1,2.5".
+  */
+base::row_partition::ptr partition_rows(int argc, char* argv[],
+        const std::string spec, const std::string fn, const size_t g_nrow,
+        const size_t ncol, const unsigned k, const unsigned nthreads,
+        const base::dist_t dt);
+
+/**
+  * Rows per second this proc assigns to k centers with nthreads, timed on
+  *  nrow rows of fn starting at first_row. Every proc should be given the
+  *  same nrow & k so the rates are comparable.
+  */
+double calibrate(const std::string fn, const size_t first_row,
+        const size_t nrow, const size_t ncol, const unsigned k,
+        const unsigned nthreads, const base::dist_t dt);
+} } // End namespace knor::mpi
+#endif
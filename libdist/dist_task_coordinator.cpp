@@ -22,54 +22,55 @@
 #include "clusters.hpp"
 #include "io.hpp"
 #include "mpi.hpp"
+#include "cluster_allreduce.hpp"
+#include "dist_io.hpp"
 #include "util.hpp"
 #include "types.hpp"
 #include "dist_matrix.hpp"
+#include "linalg.hpp"
 
 namespace kmpi = knor::mpi;
 
+// Fraction of changed assignments under which -F goes back to double
+#define FLOAT_REDUCE_STOP 0.001
+
 namespace knor { namespace prune {
 
 dist_task_coordinator::dist_task_coordinator(
-        int argc, char* argv[],
-        const std::string fn, const size_t nrow,
+        kbase::row_partition::ptr part,
+        const std::string fn,
         const size_t ncol, const unsigned k, const unsigned max_iters,
         const unsigned nnodes, const unsigned nthreads,
         const double* centers, const kbase::init_t it,
         const double tolerance, const kbase::dist_t dt) :
-    kmeans_task_coordinator(fn, this->init(argc, argv, nrow),
+    kmeans_task_coordinator(fn, this->init(part),
             ncol, k, max_iters, nnodes, nthreads, centers, it, tolerance, dt) {
 
-        this->g_nrow = nrow;
+        this->part = part;
+        this->g_nrow = part->get_g_nrow();
+        this->overlap_chunks = 0;
+        this->read_mode = kmpi::read_mode_t::THREAD_READ;
+        this->float_reduce = false;
 
         for (thread_iter it = threads.begin(); it < threads.end(); ++it)
             (*it)->set_start_rid((*it)->get_start_rid()
-                    + (nrow / nprocs) * mpi_rank);
+                    + part->first(mpi_rank));
 
         prev_num_members.resize(k);
 }
 
 /**
-  * This takes the global number of samples in the *entire* dataset, `g_nrow'
+  * This takes the partition of the *entire* dataset's rows across procs
   *     and gives the coordinator it's partion.
   */
-const size_t dist_task_coordinator::init(int argc, char* argv[],
-        const size_t g_nrow) {
-    if (MPI_Init(&argc, &argv) != MPI_SUCCESS)
-        throw std::runtime_error("MPI_Init error\n");
-
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs); // Set the num_procs
-    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-
-    if (mpi_rank == (nprocs - 1)) // The last proc always has more
-        return (g_nrow / nprocs) + (g_nrow % nprocs);
-    else
-        return (g_nrow / nprocs);
+const size_t dist_task_coordinator::init(kbase::row_partition::ptr part) {
+    nprocs = mpi::transport::get()->get_nprocs(); // Set the num_procs
+    mpi_rank = mpi::transport::get()->get_rank();
+    return part->nrow(mpi_rank);
 }
 
 void dist_task_coordinator::random_partition_init() {
-    kbase::rand123emulator<unsigned> gen(0, k-1,
-            ((g_nrow / nprocs) * mpi_rank));
+    kbase::rand123emulator<unsigned> gen(0, k-1, part->first(mpi_rank));
     for (size_t row = 0; row < nrow; row++) {
         unsigned asgnd_clust = gen.next();
         const double* dp = this->get_thd_data(row);
@@ -86,20 +87,43 @@ void dist_task_coordinator::random_partition_init() {
 #endif
 }
 
+void dist_task_coordinator::load_data() {
+    for (thread_iter it = threads.begin(); it < threads.end(); ++it)
+        (*it)->set_defer_read(read_mode != kmpi::read_mode_t::THREAD_READ);
+    wake4run(knor::thread_state_t::ALLOC_DATA);
+    wait4complete();
+
+    if (read_mode == kmpi::read_mode_t::THREAD_READ)
+        return;
+
+    // Thread start_rids are still global here
+    std::vector<kmpi::row_block> blocks;
+    for (thread_iter it = threads.begin(); it < threads.end(); ++it) {
+        kmpi::row_block b = { (*it)->get_local_data(), (*it)->get_start_rid(),
+            (*it)->get_data_size() / (sizeof(double)*ncol) };
+        blocks.push_back(b);
+    }
+    kmpi::read_rows(fn, ncol, blocks, read_mode);
+}
+
 const size_t dist_task_coordinator::global_rid(const size_t local_rid) const {
-    return ((g_nrow / nprocs)*mpi_rank) + local_rid;
+    return part->first(mpi_rank) + local_rid;
 }
 
 const size_t dist_task_coordinator::local_rid(const size_t global_rid) const {
-    size_t rid = global_rid - (mpi_rank * (g_nrow / nprocs));
+    size_t rid = global_rid - part->first(mpi_rank);
     if (rid > this->nrow)
         throw kbase::thread_exception("Row: " + std::to_string(rid) +
                 " out of bounds for Proc: " + std::to_string( mpi_rank));
     return rid;
 }
 
+const int dist_task_coordinator::owner(const size_t global_rid) const {
+    return part->owner(global_rid);
+}
+
 const bool dist_task_coordinator::is_local(const size_t global_rid) const {
-    size_t rid = global_rid - (mpi_rank * (g_nrow / nprocs));
+    size_t rid = global_rid - part->first(mpi_rank);
     if (rid >= this->nrow)
         return false;
     return true;
@@ -116,8 +140,8 @@ void const dist_task_coordinator::print_thread_data() {
 void dist_task_coordinator::kmeanspp_init() {
     struct timeval start, end;
 
-    std::vector<double> buff(k*ncol);
-    std::vector<double> g_dist_v(g_nrow); // Global to all processes
+    std::vector<double> center(ncol);
+    std::vector<double> rank_sums(nprocs);
     set_thd_dist_v_ptr(&dist_v[0]);
 
     std::default_random_engine generator;
@@ -128,14 +152,14 @@ void dist_task_coordinator::kmeanspp_init() {
 
     // If proc owns the row -- get it ...
     if (is_local(selected_idx)) {
-        cltrs->set_mean(get_thd_data(local_rid(selected_idx)), 0);
-        dist_v[local_rid(selected_idx)] = 0;
-        cluster_assignments[local_rid(selected_idx)] = 0;
+        const size_t lrid = local_rid(selected_idx);
+        std::copy(get_thd_data(lrid), get_thd_data(lrid) + ncol, &center[0]);
+        dist_v[lrid] = 0;
+        cluster_assignments[lrid] = 0;
     }
 
-    kmpi::mpi::reduce_double(&(cltrs->get_means()[0]),
-            &buff[0], cltrs->size());
-    cltrs->set_mean(&buff[0]);
+    kmpi::mpi::bcast_double(&center[0], owner(selected_idx), ncol);
+    cltrs->set_mean(&center[0], 0);
 
 #if VERBOSE
     if (mpi_rank == 0)
@@ -147,64 +171,46 @@ void dist_task_coordinator::kmeanspp_init() {
 
     std::uniform_real_distribution<double> ur_distribution(0.0, 1.0);
 
-    // Choose next center c_i with weighted prob
+    // Choose next center c_i with weighted prob. Only the per proc sums of
+    //  dist_v are exchanged: every proc walks them with the same draw to the
+    //  owning proc, which walks its own dist_v and broadcasts the row.
     while (true) {
         set_thread_clust_idx(clust_idx); // Set the current cluster index
         wake4run(KMSPP_INIT); // Run || distance comp to clust_idx
         wait4complete();
         double local_cuml_dist = reduction_on_cuml_sum(); // Per proc cuml dists
 
-        double cuml_dist; // Recepticle
-        kmpi::mpi::reduce_double(&local_cuml_dist, &cuml_dist);
+        kmpi::mpi::allgather_double(&local_cuml_dist, &rank_sums[0], 1);
+        double cuml_dist = 0;
+        for (int proc = 0; proc < nprocs; proc++)
+            cuml_dist += rank_sums[proc];
 
         // All procs do this ...
-        cuml_dist = (cuml_dist * ur_distribution(generator)) / (RAND_MAX - 1.0);
+        cuml_dist *= ur_distribution(generator);
         if (++clust_idx >= k)  // No more centers needed
             break;
 
-        // Gather the g_dist_v
-        kmpi::mpi::allgather_double(&dist_v[0],
-                &g_dist_v[0], g_nrow/nprocs);
-
-        // Gather the remaining entries from the last proc which *may* have more
-        if (g_nrow % nprocs) {
-            const size_t tail_idx = (g_nrow/nprocs);
-            const size_t numel = (g_nrow % nprocs);
-
-            if (mpi_rank == nprocs - 1)
-                std::copy(&dist_v[tail_idx], &dist_v[tail_idx+numel],
-                        &g_dist_v[g_nrow-numel]);
-
-            kmpi::mpi::bcast_double(&g_dist_v[g_nrow-numel], nprocs-1, numel);
+        const int owner_proc = static_cast<int>(
+                kbase::weighted_select(&rank_sums[0], nprocs, cuml_dist));
+        if (owner_proc == mpi_rank) {
+            const size_t lrid = kbase::weighted_select(&dist_v[0],
+                    get_nrow(), cuml_dist);
+            std::copy(get_thd_data(lrid), get_thd_data(lrid) + ncol,
+                    &center[0]);
+            cluster_assignments[lrid] = clust_idx;
+            dist_v[lrid] = 0;
+            selected_idx = global_rid(lrid);
         }
 
-        for (size_t row = 0; row < g_nrow; row++) {
-            cuml_dist -= g_dist_v[row];
-            if (cuml_dist <= 0) {
+        kmpi::mpi::bcast_double(&center[0], owner_proc, ncol);
+        cltrs->set_mean(&center[0], clust_idx);
 #if VERBOSE
-                if (mpi_rank == 0)
+        if (owner_proc == mpi_rank)
 #ifndef BIND
-                    printf("Choosing r: %lu  as center k = %u\n",
-                            row, clust_idx);
+            printf("Choosing r: %u  as center k = %u\n",
+                    selected_idx, clust_idx);
 #endif
 #endif
-
-                if (is_local(row)) {
-                    cltrs->set_mean(get_thd_data(local_rid(row)), clust_idx);
-                    cluster_assignments[local_rid(row)] = clust_idx;
-                    dist_v[local_rid(row)] = 0;
-                } else {
-                    cltrs->clear();
-                }
-
-                break;
-            }
-        }
-
-        kmpi::mpi::reduce_double(&(cltrs->get_means()[0]),
-                &buff[0], cltrs->size());
-        cltrs->set_mean(&buff[0]);
-        assert(cuml_dist <= 0);
     }
 
 #if VERBOSE
@@ -249,8 +255,7 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
 
     // The business
     set_global_ptrs();
-    wake4run(knor::thread_state_t::ALLOC_DATA);
-    wait4complete();
+    load_data();
 
     struct timeval start, end;
     gettimeofday(&start , NULL);
@@ -260,12 +265,19 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
     bool converged = false;
     size_t iters = 0;
     size_t nchanged = 0;
+    bool reduce_float = float_reduce; // Until the resync below
 
     // Init
     run_init();
 
     double* clstr_buff = new double[k*ncol];
     size_t* nmemb_buff = new size_t[k];
+    kmpi::cluster_allreduce::ptr reducer = overlap_chunks ?
+        kmpi::cluster_allreduce::create(k, ncol, overlap_chunks) : nullptr;
+    std::vector<double> center; // Float reductions are offsets from it
+    std::vector<kbase::clusters::ptr> parts;
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        parts.push_back((*it)->get_local_clusters());
 
     // TODO: Check cost of all the shared_ptr passing
     kbase::prune_clusters::ptr cltrs_ptr = get_gcltrs();
@@ -308,7 +320,10 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
             printf("Running iteration %lu ...\n", iters);
 #endif
 
-        get_dm()->compute_dist(cltrs_ptr, ncol);
+        // With overlap the distances were computed as the previous
+        //  iteration's means arrived
+        if (!reducer || iters == 0)
+            get_dm()->compute_dist(cltrs_ptr, ncol);
 #if VERBOSE
         if (mpi_rank == 0) {
 #ifndef BIND
@@ -320,40 +335,89 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
         wake4run(knor::thread_state_t::EM);
         wait4complete();
         // NOTE: Unfinalized diffs on this proc in cltrs.means
-        pp_aggregate();
-
-        // NOTE: cltrs_ptr has this procs diff (agg of threads from this proc)
-        // NOTE: clstr_buff has agg of all procs diff
-        kmpi::mpi::reduce_double(&(cltrs_ptr->get_means()[0]),
-                clstr_buff, cltrs_ptr->size());
+        if (reducer) {
+            pp_aggregate(false);
+            reducer->post(parts, num_changed);
+
+            // Each chunk is finalized and its centroid distances for the
+            //  next iteration computed while later chunks are in flight
+            std::vector<double> mean(ncol);
+            for (unsigned chunk = 0; chunk < reducer->get_nchunks(); chunk++) {
+                reducer->wait(chunk);
+                const unsigned begin = reducer->chunk_begin(chunk);
+                const unsigned end = reducer->chunk_end(chunk);
+
+                for (unsigned c = begin; c < end; c++) {
+                    if (iters == 0) {
+                        cltrs_ptr->set_mean(reducer->get_mean(c), c);
+                        cltrs_ptr->get_num_members_v()[c] =
+                            reducer->get_count(c);
+                    } else {
+                        // The prev univ cluster plus every proc's diff
+                        cltrs_ptr->set_mean(
+                                &(cltrs_ptr->get_prev_means()[c*ncol]), c);
+                        cltrs_ptr->get_num_members_v()[c] =
+                            prev_num_members[c];
+                        cltrs_ptr->set_complete(c);
+                        cltrs_ptr->unfinalize(c);
+
+                        const double* diff = reducer->get_mean(c);
+                        for (size_t col = 0; col < ncol; col++)
+                            mean[col] = cltrs_ptr->get_means()[c*ncol+col] +
+                                diff[col];
+                        cltrs_ptr->set_mean(&mean[0], c);
+                        cltrs_ptr->num_members_peq(reducer->get_count(c), c);
+                    }
+                    cltrs_ptr->finalize(c);
+                }
+                get_dm()->compute_dist(cltrs_ptr, ncol, begin, end);
+            }
+            nchanged = reducer->wait_nchanged();
+        } else {
+            if (reduce_float) // The means of this E-step
+                center.assign(cltrs_ptr->get_means().begin(),
+                        cltrs_ptr->get_means().end());
+            pp_aggregate();
 
-        // nmemb_buff has agg of all procs diff on membership count
-        kmpi::mpi::reduce_llong_t(&(cltrs_ptr->get_num_members_v()[0]),
-                nmemb_buff, cltrs_ptr->get_num_members_v().size());
+            // nmemb_buff has agg of all procs diff on membership count
+            kmpi::mpi::reduce_llong_t(&(cltrs_ptr->get_num_members_v()[0]),
+                    nmemb_buff, cltrs_ptr->get_num_members_v().size());
 
-        if (iters == 0) {
-            cltrs_ptr->set_mean(clstr_buff);
-            cltrs_ptr->set_num_members_v(nmemb_buff);
-        } else {
-            // Get the prev univ clusters
-            cltrs_ptr->set_mean(cltrs_ptr->get_prev_means());
-            cltrs_ptr->set_num_members_v(&(get_prev_num_members())[0]);
+            // NOTE: cltrs_ptr has this procs diff (agg of threads from this proc)
+            // NOTE: clstr_buff has agg of all procs diff
+            if (reduce_float)
+                kmpi::mpi::reduce_delta_float(&(cltrs_ptr->get_means()[0]),
+                        clstr_buff, &center[0],
+                        &(cltrs_ptr->get_num_members_v()[0]), nmemb_buff,
+                        k, ncol);
+            else
+                kmpi::mpi::reduce_double(&(cltrs_ptr->get_means()[0]),
+                        clstr_buff, cltrs_ptr->size());
+
+            if (iters == 0) {
+                cltrs_ptr->set_mean(clstr_buff);
+                cltrs_ptr->set_num_members_v(nmemb_buff);
+            } else {
+                // Get the prev univ clusters
+                cltrs_ptr->set_mean(cltrs_ptr->get_prev_means());
+                cltrs_ptr->set_num_members_v(&(get_prev_num_members())[0]);
 #if VERBOSE
 #ifndef BIND
-            printf("Prev universal clusters for Proc: %d ==> \n", mpi_rank);
+                printf("Prev universal clusters for Proc: %d ==> \n", mpi_rank);
 #endif
-            cltrs_ptr->print_means();
+                cltrs_ptr->print_means();
 #endif
-            cltrs_ptr->set_complete_all(); // Must set this
-            cltrs_ptr->unfinalize_all();
+                cltrs_ptr->set_complete_all(); // Must set this
+                cltrs_ptr->unfinalize_all();
 
-            cltrs_ptr->means_peq(clstr_buff);
-            cltrs_ptr->num_members_v_peq(nmemb_buff);
-        }
+                cltrs_ptr->means_peq(clstr_buff);
+                cltrs_ptr->num_members_v_peq(nmemb_buff);
+            }
 
-        // NOTE: Now finalized
-        size_t pp_num_changed = get_num_changed();
-        kmpi::mpi::reduce_size_t(&pp_num_changed, &nchanged);
+            // NOTE: Now finalized
+            size_t pp_num_changed = get_num_changed();
+            kmpi::mpi::reduce_size_t(&pp_num_changed, &nchanged);
+        }
 
         if (mpi_rank == root) {
 #ifndef BIND
@@ -367,6 +431,19 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
                     cltrs_ptr->get_num_members_v().end(), 0) == g_nrow);
 
         perc_changed = (double)nchanged/g_nrow; // Global perc change
+
+        // Near convergence float drift in the means could decide the last
+        //  assignments. Recompute the means in double and reduce in double
+        //  from here on, so convergence is judged by an exact E-step.
+        bool resynced = false;
+        if (reduce_float &&
+                perc_changed <= std::max(tolerance, FLOAT_REDUCE_STOP)) {
+            kmpi::mpi::exact_means(get_gcltrs(), nrow,
+                    &cluster_assignments[0],
+                    [this](const size_t row) { return get_thd_data(row); });
+            reduce_float = false;
+            resynced = true;
+        }
         for (unsigned c = 0; c < k; c++) {
             cltrs_ptr->finalize(c);
             cltrs_ptr->set_prev_dist(
@@ -380,7 +457,7 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
 #endif
         }
 
-        if (nchanged == 0 || perc_changed <= tolerance) {
+        if (!resynced && (nchanged == 0 || perc_changed <= tolerance)) {
             converged = true;
             if (mpi_rank == root)
 #ifndef BIND
@@ -388,7 +465,9 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
 #endif
             break;
         }
-        iters++;
+        // Re-running an E-step that changed nothing isn't a new iteration
+        if (!resynced || nchanged)
+            iters++;
     }
 
     if (!converged && mpi_rank == root)
@@ -396,6 +475,10 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
         printf("Algorithm failed to converge in %lu iterations\n", iters);
 #endif
 
+    if (reduce_float) // Stopped at max_iters before the resync
+        kmpi::mpi::exact_means(get_gcltrs(), nrow, &cluster_assignments[0],
+                [this](const size_t row) { return get_thd_data(row); });
+
     gettimeofday(&end, NULL);
     if (mpi_rank == root)
 #ifndef BIND
@@ -404,58 +487,184 @@ void dist_task_coordinator::run(kbase::cluster_t& ret,
 #endif
 
     if (!outdir.empty()) {
-        // Collect cluster assignments
-        const unsigned* local_assignments = get_cluster_assignments();
+        // Root keeps only the centroids and counts. Every proc writes its
+        //  own cluster assignments straight to the output file.
+        ret = kbase::cluster_t(g_nrow, ncol, iters, k, NULL,
+                &(cltrs_ptr->get_num_members_v()[0]),
+                cltrs_ptr->get_means());
 
-        if (mpi_rank != root) {
-            int rc = MPI_Ssend(local_assignments, get_nrow(),
-                    MPI::UNSIGNED, root, 0, MPI_COMM_WORLD);
-            kbase::assert_msg(!rc, "Failure to send local assignments to root");
-        } else {
-            std::vector<unsigned> assignments(g_nrow);
-            std::copy(local_assignments, local_assignments+get_nrow(),
-                    assignments.begin());
-
-            for (int pid = 1; pid < int(nprocs); pid++) {
-                // Account for an uneven # of rows per process
-                unsigned count;
-                if (pid == (nprocs - 1))
-                    count = get_nrow() + (g_nrow % nprocs);
-                else
-                    count = get_nrow();
-
-                int rc = MPI_Recv(&assignments[pid*(g_nrow/nprocs)],
-                        count, MPI::UNSIGNED, pid,
-                        0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                kbase::assert_msg(!rc, "Root Failure receive local assignments");
-            }
+#ifndef BIND
+        if (mpi_rank == root)
+            printf("\nWriting output to '%s'\n", outdir.c_str());
+#endif
+        kmpi::write_cluster_t(ret, get_cluster_assignments(), get_nrow(),
+                global_rid(0), outdir);
+    }
 
-            ret = kbase::cluster_t(g_nrow, ncol, iters, k, &assignments[0],
-                    &(cltrs_ptr->get_num_members_v()[0]),
-                    cltrs_ptr->get_means());
+    // MPI cleanup and graceful exit
+    delete [] clstr_buff;
+    delete [] nmemb_buff;
+}
 
-            if (!outdir.empty()) {
+/**
+  * Each proc samples rows at the same rate, so a batch holds ~mb_size rows
+  *  drawn over all procs. Only the per-cluster sums of (row - mean) & counts
+  *  of the batch plus the counts of all rows sampled so far are reduced.
+  *  Like mb_finalize_centroids every sampled row pulls its mean toward it
+  *  at rate eta = 1/(rows sampled so far in the cluster). For a cluster
+  *  with b batch rows averaging x that is m' = (1-eta)^b m + (1-(1-eta)^b) x
+  *  which doesn't depend on the order the rows are applied in.
+  */
+void dist_task_coordinator::mb_run(kbase::cluster_t& ret,
+        const std::string outdir) {
+    if (mpi_rank == root) {
+        if (outdir.empty())
+            fprintf(stderr, "\n**[WARNING]**: No output dir specified with "
+                    "'-o' flag means no output will be saved!\n");
 #ifndef BIND
-                printf("\nWriting output to '%s'\n", outdir.c_str());
+        printf("Running mini-batch kmeans\n");
 #endif
-                ret.write(outdir);
-            }
+    }
+
+    const double mb_perctg = std::min(1.0, (double)mb_size / g_nrow);
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        std::static_pointer_cast<kmeans_task_thread>(*it)->
+            set_mb_perctg(mb_perctg);
+
+    set_global_ptrs();
+    load_data();
+    // Sampled rows are indexed from this proc's first row
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        (*it)->set_start_rid((*it)->get_start_rid() - part->first(mpi_rank));
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+    run_init();
+
+    kbase::prune_clusters::ptr cltrs_ptr = get_gcltrs();
+    if (_init_t == kbase::init_t::RANDOM || _init_t == kbase::init_t::FORGY) {
+        std::vector<double> means(k*ncol);
+        kmpi::mpi::reduce_double(&(cltrs_ptr->get_means()[0]), &means[0],
+                means.size());
+        cltrs_ptr->set_mean(&means[0]);
+        if (_init_t == kbase::init_t::RANDOM) {
+            std::vector<size_t> nmemb(k);
+            kmpi::mpi::reduce_llong_t(&(cltrs_ptr->get_num_members_v()[0]),
+                    &nmemb[0], k);
+            cltrs_ptr->set_num_members_v(&nmemb[0]);
+            cltrs_ptr->finalize_all();
         }
     }
 
+    // Only sampled rows count toward the learning rates
+    clear_cluster_assignments();
+    std::fill(dist_v.begin(), dist_v.end(),
+            std::numeric_limits<double>::max());
 
-    // MPI cleanup and graceful exit
-    delete [] clstr_buff;
-    delete [] nmemb_buff;
+    // [deltas (k x ncol) | batch counts (k) | sampled counts (k)]
+    std::vector<double> buff(k*(ncol+2)), sums(k*(ncol+2));
+    bool converged = false;
+    size_t iters = 0;
+
+    for (; iters < max_iters; iters++) {
+        if (mpi_rank == root)
+#ifndef BIND
+            printf("Running mini-batch iteration %lu ...\n", iters);
+#endif
+        cltrs_ptr->set_prev_means();
+
+        wake4run(knor::thread_state_t::MB_EM);
+        wait4complete();
+
+        std::fill(buff.begin(), buff.end(), 0);
+        double* nsampled = &buff[k*(ncol+1)];
+        for (size_t rid = 0; rid < nrow; rid++)
+            if (cluster_assignments[rid] != kbase::INVALID_CLUSTER_ID)
+                nsampled[cluster_assignments[rid]]++;
+        for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+            std::static_pointer_cast<kmeans_task_thread>(*it)->
+                mb_batch_deltas(&buff[0], &buff[k*ncol]);
+
+        kmpi::mpi::reduce_double(&buff[0], &sums[0], sums.size());
+
+        std::vector<double> mean(ncol);
+        for (unsigned c = 0; c < k; c++) {
+            const double nbatch = sums[k*ncol + c];
+            if (nbatch == 0)
+                continue;
+
+            const double eta = 1 / sums[k*(ncol+1) + c];
+            const double step = 1 - std::pow(1 - eta, nbatch);
+            for (size_t col = 0; col < ncol; col++)
+                mean[col] = cltrs_ptr->get_means()[c*ncol+col] +
+                    step * sums[c*ncol+col] / nbatch;
+            cltrs_ptr->set_mean(&mean[0], c);
+        }
+        std::fill(dist_v.begin(), dist_v.end(),
+                std::numeric_limits<double>::max());
+
+        std::vector<double> diff;
+        kbase::linalg::vdiff(&cltrs_ptr->get_means()[0],
+                &cltrs_ptr->get_prev_means()[0], cltrs_ptr->get_means().size(),
+                diff);
+        if (kbase::linalg::frobenius_norm<double>(&diff[0], diff.size()) <
+                tolerance) {
+            converged = true;
+            break;
+        }
+    }
+
+    if (mpi_rank == root) {
+#ifndef BIND
+        if (converged)
+            printf("Mini-batch converged in %lu iterations\n", iters);
+        else
+            printf("Mini-batch failed to converge in %lu iterations\n",
+                    iters);
+#endif
+    }
+
+    // A full E-step assigns every row to the final means
+    set_prune_init(true);
+    wake4run(knor::thread_state_t::EM);
+    wait4complete();
+
+    std::vector<llong_t> counts(k, 0);
+    for (size_t rid = 0; rid < nrow; rid++)
+        counts[cluster_assignments[rid]]++;
+    std::vector<size_t> g_counts(k);
+    kmpi::mpi::reduce_llong_t(&counts[0], &g_counts[0], k);
+    cltrs_ptr->set_num_members_v(&g_counts[0]);
+
+    gettimeofday(&end, NULL);
+    if (mpi_rank == root) {
+#ifndef BIND
+        printf("\nAlgorithmic time taken = %.6f sec\n",
+                kbase::time_diff(start, end));
+#endif
+        cltrs_ptr->print_membership_count();
+    }
+
+    if (!outdir.empty()) {
+        ret = kbase::cluster_t(g_nrow, ncol, iters, k, NULL,
+                &(cltrs_ptr->get_num_members_v()[0]),
+                cltrs_ptr->get_means());
+#ifndef BIND
+        if (mpi_rank == root)
+            printf("\nWriting output to '%s'\n", outdir.c_str());
+#endif
+        kmpi::write_cluster_t(ret, get_cluster_assignments(), get_nrow(),
+                global_rid(0), outdir);
+    }
 }
 
 dist_task_coordinator::~dist_task_coordinator() {
-    MPI_Finalize();
+    mpi::mpi::finalize();
 }
 
 // Aggregate per process from threads &
 //      save to `cltrs' as the delta for 1 EM-step
-void dist_task_coordinator::pp_aggregate() {
+void dist_task_coordinator::pp_aggregate(const bool merge_threads) {
     num_changed = 0; // Reset every iteration
     cltrs->set_prev_means();
     std::copy(cltrs->get_num_members_v().begin(),
@@ -466,7 +675,8 @@ void dist_task_coordinator::pp_aggregate() {
     for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
         // Updated the changed cluster count
         num_changed += (*it)->get_num_changed();
-        cltrs->peq((*it)->get_local_clusters());
+        if (merge_threads)
+            cltrs->peq((*it)->get_local_clusters());
     }
 }
 
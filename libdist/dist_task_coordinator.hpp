@@ -21,8 +21,11 @@
 
 #include "kmeans_task_coordinator.hpp"
 #include "exception.hpp"
+#include "dist_io.hpp"
+#include "dist_partition.hpp"
 
 namespace kbase = knor::base;
+namespace kmpi = knor::mpi;
 
 namespace knor { namespace prune {
 
@@ -30,8 +33,8 @@ constexpr unsigned root = 0;
 
 class dist_task_coordinator : public kmeans_task_coordinator {
 private:
-    dist_task_coordinator(int argc, char* argv[],
-            const std::string fn, const size_t nrow,
+    dist_task_coordinator(kbase::row_partition::ptr part,
+            const std::string fn,
             const size_t ncol, const unsigned k, const unsigned max_iters,
             const unsigned nnodes, const unsigned nthreads,
             const double* centers, const kbase::init_t it,
@@ -40,7 +43,14 @@ private:
     int mpi_rank;
     int nprocs;
     size_t g_nrow;
+    kbase::row_partition::ptr part; // The rows every proc owns
     std::vector<size_t> prev_num_members;
+    unsigned overlap_chunks; // 0 for blocking reductions
+    kmpi::read_mode_t read_mode;
+    bool float_reduce; // Reduce centroid sums as float deltas
+
+    // Allocate thread memory and fill it from `fn' per the read_mode
+    void load_data();
 
 public:
     static coordinator::ptr create(int argc, char* argv[],
@@ -48,10 +58,13 @@ public:
             const size_t ncol, const unsigned k, const unsigned max_iters,
             const unsigned nnodes, const unsigned nthreads,
             const double* centers=NULL, const std::string init="kmeanspp",
-            const double tolerance=-1, const std::string dist_type="eucl") {
+            const double tolerance=-1, const std::string dist_type="eucl",
+            const std::string partition="even") {
 
         kbase::init_t _init_t = kbase::get_init_type(init);
         kbase::dist_t _dist_t = kbase::get_dist_type(dist_type);
+        kbase::row_partition::ptr part = kmpi::partition_rows(argc, argv,
+                partition, fn, nrow, ncol, k, nthreads, _dist_t);
 
 #if KM_TEST
         printf("kmeans task coordinator => NUMA nodes: %u, nthreads: %u, "
@@ -60,7 +73,7 @@ public:
                 dist_type.c_str(), fn.c_str());
 #endif
         return coordinator::ptr(
-                new dist_task_coordinator(argc, argv, fn, nrow, ncol, k,
+                new dist_task_coordinator(part, fn, ncol, k,
                     max_iters, nnodes, nthreads, centers,
                     _init_t, tolerance, _dist_t));
     }
@@ -72,16 +85,34 @@ public:
     void random_partition_init() override;
     void forgy_init() override;
     void run(kbase::cluster_t& ret, const std::string outdir="");
+    // Mini-batch k-means, batches of mb_size rows drawn across all procs
+    void mb_run(kbase::cluster_t& ret, const std::string outdir="");
 
     const bool is_local(const size_t global_rid) const;
     const size_t global_rid(const size_t local_rid) const;
     const size_t local_rid(const size_t global_rid) const;
-    void pp_aggregate();
+    // The rank that owns a global row
+    const int owner(const size_t global_rid) const;
+    // merge_threads=false leaves the threads' sums for a cluster_allreduce
+    void pp_aggregate(const bool merge_threads=true);
+    // Reduce centroids in nchunks non-blocking chunks overlapped with
+    //  finalizing them and the next iteration's centroid distances. 0
+    //  restores blocking reductions.
+    void set_overlap(const unsigned nchunks) { overlap_chunks = nchunks; }
+    // Send blocking centroid reductions as float offsets from the last
+    //  means, then recompute the final means in double
+    void set_float_reduce(const bool float_reduce) {
+        this->float_reduce = float_reduce;
+    }
+    // How ranks read their rows: "thread", "mpiio" or "node"
+    void set_read_mode(const std::string mode) {
+        read_mode = kmpi::get_read_mode(mode);
+    }
     std::vector<size_t>& get_prev_num_members() {
         return prev_num_members;
     }
     const int get_nprocs() const { return nprocs; }
-    const size_t init(int argc, char* argv[], const size_t g_nrow);
+    const size_t init(kbase::row_partition::ptr part);
     ~dist_task_coordinator();
 };
 } } // End namespace knor, prune
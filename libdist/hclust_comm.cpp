@@ -0,0 +1,207 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "hclust_comm.hpp"
+#include "mpi.hpp"
+#include "dist_io.hpp"
+#include "coordinator.hpp"
+#include "hclust.hpp"
+#include "clusters.hpp"
+#include "member_index.hpp"
+
+namespace knor { namespace dist {
+
+hclust_comm::hclust_comm(base::row_partition::ptr part) : row_comm(part) {
+}
+
+void hclust_comm::reduce(const std::vector<std::shared_ptr<thread> >& threads,
+        base::hcluster_arena::ptr hcltrs, base::vmap<unsigned>& nchanged) {
+    const size_t nslots = hcltrs->nslots();
+    const size_t nsums = nslots*2*hcltrs->get_ncol();
+
+    // One reduction for the sums, counts and number changed. Counts are
+    //  exact as doubles up to 2^53.
+    base::h_accumulator acc;
+    acc.reset(nslots, hcltrs->get_ncol());
+    std::vector<double> send(nsums + 3*nslots, 0);
+    for (auto const& thd : threads) {
+        const base::h_accumulator& tacc =
+            std::static_pointer_cast<hclust>(thd)->get_local_hcltrs();
+        for (size_t i = 0; i < nsums; i++)
+            send[i] += tacc.sums[i];
+        for (size_t i = 0; i < nslots*2; i++)
+            send[nsums + i] += tacc.nmembers[i];
+        for (size_t slot = 0; slot < nslots; slot++)
+            send[nsums + 2*nslots + slot] += tacc.nchanged[slot];
+    }
+
+    reduce_buff.resize(send.size());
+    mpi::mpi::reduce_double(&send[0], &reduce_buff[0], send.size());
+
+    std::copy(reduce_buff.begin(), reduce_buff.begin() + nsums,
+            acc.sums.begin());
+    for (size_t i = 0; i < nslots*2; i++)
+        acc.nmembers[i] = static_cast<llong_t>(reduce_buff[nsums + i]);
+    hcltrs->reduce(std::vector<const base::h_accumulator*>(1, &acc));
+
+    nchanged.clear();
+    for (size_t slot = 0; slot < nslots; slot++)
+        nchanged[hcltrs->get_slot_id(slot)] +=
+            static_cast<unsigned>(reduce_buff[nsums + 2*nslots + slot]);
+}
+
+void hclust_comm::reduce_partitions(
+        const std::vector<std::shared_ptr<thread> >& threads,
+        base::clusters::ptr cltrs) {
+    const size_t ncol = cltrs->get_ncol();
+
+    // Thread clusters grow with the ids they see, so agree on a size first
+    unsigned long long nclust = cltrs->get_nclust();
+    for (auto const& thd : threads)
+        nclust = std::max<unsigned long long>(nclust,
+                thd->get_local_clusters()->get_nclust());
+    mpi::transport::get()->allreduce(&nclust, &nclust, 1, mpi::ULLONG,
+            mpi::MAX);
+
+    std::vector<double> sums(nclust*ncol, 0), g_sums(nclust*ncol);
+    std::vector<llong_t> counts(nclust, 0);
+    std::vector<size_t> g_counts(nclust);
+    for (auto const& thd : threads) {
+        base::clusters::ptr lc = thd->get_local_clusters();
+        for (size_t i = 0; i < lc->size(); i++)
+            sums[i] += lc->get(i);
+        for (size_t c = 0; c < lc->get_nclust(); c++)
+            counts[c] += lc->get_num_members(c);
+    }
+    mpi::mpi::reduce_double(&sums[0], &g_sums[0], sums.size());
+    mpi::mpi::reduce_llong_t(&counts[0], &g_counts[0], nclust);
+
+    base::clusters::ptr g_cltrs =
+        base::clusters::create(nclust, ncol, &g_sums[0]);
+    g_cltrs->set_num_members_v(&g_counts[0]);
+    cltrs->peq(g_cltrs);
+}
+
+void hclust_comm::gather_seeds(coordinator& coord,
+        base::hcluster_arena::ptr hcltrs,
+        std::shared_ptr<base::member_index> memb_index) {
+    constexpr unsigned none = std::numeric_limits<unsigned>::max();
+    const size_t ncol = coord.get_ncol();
+
+    std::vector<size_t> ids;
+    hcltrs->get_keys(ids);
+    std::vector<unsigned> cids;
+    for (auto const& id : ids) {
+        cids.push_back(hcltrs->get_zeroid(id));
+        cids.push_back(hcltrs->get_oneid(id));
+    }
+
+    // Every proc offers the two lowest numbered members it has of each child
+    const int nprocs = get_nprocs();
+    std::vector<unsigned> mine(2*cids.size(), none);
+    std::vector<unsigned> all(nprocs*mine.size());
+    for (size_t c = 0; c < cids.size(); c++) {
+        const size_t nmemb = memb_index->size(cids[c]);
+        for (size_t i = 0; i < std::min<size_t>(nmemb, 2); i++)
+            mine[2*c + i] = global_rid(memb_index->get(cids[c], i));
+    }
+    if (!mine.empty()) {
+        mpi::transport::get()->allgather(&mine[0], &all[0], mine.size(),
+                mpi::UNSIGNED);
+    }
+
+    // Owners fill in the rows of their seeds, the rest add zeros
+    seeds.clear();
+    seed_offsets.clear();
+    std::vector<double> rows(mine.size()*ncol, 0);
+    for (size_t c = 0; c < cids.size(); c++) {
+        unsigned s0 = none, s1 = none;
+        for (int proc = 0; proc < nprocs; proc++) {
+            for (size_t i = 0; i < 2; i++) {
+                unsigned rid = all[proc*mine.size() + 2*c + i];
+                if (rid < s0) {
+                    s1 = s0;
+                    s0 = rid;
+                } else if (rid < s1) {
+                    s1 = rid;
+                }
+            }
+        }
+        if (s1 == none)
+            continue; // Fewer than 2 members
+
+        seeds[cids[c]] = std::pair<unsigned, unsigned>(s0, s1);
+        seed_offsets[s0] = (2*c)*ncol;
+        seed_offsets[s1] = (2*c + 1)*ncol;
+        for (auto const& rid : {s0, s1}) {
+            if (is_local(rid)) {
+                const double* data =
+                    coord.get_thd_data(local_rid(rid));
+                std::copy(data, data + ncol, &rows[seed_offsets[rid]]);
+            }
+        }
+    }
+
+    seed_rows.resize(rows.size());
+    if (!rows.empty())
+        mpi::mpi::reduce_double(&rows[0], &seed_rows[0], rows.size());
+}
+
+const bool hclust_comm::get_seeds(const unsigned cid,
+        unsigned& s0, unsigned& s1) const {
+    auto it = seeds.find(cid);
+    if (it == seeds.end())
+        return false;
+
+    s0 = it->second.first;
+    s1 = it->second.second;
+    return true;
+}
+
+const double* hclust_comm::get_seed(const unsigned rid) const {
+    auto it = seed_offsets.find(rid);
+    if (it == seed_offsets.end())
+        throw base::parameter_exception("Row " + std::to_string(rid) +
+                " is not a split seed");
+    return &seed_rows[it->second];
+}
+
+void hclust_comm::write_result(base::cluster_t& ret, const size_t ncol,
+        const size_t iters, const std::vector<unsigned>& assignments,
+        std::vector<llong_t>& counts,
+        const std::unordered_map<unsigned, std::vector<double>>& centroids,
+        const std::string outdir) {
+    ret = base::cluster_t(get_nrow(), ncol, iters, assignments, counts,
+            centroids);
+    std::vector<unsigned> local;
+    local.swap(ret.assignments);
+    ret.set_params(get_g_nrow(), ncol, iters, ret.k);
+
+    if (outdir.empty())
+        return;
+#ifndef BIND
+    if (is_root())
+        printf("\nWriting output to '%s'\n", outdir.c_str());
+#endif
+    mpi::write_cluster_t(ret, &local[0], local.size(), global_rid(0), outdir);
+}
+} } // End namespace knor::dist
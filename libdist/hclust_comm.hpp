@@ -0,0 +1,89 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_HCLUST_COMM_HPP__
+#define __KNOR_HCLUST_COMM_HPP__
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "row_comm.hpp"
+#include "hcluster_arena.hpp"
+
+namespace knor {
+namespace base {
+    class clusters;
+    class member_index;
+}
+
+namespace dist {
+
+/**
+  * The collectives the distributed hierarchical coordinators share on top
+  *  of those over the rows of each proc.
+  */
+class hclust_comm : public row_comm {
+private:
+    // Split seeds of the children of every node, by child id
+    std::unordered_map<unsigned, std::pair<unsigned, unsigned>> seeds;
+    std::vector<double> seed_rows;
+    std::unordered_map<unsigned, size_t> seed_offsets; // rid -> seed_rows
+
+    hclust_comm(base::row_partition::ptr part);
+
+public:
+    typedef std::shared_ptr<hclust_comm> ptr;
+
+    static ptr create(base::row_partition::ptr part) {
+        return ptr(new hclust_comm(part));
+    }
+
+    // Sum the threads' H_EM accumulators over all procs into hcltrs
+    void reduce(const std::vector<std::shared_ptr<thread> >& threads,
+            base::hcluster_arena::ptr hcltrs, base::vmap<unsigned>& nchanged);
+
+    // Add the threads' partition sums over all procs to cltrs
+    void reduce_partitions(const std::vector<std::shared_ptr<thread> >& threads,
+            std::shared_ptr<base::clusters> cltrs);
+
+    /**
+      * Find the two lowest numbered members over all procs of both children
+      *  of every node in hcltrs and give their rows to every proc. The index
+      *  must be current with the local assignments.
+      */
+    void gather_seeds(coordinator& coord,
+            base::hcluster_arena::ptr hcltrs,
+            std::shared_ptr<base::member_index> memb_index);
+    // The seeds of a child found by the last gather_seeds
+    const bool get_seeds(const unsigned cid, unsigned& s0, unsigned& s1) const;
+    const double* get_seed(const unsigned rid) const;
+
+    /**
+      * Root keeps the centroids and counts while every proc writes its own
+      *  assignments, remapped to the compacted cluster ids, to outdir.
+      */
+    void write_result(base::cluster_t& ret, const size_t ncol,
+            const size_t iters, const std::vector<unsigned>& assignments,
+            std::vector<llong_t>& counts,
+            const std::unordered_map<unsigned, std::vector<double>>& centroids,
+            const std::string outdir);
+};
+} } // End namespace knor::dist
+#endif
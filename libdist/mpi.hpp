@@ -21,7 +21,10 @@
 #define __KNOR_MPI_HPP__
 
 #include <mpi.h>
+#include <vector>
 #include "exception.hpp"
+#include "transport.hpp"
+#include "clusters.hpp"
 
 namespace knor { namespace mpi {
 class mpi {
@@ -40,45 +43,80 @@ public:
 
     static void reduce_double(const double* send_buff, double* recv_buff,
             const size_t numel=1) {
-        int ret = MPI_Allreduce(send_buff, recv_buff,
-                numel, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-        if (ret)
-            throw kbase::mpi_exception("All reduce failure in reduce_double"
-                    , ret);
+        transport::get()->allreduce(send_buff, recv_buff, numel, DOUBLE);
     }
 
     static void reduce_size_t(const size_t* send_buff, size_t* rev_buff,
             const size_t numel=1) {
-        int ret = MPI_Allreduce(send_buff, rev_buff, numel,
-                MPI::UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
-        if (ret)
-            throw kbase::mpi_exception("All reduce failure in reduce_size_t"
-                    , ret);
+        transport::get()->allreduce(send_buff, rev_buff, numel, ULLONG);
     }
 
     static void reduce_llong_t(const llong_t* send_buff, size_t* rev_buff,
             const size_t numel=1) {
-        int ret = MPI_Allreduce(send_buff, rev_buff, numel,
-                MPI::LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
-        if (ret)
-            throw kbase::mpi_exception("All reduce failure in reduce_llong_t"
-                    , ret);
+        transport::get()->allreduce(send_buff, rev_buff, numel, LLONG);
     }
 
     static void allgather_double(const double* send_buff,
             double* recv_buff, const size_t numel) {
-        int ret = MPI_Allgather(
-                send_buff, numel, MPI_DOUBLE, recv_buff,
-                numel, MPI_DOUBLE, MPI_COMM_WORLD);
-        if (ret)
-            throw kbase::mpi_exception("All gather failure in double", ret);
+        transport::get()->allgather(send_buff, recv_buff, numel, DOUBLE);
     }
 
     static void bcast_double(double* buffer, const int pid,
             const size_t numel) {
-        int ret = MPI_Bcast(buffer, numel, MPI_DOUBLE, pid, MPI_COMM_WORLD);
-        if (ret)
-            throw kbase::mpi_exception("Bcast failure in double", ret);
+        transport::get()->bcast(buffer, numel, DOUBLE, pid);
+    }
+
+    /**
+      * Allreduce k x ncol per-cluster sums as floats, half the bytes of
+      *  reduce_double. A cluster's sum is sent as its offset from `center'
+      *  (send - counts*center), small once the means settle, and the global
+      *  g_counts*center is added back in double.
+      * \param counts the per-cluster counts (or count diffs) behind send_buff
+      * \param g_counts counts already reduced over all procs
+      */
+    static void reduce_delta_float(const double* send_buff, double* recv_buff,
+            const double* center, const llong_t* counts,
+            const size_t* g_counts, const size_t k, const size_t ncol) {
+        std::vector<float> fsend(k*ncol), frecv(k*ncol);
+        for (size_t c = 0; c < k; c++)
+            for (size_t col = 0; col < ncol; col++)
+                fsend[c*ncol+col] = send_buff[c*ncol+col] -
+                    counts[c]*center[c*ncol+col];
+
+        transport::get()->allreduce(&fsend[0], &frecv[0], k*ncol, FLOAT);
+
+        for (size_t c = 0; c < k; c++)
+            for (size_t col = 0; col < ncol; col++)
+                recv_buff[c*ncol+col] = frecv[c*ncol+col] +
+                    static_cast<llong_t>(g_counts[c])*center[c*ncol+col];
+    }
+
+    /**
+      * Recompute cltrs from the assignments of every proc's rows, summed in
+      *  double. Undoes any drift reduce_delta_float left in the means.
+      * \param row maps a local row id to its data
+      */
+    template <typename RowFn>
+    static void exact_means(std::shared_ptr<knor::base::clusters> cltrs,
+            const size_t nrow, const unsigned* asgn, RowFn row) {
+        const size_t k = cltrs->get_nclust();
+        const size_t ncol = cltrs->get_ncol();
+        cltrs->clear();
+        for (size_t rid = 0; rid < nrow; rid++)
+            cltrs->add_member(row(rid), asgn[rid]);
+
+        std::vector<double> means(k*ncol);
+        std::vector<size_t> nmemb(k);
+        reduce_double(&(cltrs->get_means()[0]), &means[0], means.size());
+        reduce_llong_t(&(cltrs->get_num_members_v()[0]), &nmemb[0], k);
+        cltrs->set_mean(&means[0]);
+        cltrs->set_num_members_v(&nmemb[0]);
+        cltrs->finalize_all();
+    }
+
+    // The last collective of this proc
+    static void finalize() {
+        transport::get()->finalize();
     }
 
     // Merge the per-process cluster assingments so it can be returned in 1 proc
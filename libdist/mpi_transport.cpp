@@ -0,0 +1,116 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <climits>
+
+#include "mpi_transport.hpp"
+#include "exception.hpp"
+
+namespace knor { namespace mpi {
+
+static MPI_Datatype mpi_type(const dtype_t dt) {
+    switch (dt) {
+        case CHAR:
+            return MPI_CHAR;
+        case INT:
+            return MPI_INT;
+        case UNSIGNED:
+            return MPI_UNSIGNED;
+        case FLOAT:
+            return MPI_FLOAT;
+        case DOUBLE:
+            return MPI_DOUBLE;
+        case LLONG:
+            return MPI_LONG_LONG;
+        case ULLONG:
+            return MPI_UNSIGNED_LONG_LONG;
+        default:
+            throw base::parameter_exception("Unknown transport type");
+    }
+}
+
+// MPI counts are ints
+static int count(const size_t numel) {
+    if (numel > INT_MAX)
+        throw base::parameter_exception("Too many elements for one MPI call");
+    return numel;
+}
+
+static void check(const int ret, const std::string msg) {
+    if (ret != MPI_SUCCESS)
+        throw base::mpi_exception(msg, ret);
+}
+
+mpi_transport::mpi_transport(int argc, char* argv[]) {
+    int initialized;
+    MPI_Initialized(&initialized);
+    if (!initialized && MPI_Init(&argc, &argv) != MPI_SUCCESS)
+        throw std::runtime_error("MPI_Init error\n");
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+}
+
+void mpi_transport::allreduce(const void* send, void* recv,
+        const size_t numel, const dtype_t dt, const op_t op) {
+    check(MPI_Allreduce(send == recv ? MPI_IN_PLACE : send, recv,
+                count(numel), mpi_type(dt), op == SUM ? MPI_SUM : MPI_MAX,
+                MPI_COMM_WORLD), "All reduce failure");
+}
+
+void mpi_transport::allgather(const void* send, void* recv,
+        const size_t numel, const dtype_t dt) {
+    check(MPI_Allgather(send, count(numel), mpi_type(dt), recv,
+                count(numel), mpi_type(dt), MPI_COMM_WORLD),
+            "All gather failure");
+}
+
+void mpi_transport::allgatherv(const void* send, const size_t numel,
+        void* recv, const int* counts, const int* displs,
+        const dtype_t dt) {
+    check(MPI_Allgatherv(send, count(numel), mpi_type(dt), recv, counts,
+                displs, mpi_type(dt), MPI_COMM_WORLD),
+            "All gatherv failure");
+}
+
+void mpi_transport::alltoallv(const void* send, const int* scounts,
+        const int* sdispls, void* recv, const int* rcounts,
+        const int* rdispls, const dtype_t dt) {
+    check(MPI_Alltoallv(send, scounts, sdispls, mpi_type(dt), recv, rcounts,
+                rdispls, mpi_type(dt), MPI_COMM_WORLD),
+            "All to allv failure");
+}
+
+void mpi_transport::bcast(void* buff, const size_t numel, const dtype_t dt,
+        const int root) {
+    check(MPI_Bcast(buff, count(numel), mpi_type(dt), root, MPI_COMM_WORLD),
+            "Bcast failure");
+}
+
+void mpi_transport::barrier() {
+    check(MPI_Barrier(MPI_COMM_WORLD), "Barrier failure");
+}
+
+void mpi_transport::finalize() {
+    int finalized;
+    MPI_Finalized(&finalized);
+    if (!finalized)
+        MPI_Finalize();
+}
+} } // End namespace knor::mpi
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_MPI_TRANSPORT_HPP__
+#define __KNOR_MPI_TRANSPORT_HPP__
+
+#include <mpi.h>
+
+#include "transport.hpp"
+
+namespace knor { namespace mpi {
+
+// The collectives over MPI_COMM_WORLD
+class mpi_transport : public transport {
+private:
+    int rank, nprocs;
+
+    mpi_transport(int argc, char* argv[]);
+
+public:
+    static ptr create(int argc, char* argv[]) {
+        return ptr(new mpi_transport(argc, argv));
+    }
+
+    const int get_rank() const override { return rank; }
+    const int get_nprocs() const override { return nprocs; }
+    const bool is_mpi() const override { return true; }
+
+    void allreduce(const void* send, void* recv, const size_t numel,
+            const dtype_t dt, const op_t op=SUM) override;
+    void allgather(const void* send, void* recv, const size_t numel,
+            const dtype_t dt) override;
+    void allgatherv(const void* send, const size_t numel,
+            void* recv, const int* counts, const int* displs,
+            const dtype_t dt) override;
+    void alltoallv(const void* send, const int* scounts,
+            const int* sdispls, void* recv, const int* rcounts,
+            const int* rdispls, const dtype_t dt) override;
+    void bcast(void* buff, const size_t numel, const dtype_t dt,
+            const int root) override;
+    void barrier() override;
+    void finalize() override;
+};
+} } // End namespace knor::mpi
+#endif
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "row_comm.hpp"
+#include "mpi.hpp"
+#include "dist_io.hpp"
+#include "coordinator.hpp"
+#include "thread.hpp"
+
+namespace knor { namespace dist {
+
+row_comm::row_comm(base::row_partition::ptr part) : part(part) {
+    mpi_rank = mpi::transport::get()->get_rank();
+}
+
+void row_comm::shift_start_rids(
+        std::vector<std::shared_ptr<thread> >& threads, const bool global) {
+    for (auto const& thd : threads) {
+        if (global)
+            thd->set_start_rid(thd->get_start_rid() + part->first(mpi_rank));
+        else
+            thd->set_start_rid(thd->get_start_rid() - part->first(mpi_rank));
+    }
+}
+
+void row_comm::bcast_row(coordinator& coord, const size_t rid,
+        double* row) {
+    const size_t ncol = coord.get_ncol();
+    if (is_local(rid)) {
+        const double* data = coord.get_thd_data(local_rid(rid));
+        std::copy(data, data + ncol, row);
+    }
+    mpi::mpi::bcast_double(row, part->owner(rid), ncol);
+}
+
+void row_comm::reduce(std::vector<double>& buff) {
+    if (buff.empty())
+        return;
+    reduce_buff.resize(buff.size());
+    mpi::mpi::reduce_double(&buff[0], &reduce_buff[0], buff.size());
+    buff.swap(reduce_buff);
+}
+
+void row_comm::write_result(base::cluster_t& ret, const size_t ncol,
+        const size_t iters, const unsigned k, const unsigned* assignments,
+        const std::vector<double>& centroids, const std::string outdir) {
+    std::vector<llong_t> counts(k, 0);
+    for (size_t row = 0; row < get_nrow(); row++)
+        counts[assignments[row]]++;
+
+    ret = base::cluster_t(get_g_nrow(), ncol, iters, k, NULL, &counts[0],
+            centroids);
+    mpi::mpi::reduce_llong_t(&counts[0], &ret.assignment_count[0], k);
+
+    if (outdir.empty())
+        return;
+#ifndef BIND
+    if (is_root())
+        printf("\nWriting output to '%s'\n", outdir.c_str());
+#endif
+    mpi::write_cluster_t(ret, assignments, get_nrow(), global_rid(0), outdir);
+}
+} } // End namespace knor::dist
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_ROW_COMM_HPP__
+#define __KNOR_ROW_COMM_HPP__
+
+#include <memory>
+#include <vector>
+
+#include "row_partition.hpp"
+#include "types.hpp"
+
+namespace kbase = knor::base;
+
+namespace knor {
+class coordinator;
+class thread;
+
+namespace dist {
+
+/**
+  * The collectives the distributed coordinators built on the single-node
+  *  ones share. Each proc holds the contiguous block of rows `part' gives
+  *  it, so a row's global id is its local id plus the first row of the proc.
+  */
+class row_comm {
+protected:
+    base::row_partition::ptr part;
+    int mpi_rank;
+    std::vector<double> reduce_buff;
+
+    row_comm(base::row_partition::ptr part);
+
+public:
+    typedef std::shared_ptr<row_comm> ptr;
+
+    static ptr create(base::row_partition::ptr part) {
+        return ptr(new row_comm(part));
+    }
+
+    const bool is_root() const { return mpi_rank == 0; }
+    const int get_rank() const { return mpi_rank; }
+    const unsigned get_nprocs() const { return part->get_nparts(); }
+    const size_t get_nrow() const { return part->nrow(mpi_rank); }
+    const size_t get_g_nrow() const { return part->get_g_nrow(); }
+    const size_t global_rid(const size_t local_rid) const {
+        return part->first(mpi_rank) + local_rid;
+    }
+    const size_t local_rid(const size_t global_rid) const {
+        return global_rid - part->first(mpi_rank);
+    }
+    const bool is_local(const size_t global_rid) const {
+        return local_rid(global_rid) < get_nrow();
+    }
+    const unsigned owner(const size_t global_rid) const {
+        return part->owner(global_rid);
+    }
+
+    // Move thread start_rids between local (false) and global (true) rows.
+    //  Threads read their rows at global offsets of the file.
+    void shift_start_rids(std::vector<std::shared_ptr<thread> >& threads,
+            const bool global);
+
+    // Copy global row rid to every proc
+    void bcast_row(coordinator& coord, const size_t rid, double* row);
+
+    // Replace buff by its elementwise sum over all procs
+    void reduce(std::vector<double>& buff);
+
+    /**
+      * Root keeps the centroids and the counts of the local assignments
+      *  summed over all procs while every proc writes its own assignments
+      *  to outdir.
+      */
+    void write_result(base::cluster_t& ret, const size_t ncol,
+            const size_t iters, const unsigned k, const unsigned* assignments,
+            const std::vector<double>& centroids, const std::string outdir);
+};
+} } // End namespace knor::dist
+#endif
@@ -0,0 +1,346 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <new>
+
+#include "shm_transport.hpp"
+#include "exception.hpp"
+
+namespace knor { namespace mpi {
+
+// Checks of the barrier generation before sleeping on it
+static const unsigned BARRIER_SPINS = 1024;
+
+static long futex(std::atomic<int>* addr, const int op, const int val) {
+    // Not FUTEX_PRIVATE_FLAG, waiters are in other processes
+    return syscall(SYS_futex, reinterpret_cast<int*>(addr), op, val,
+            NULL, NULL, 0);
+}
+
+template <typename T>
+static void reduce_slice(const char* slots, const size_t slot_bytes,
+        const int nprocs, char* res, const size_t lo, const size_t hi,
+        const op_t op) {
+    T* out = reinterpret_cast<T*>(res);
+    const T* in = reinterpret_cast<const T*>(slots);
+    std::copy(in + lo, in + hi, out + lo);
+
+    for (int proc = 1; proc < nprocs; proc++) {
+        in = reinterpret_cast<const T*>(slots + proc*slot_bytes);
+        if (op == SUM) {
+            for (size_t i = lo; i < hi; i++)
+                out[i] += in[i];
+        } else {
+            for (size_t i = lo; i < hi; i++)
+                out[i] = std::max(out[i], in[i]);
+        }
+    }
+}
+
+shm_transport::shm_transport(const int rank, const int nprocs, char* seg,
+        const size_t seg_bytes, const size_t slot_bytes) :
+    rank(rank), nprocs(nprocs), slot_bytes(slot_bytes), seg(seg),
+    seg_bytes(seg_bytes), nsteps(0) {
+    ctl = reinterpret_cast<control*>(seg);
+}
+
+bool shm_transport::launch(const int nprocs, int& status,
+        const size_t slot_bytes) {
+    if (nprocs < 1)
+        throw base::parameter_exception("Need at least one local proc");
+
+    const size_t seg_bytes = ctl_bytes() + 2*(nprocs + 1)*slot_bytes;
+    const std::string name = "/knor-" + std::to_string(getpid());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        throw base::io_exception("Cannot create shared memory " + name);
+    if (ftruncate(fd, seg_bytes)) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw base::io_exception("Cannot size shared memory " + name);
+    }
+    void* addr = mmap(NULL, seg_bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+            fd, 0);
+    close(fd);
+    shm_unlink(name.c_str()); // The mapping outlives the name
+    if (addr == MAP_FAILED)
+        throw base::io_exception("Cannot map shared memory " + name);
+
+    char* seg = static_cast<char*>(addr);
+    control* ctl = new (seg) control();
+    ctl->count.store(0);
+    ctl->gen.store(0);
+
+    // Buffered output would be written by every child too
+    fflush(NULL);
+
+    const pid_t parent = getpid();
+    std::vector<pid_t> pids;
+    for (int rank = 0; rank < nprocs; rank++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            // Don't outlive the launcher
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if (getppid() != parent)
+                exit(EXIT_FAILURE);
+            transport::set(ptr(new shm_transport(rank, nprocs, seg,
+                            seg_bytes, slot_bytes)));
+            return true;
+        }
+        if (pid < 0) {
+            for (auto const& p : pids)
+                kill(p, SIGTERM);
+            while (wait(NULL) > 0) { }
+            munmap(seg, seg_bytes);
+            throw base::io_exception("Cannot fork local proc " +
+                    std::to_string(rank));
+        }
+        pids.push_back(pid);
+    }
+
+    // A proc that dies leaves the rest at a barrier, so stop them
+    status = EXIT_SUCCESS;
+    size_t nrunning = pids.size();
+    while (nrunning) {
+        int wstatus;
+        pid_t pid = wait(&wstatus);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        nrunning--;
+        pids.erase(std::remove(pids.begin(), pids.end(), pid), pids.end());
+
+        if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != EXIT_SUCCESS) {
+            if (status == EXIT_SUCCESS) {
+                fprintf(stderr, "[ERROR]: Local proc %d failed, stopping"
+                        " the rest\n", pid);
+                for (auto const& p : pids)
+                    kill(p, SIGTERM);
+            }
+            status = EXIT_FAILURE;
+        }
+    }
+
+    munmap(seg, seg_bytes);
+    return false;
+}
+
+void shm_transport::barrier() {
+    const int gen = ctl->gen.load(std::memory_order_acquire);
+    if (ctl->count.fetch_add(1, std::memory_order_acq_rel) == nprocs - 1) {
+        // Last in releases the rest
+        ctl->count.store(0, std::memory_order_relaxed);
+        ctl->gen.fetch_add(1, std::memory_order_release);
+        futex(&ctl->gen, FUTEX_WAKE, INT_MAX);
+        return;
+    }
+
+    for (unsigned spin = 0;
+            ctl->gen.load(std::memory_order_acquire) == gen; spin++) {
+        if (spin >= BARRIER_SPINS)
+            futex(&ctl->gen, FUTEX_WAIT, gen); // Returns if gen moved on
+    }
+}
+
+void shm_transport::allreduce(const void* send, void* recv,
+        const size_t numel, const dtype_t dt, const op_t op) {
+    const size_t elem_size = dtype_size(dt);
+    const size_t step = step_numel(elem_size);
+
+    for (size_t off = 0; off < numel; off += step) {
+        const size_t n = std::min(step, numel - off);
+        const unsigned bank = next_bank();
+        memcpy(slot(bank, rank),
+                static_cast<const char*>(send) + off*elem_size,
+                n*elem_size);
+        barrier();
+
+        // Combine this proc's slice of every slot
+        const size_t lo = (n*rank)/nprocs;
+        const size_t hi = (n*(rank+1))/nprocs;
+        const char* slots = slot(bank, 0);
+        switch (dt) {
+            case CHAR:
+                reduce_slice<char>(slots, slot_bytes, nprocs,
+                        result(bank), lo, hi, op);
+                break;
+            case INT:
+                reduce_slice<int>(slots, slot_bytes, nprocs,
+                        result(bank), lo, hi, op);
+                break;
+            case UNSIGNED:
+                reduce_slice<unsigned>(slots, slot_bytes, nprocs,
+                        result(bank), lo, hi, op);
+                break;
+            case FLOAT:
+                reduce_slice<float>(slots, slot_bytes, nprocs,
+                        result(bank), lo, hi, op);
+                break;
+            case DOUBLE:
+                reduce_slice<double>(slots, slot_bytes, nprocs,
+                        result(bank), lo, hi, op);
+                break;
+            case LLONG:
+                reduce_slice<long long>(slots, slot_bytes, nprocs,
+                        result(bank), lo, hi, op);
+                break;
+            case ULLONG:
+                reduce_slice<unsigned long long>(slots, slot_bytes, nprocs,
+                        result(bank), lo, hi, op);
+                break;
+            default:
+                throw base::parameter_exception("Unknown transport type");
+        }
+        barrier();
+
+        memcpy(static_cast<char*>(recv) + off*elem_size, result(bank),
+                n*elem_size);
+    }
+}
+
+void shm_transport::allgather(const void* send, void* recv,
+        const size_t numel, const dtype_t dt) {
+    const size_t elem_size = dtype_size(dt);
+    const size_t step = step_numel(elem_size);
+
+    for (size_t off = 0; off < numel; off += step) {
+        const size_t n = std::min(step, numel - off);
+        const unsigned bank = next_bank();
+        memcpy(slot(bank, rank),
+                static_cast<const char*>(send) + off*elem_size,
+                n*elem_size);
+        barrier();
+
+        for (int proc = 0; proc < nprocs; proc++)
+            memcpy(static_cast<char*>(recv) + (proc*numel + off)*elem_size,
+                    slot(bank, proc), n*elem_size);
+    }
+}
+
+void shm_transport::allgatherv(const void* send, const size_t numel,
+        void* recv, const int* counts, const int* displs,
+        const dtype_t dt) {
+    const size_t elem_size = dtype_size(dt);
+    const size_t step = step_numel(elem_size);
+    const size_t max_count = *std::max_element(counts, counts + nprocs);
+
+    for (size_t off = 0; off < max_count; off += step) {
+        const unsigned bank = next_bank();
+        if (off < numel)
+            memcpy(slot(bank, rank),
+                    static_cast<const char*>(send) + off*elem_size,
+                    std::min(step, numel - off)*elem_size);
+        barrier();
+
+        for (int proc = 0; proc < nprocs; proc++) {
+            const size_t count = counts[proc];
+            if (off < count)
+                memcpy(static_cast<char*>(recv) +
+                        (displs[proc] + off)*elem_size, slot(bank, proc),
+                        std::min(step, count - off)*elem_size);
+        }
+    }
+}
+
+void shm_transport::alltoallv(const void* send, const int* scounts,
+        const int* sdispls, void* recv, const int* rcounts,
+        const int* rdispls, const dtype_t dt) {
+    const size_t elem_size = dtype_size(dt);
+    const size_t step = step_numel(elem_size);
+
+    // Every proc's send counts so all agree on the number of steps
+    std::vector<int> all_scounts(nprocs*nprocs);
+    allgather(scounts, &all_scounts[0], nprocs, INT);
+
+    // One destination at a time, all procs write their part for it
+    for (int dst = 0; dst < nprocs; dst++) {
+        size_t max_count = 0;
+        for (int proc = 0; proc < nprocs; proc++)
+            max_count = std::max<size_t>(max_count,
+                    all_scounts[proc*nprocs + dst]);
+
+        for (size_t off = 0; off < max_count; off += step) {
+            const unsigned bank = next_bank();
+            const size_t scount = scounts[dst];
+            if (off < scount)
+                memcpy(slot(bank, rank), static_cast<const char*>(send) +
+                        (sdispls[dst] + off)*elem_size,
+                        std::min(step, scount - off)*elem_size);
+            barrier();
+
+            if (rank != dst)
+                continue;
+            for (int proc = 0; proc < nprocs; proc++) {
+                const size_t rcount = rcounts[proc];
+                if (off < rcount)
+                    memcpy(static_cast<char*>(recv) +
+                            (rdispls[proc] + off)*elem_size,
+                            slot(bank, proc),
+                            std::min(step, rcount - off)*elem_size);
+            }
+        }
+    }
+}
+
+void shm_transport::bcast(void* buff, const size_t numel, const dtype_t dt,
+        const int root) {
+    const size_t elem_size = dtype_size(dt);
+    const size_t step = step_numel(elem_size);
+
+    for (size_t off = 0; off < numel; off += step) {
+        const size_t n = std::min(step, numel - off);
+        const unsigned bank = next_bank();
+        char* part = static_cast<char*>(buff) + off*elem_size;
+        if (rank == root)
+            memcpy(slot(bank, root), part, n*elem_size);
+        barrier();
+        if (rank != root)
+            memcpy(part, slot(bank, root), n*elem_size);
+    }
+}
+
+void shm_transport::finalize() {
+    if (!seg)
+        return;
+    barrier();
+    munmap(seg, seg_bytes);
+    seg = NULL;
+}
+
+shm_transport::~shm_transport() {
+    if (seg)
+        munmap(seg, seg_bytes);
+}
+} } // End namespace knor::mpi
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_SHM_TRANSPORT_HPP__
+#define __KNOR_SHM_TRANSPORT_HPP__
+
+#include <atomic>
+#include <vector>
+
+#include "transport.hpp"
+
+namespace knor { namespace mpi {
+
+/**
+  * The collectives between procs forked on one machine that share a POSIX
+  *  shared memory segment. Each collective moves its data in steps of at
+  *  most slot_bytes per proc: procs copy into their own slot, meet at a
+  *  futex barrier and copy out of the others'. Reductions are split so
+  *  each proc combines a slice of every slot, in rank order, into a result
+  *  all procs read. Steps alternate between two banks of slots so a step
+  *  only waits for the previous one, not for readers of its own bank.
+  */
+class shm_transport : public transport {
+private:
+    // Shared control block at the start of the segment
+    struct control {
+        std::atomic<int> count; // Procs at the barrier
+        std::atomic<int> gen; // Barriers completed. Waiters futex on it.
+    };
+
+    const int rank, nprocs;
+    const size_t slot_bytes;
+    char* seg; // control | 2 banks of nprocs slots and a result slot
+    size_t seg_bytes;
+    control* ctl;
+    size_t nsteps; // Steps so far, picks the bank
+
+    shm_transport(const int rank, const int nprocs, char* seg,
+            const size_t seg_bytes, const size_t slot_bytes);
+
+    char* slot(const unsigned bank, const int proc) {
+        return seg + ctl_bytes() + (bank*(nprocs + 1) + proc)*slot_bytes;
+    }
+    char* result(const unsigned bank) { return slot(bank, nprocs); }
+    const unsigned next_bank() { return nsteps++ % 2; }
+    static const size_t ctl_bytes() { return 4096; }
+    // Largest number of elements of size elem_size one step moves
+    const size_t step_numel(const size_t elem_size) const {
+        return slot_bytes / elem_size;
+    }
+
+public:
+    /**
+      * Fork nprocs procs sharing one segment. Returns true in each of them
+      *  with its transport installed. The caller only supervises: it
+      *  returns false once they all exited, with status EXIT_FAILURE if
+      *  any failed, in which case the rest are terminated.
+      */
+    static bool launch(const int nprocs, int& status,
+            const size_t slot_bytes=1UL << 20);
+
+    const int get_rank() const override { return rank; }
+    const int get_nprocs() const override { return nprocs; }
+    const bool is_mpi() const override { return false; }
+
+    void allreduce(const void* send, void* recv, const size_t numel,
+            const dtype_t dt, const op_t op=SUM) override;
+    void allgather(const void* send, void* recv, const size_t numel,
+            const dtype_t dt) override;
+    void allgatherv(const void* send, const size_t numel,
+            void* recv, const int* counts, const int* displs,
+            const dtype_t dt) override;
+    void alltoallv(const void* send, const int* scounts,
+            const int* sdispls, void* recv, const int* rcounts,
+            const int* rdispls, const dtype_t dt) override;
+    void bcast(void* buff, const size_t numel, const dtype_t dt,
+            const int root) override;
+    void barrier() override;
+    void finalize() override;
+    ~shm_transport();
+};
+} } // End namespace knor::mpi
+#endif
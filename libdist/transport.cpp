@@ -0,0 +1,63 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "transport.hpp"
+#include "mpi_transport.hpp"
+#include "exception.hpp"
+
+namespace knor { namespace mpi {
+
+static transport::ptr instance;
+
+const size_t dtype_size(const dtype_t dt) {
+    switch (dt) {
+        case CHAR:
+            return sizeof(char);
+        case INT:
+            return sizeof(int);
+        case UNSIGNED:
+            return sizeof(unsigned);
+        case FLOAT:
+            return sizeof(float);
+        case DOUBLE:
+            return sizeof(double);
+        case LLONG:
+            return sizeof(long long);
+        case ULLONG:
+            return sizeof(unsigned long long);
+        default:
+            throw base::parameter_exception("Unknown transport type");
+    }
+}
+
+void transport::init(int argc, char* argv[]) {
+    if (!instance)
+        instance = mpi_transport::create(argc, argv);
+}
+
+void transport::set(ptr t) {
+    instance = t;
+}
+
+transport::ptr transport::get() {
+    if (!instance)
+        init(0, NULL);
+    return instance;
+}
+} } // End namespace knor::mpi
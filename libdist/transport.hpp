@@ -0,0 +1,78 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_TRANSPORT_HPP__
+#define __KNOR_TRANSPORT_HPP__
+
+#include <memory>
+#include <string>
+
+#include "types.hpp"
+
+namespace knor { namespace mpi {
+
+// Element types & reductions the transports move
+enum dtype_t { CHAR, INT, UNSIGNED, FLOAT, DOUBLE, LLONG, ULLONG };
+enum op_t { SUM, MAX };
+
+const size_t dtype_size(const dtype_t dt);
+
+/**
+  * The collectives the distributed coordinators run over all procs of a
+  *  job. Every proc calls them in the same order with the same sizes.
+  *  Counts are in elements of dt. A reduction's send may be its recv.
+  */
+class transport {
+public:
+    typedef std::shared_ptr<transport> ptr;
+
+    virtual const int get_rank() const = 0;
+    virtual const int get_nprocs() const = 0;
+    // MPI-IO reads & writes and non-blocking reductions need MPI
+    virtual const bool is_mpi() const = 0;
+
+    virtual void allreduce(const void* send, void* recv, const size_t numel,
+            const dtype_t dt, const op_t op=SUM) = 0;
+    // numel elements from every proc land in recv in rank order
+    virtual void allgather(const void* send, void* recv, const size_t numel,
+            const dtype_t dt) = 0;
+    // counts[p] elements from proc p land at displs[p] of recv
+    virtual void allgatherv(const void* send, const size_t numel,
+            void* recv, const int* counts, const int* displs,
+            const dtype_t dt) = 0;
+    // scounts[p] elements at sdispls[p] of send go to proc p, rcounts[p]
+    //  from proc p land at rdispls[p] of recv
+    virtual void alltoallv(const void* send, const int* scounts,
+            const int* sdispls, void* recv, const int* rcounts,
+            const int* rdispls, const dtype_t dt) = 0;
+    virtual void bcast(void* buff, const size_t numel, const dtype_t dt,
+            const int root) = 0;
+    virtual void barrier() = 0;
+    // Last call of a proc on the transport
+    virtual void finalize() = 0;
+    virtual ~transport() { }
+
+    // Use MPI unless a transport was installed, e.g. by a local launch
+    static void init(int argc, char* argv[]);
+    static void set(ptr t);
+    // The transport of this proc, initializing MPI if needed
+    static ptr get();
+};
+} } // End namespace knor::mpi
+#endif
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <functional>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "centroid_graph.hpp"
+#include "util.hpp"
+
+namespace knor { namespace base {
+
+centroid_graph::centroid_graph(const unsigned degree,
+        const unsigned ef_construction, const dist_t dt) :
+    degree(degree), max_degree(2*degree),
+    ef_construction(std::max(ef_construction, degree)), dt(dt),
+    means(NULL), nnodes(0), ncol(0) {
+        if (!degree)
+            throw parameter_exception("centroid_graph degree must be > 0");
+}
+
+const double centroid_graph::dist(const double* query,
+        const unsigned node) const {
+    return dist_comp_raw<double>(query,
+            &means[static_cast<size_t>(node)*ncol], ncol, dt);
+}
+
+void centroid_graph::search_layer(const double* query, const unsigned start,
+        const unsigned ef, visit_list& vl,
+        std::vector<dist_node>& found) const {
+    if (vl.tags.size() < nnodes) {
+        vl.tags.assign(nnodes, 0);
+        vl.epoch = 0;
+    }
+    if (++vl.epoch == 0) { // Wrapped around
+        std::fill(vl.tags.begin(), vl.tags.end(), 0);
+        vl.epoch = 1;
+    }
+
+    // cands is a min-heap of the frontier, found a max-heap of the best ef
+    std::vector<dist_node>& cands = vl.cands;
+    cands.clear();
+    found.clear();
+
+    dist_node first(dist(query, start), start);
+    vl.tags[start] = vl.epoch;
+    cands.push_back(first);
+    found.push_back(first);
+
+    while (!cands.empty()) {
+        std::pop_heap(cands.begin(), cands.end(),
+                std::greater<dist_node>());
+        const dist_node curr = cands.back();
+        cands.pop_back();
+
+        if (found.size() >= ef && curr.first > found.front().first)
+            break; // Nothing left can improve the beam
+
+        const unsigned* nbr = get_neighbors(curr.second);
+        for (unsigned i = 0; i < nnbrs[curr.second]; i++) {
+            const unsigned node = nbr[i];
+            if (vl.tags[node] == vl.epoch)
+                continue;
+            vl.tags[node] = vl.epoch;
+
+            const double d = dist(query, node);
+            if (found.size() < ef || d < found.front().first) {
+                cands.push_back(dist_node(d, node));
+                std::push_heap(cands.begin(), cands.end(),
+                        std::greater<dist_node>());
+                found.push_back(dist_node(d, node));
+                std::push_heap(found.begin(), found.end());
+                if (found.size() > ef) {
+                    std::pop_heap(found.begin(), found.end());
+                    found.pop_back();
+                }
+            }
+        }
+    }
+}
+
+unsigned centroid_graph::search(const double* query, const unsigned start,
+        const unsigned ef, double& best_dist, visit_list& vl) const {
+    search_layer(query, start, std::max(ef, 1U), vl, vl.res);
+
+    dist_node best = *std::min_element(vl.res.begin(), vl.res.end());
+    best_dist = best.first;
+    return best.second;
+}
+
+void centroid_graph::select_neighbors(std::vector<dist_node>& cands,
+        const unsigned keep, std::vector<unsigned>& selected) const {
+    std::sort(cands.begin(), cands.end());
+    selected.clear();
+    std::vector<unsigned> skipped;
+
+    for (size_t i = 0; i < cands.size() && selected.size() < keep; i++) {
+        const double* cmean = &means[static_cast<size_t>(
+                cands[i].second)*ncol];
+        bool diverse = true;
+        for (size_t j = 0; j < selected.size(); j++) {
+            if (dist(cmean, selected[j]) < cands[i].first) {
+                diverse = false;
+                break;
+            }
+        }
+        if (diverse)
+            selected.push_back(cands[i].second);
+        else
+            skipped.push_back(cands[i].second);
+    }
+
+    // Fill remaining slots with the closest skipped nodes
+    for (size_t i = 0; i < skipped.size() && selected.size() < keep; i++)
+        selected.push_back(skipped[i]);
+}
+
+void centroid_graph::link(const unsigned node, const unsigned nbr) {
+    unsigned* list = &nbrs[static_cast<size_t>(node)*max_degree];
+    for (unsigned i = 0; i < nnbrs[node]; i++)
+        if (list[i] == nbr)
+            return;
+
+    if (nnbrs[node] < max_degree) {
+        list[nnbrs[node]++] = nbr;
+        return;
+    }
+
+    // Full: re-select from the current neighbours and the new one
+    const double* nmean = &means[static_cast<size_t>(node)*ncol];
+    std::vector<dist_node> cands;
+    for (unsigned i = 0; i < nnbrs[node]; i++)
+        cands.push_back(dist_node(dist(nmean, list[i]), list[i]));
+    cands.push_back(dist_node(dist(nmean, nbr), nbr));
+
+    std::vector<unsigned> selected;
+    select_neighbors(cands, max_degree, selected);
+    std::copy(selected.begin(), selected.end(), list);
+    nnbrs[node] = selected.size();
+}
+
+void centroid_graph::build(const double* means, const size_t nnodes,
+        const size_t ncol) {
+    this->means = means;
+    this->nnodes = nnodes;
+    this->ncol = ncol;
+    nbrs.assign(nnodes*max_degree, 0);
+    nnbrs.assign(nnodes, 0);
+
+    // Insert in batches that only see earlier batches, so each batch is
+    //  searched in parallel. Batches grow as the graph gets navigable.
+    const size_t max_batch = 256;
+    std::vector<std::vector<unsigned> > selected(max_batch);
+    size_t inserted = 1, batch = 1;
+#ifdef _OPENMP
+    std::vector<visit_list> vls(omp_get_max_threads());
+#else
+    std::vector<visit_list> vls(1);
+#endif
+
+    while (inserted < nnodes) {
+        const size_t end = std::min(nnodes, inserted + batch);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+#ifdef _OPENMP
+            visit_list& vl = vls[omp_get_thread_num()];
+#else
+            visit_list& vl = vls[0];
+#endif
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (size_t node = inserted; node < end; node++) {
+                search_layer(&means[node*ncol], 0, ef_construction, vl,
+                        vl.res);
+                select_neighbors(vl.res, degree, selected[node-inserted]);
+            }
+        }
+
+        for (size_t node = inserted; node < end; node++) {
+            const std::vector<unsigned>& sel = selected[node-inserted];
+            for (size_t i = 0; i < sel.size(); i++) {
+                link(node, sel[i]);
+                link(sel[i], node);
+            }
+        }
+
+        inserted = end;
+        batch = std::min(batch*2, max_batch);
+    }
+}
+} } // End namespace knor::base
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_CENTROID_GRAPH_HPP__
+#define __KNOR_CENTROID_GRAPH_HPP__
+
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "types.hpp"
+
+namespace knor { namespace base {
+
+/**
+  * Navigable proximity graph over the centroids (one layer of an HNSW) for
+  *  approximate nearest centroid search when k is too large for exact or
+  *  pruned assignment. Nodes are linked to up to `degree` diverse near
+  *  neighbours (2*degree after reverse links). A search is a best-first
+  *  beam of width ef from a start node, ideally the row's last centroid.
+  */
+class centroid_graph {
+public:
+    typedef std::shared_ptr<centroid_graph> ptr;
+    typedef std::pair<double, unsigned> dist_node;
+
+    // Per searcher scratch space. Not shareable between threads.
+    struct visit_list {
+        std::vector<unsigned> tags;
+        unsigned epoch;
+        std::vector<dist_node> cands, res;
+        visit_list() : epoch(0) { }
+    };
+
+private:
+    const unsigned degree, max_degree, ef_construction;
+    const dist_t dt;
+    const double* means; // Not owned
+    size_t nnodes, ncol;
+    std::vector<unsigned> nbrs; // nnodes x max_degree
+    std::vector<unsigned> nnbrs; // nnodes
+
+    centroid_graph(const unsigned degree, const unsigned ef_construction,
+            const dist_t dt);
+
+    const double dist(const double* query, const unsigned node) const;
+    void search_layer(const double* query, const unsigned start,
+            const unsigned ef, visit_list& vl,
+            std::vector<dist_node>& found) const;
+    // Keep up to `keep` candidates closer to the base than to each other
+    void select_neighbors(std::vector<dist_node>& cands,
+            const unsigned keep, std::vector<unsigned>& selected) const;
+    void link(const unsigned node, const unsigned nbr);
+
+public:
+    static ptr create(const unsigned degree=16,
+            const unsigned ef_construction=64,
+            const dist_t dt=dist_t::EUCL) {
+        return ptr(new centroid_graph(degree, ef_construction, dt));
+    }
+
+    /**
+      * (Re)build over nnodes x ncol means in parallel. The means must stay
+      *  valid and unchanged while searching.
+      */
+    void build(const double* means, const size_t nnodes, const size_t ncol);
+
+    /**
+      * Approximate nearest node to query.
+      * \param start the node the search starts from.
+      * \param ef the beam width, higher is slower with better recall.
+      * \param best_dist set to the distance to the returned node.
+      */
+    unsigned search(const double* query, const unsigned start,
+            const unsigned ef, double& best_dist, visit_list& vl) const;
+
+    const size_t get_nnodes() const { return nnodes; }
+    const unsigned get_degree(const unsigned node) const {
+        return nnbrs[node];
+    }
+    const unsigned* get_neighbors(const unsigned node) const {
+        return &nbrs[static_cast<size_t>(node)*max_degree];
+    }
+};
+} } // End namespace knor::base
+#endif
@@ -29,6 +29,7 @@ void clusters::clear() {
     std::fill(means.begin(), means.end(), 0);
     std::fill(num_members_v.begin(), num_members_v.end(), 0);
     std::fill(complete_v.begin(), complete_v.end(), false);
+    std::fill(weights_v.begin(), weights_v.end(), 0);
 }
 
 /** \param idx the cluster index.
@@ -57,7 +58,12 @@ void clusters::finalize(const unsigned idx) {
         return;
     }
 
-    if (num_members_v[idx] > 1) { // Less than 2 is the same result
+    if (is_weighted()) {
+        if (weights_v[idx] > 0) {
+            for (unsigned i = 0; i < ncol; i++)
+                means[(idx*ncol)+i] /= weights_v[idx];
+        }
+    } else if (num_members_v[idx] > 1) { // Less than 2 is the same result
         for (unsigned i = 0; i < ncol; i++) {
             means[(idx*ncol)+i] /= double(num_members_v[idx]);
         }
@@ -70,6 +76,14 @@ void clusters::unfinalize(const unsigned idx) {
         return;
 
     complete_v[idx] = false;
+    if (is_weighted()) {
+        if (weights_v[idx] > 0) {
+            for (unsigned col = 0; col < ncol; col++)
+                this->means[(ncol*idx) + col] *= weights_v[idx];
+        }
+        return;
+    }
+
     if (num_members_v[idx] < 2)
         return;
 
@@ -95,6 +109,7 @@ void clusters::set_num_members_v(const size_t* arg) {
 clusters& clusters::operator=(clusters& other) {
     this->means = other.get_means();
     this->num_members_v = other.get_num_members_v();
+    this->weights_v = other.weights_v;
     this->ncol = other.get_ncol();
     this->nclust = other.get_nclust();
     return *this;
@@ -112,6 +127,13 @@ clusters& clusters::operator+=(clusters& rhs) {
     for (unsigned i = 0; i < size(); i++)
         this->means[i] += rhs[i];
 
+    // Unweighted members on either side weigh 1 each
+    if (rhs.is_weighted())
+        init_weights();
+    if (is_weighted())
+        for (unsigned idx = 0; idx < nclust; idx++)
+            weights_v[idx] += rhs.get_weight(idx);
+
     for (unsigned idx = 0; idx < nclust; idx++)
         num_members_peq(rhs.get_num_members(idx), idx);
     return *this;
@@ -122,6 +144,13 @@ void clusters::peq(ptr rhs) {
     for (unsigned i = 0; i < size(); i++)
         this->means[i] += rhs->get(i);
 
+    // Unweighted members on either side weigh 1 each
+    if (rhs->is_weighted())
+        init_weights();
+    if (is_weighted())
+        for (unsigned idx = 0; idx < nclust; idx++)
+            weights_v[idx] += rhs->get_weight(idx);
+
     for (unsigned idx = 0; idx < nclust; idx++)
         num_members_peq(rhs->get_num_members(idx), idx);
 }
@@ -45,9 +45,17 @@ protected:
     unsigned nclust;
     std::vector<llong_t> num_members_v; // Cluster assignment counts
     std::vector<bool> complete_v; // Have we already divided by num_members
+    // Total member weight per cluster. Empty unless weighted members added.
+    std::vector<double> weights_v;
 
     kmsvector means; // Cluster means
 
+    // Start tracking weights. Members already counted weigh 1 each.
+    void init_weights() {
+        if (weights_v.empty())
+            weights_v.assign(num_members_v.begin(), num_members_v.end());
+    }
+
 public:
     typedef typename std::shared_ptr<clusters> ptr;
 
@@ -133,6 +141,44 @@ public:
         num_members_v[idx]++;
     }
 
+    // Weighted member (e.g. a coreset point). Means divide by total weight.
+    void add_member(const double* arr, const unsigned idx,
+            const double weight) {
+        init_weights();
+
+        unsigned offset = idx * ncol;
+        for (unsigned i=0; i < ncol; i++) {
+            means[offset+i] += weight*arr[i];
+        }
+        num_members_v[idx]++;
+        weights_v[idx] += weight;
+    }
+
+    void remove_member(const double* arr, const unsigned idx,
+            const double weight) {
+        init_weights(); // A thread may remove before it ever added
+
+        unsigned offset = idx * ncol;
+        for (unsigned i=0; i < ncol; i++) {
+            means[offset+i] -= weight*arr[i];
+        }
+        num_members_v[idx]--;
+        weights_v[idx] -= weight;
+    }
+
+    void swap_membership(const double* arr,
+            const unsigned from_idx, const unsigned to_idx,
+            const double weight) {
+        remove_member(arr, from_idx, weight);
+        add_member(arr, to_idx, weight);
+    }
+
+    const bool is_weighted() const { return !weights_v.empty(); }
+
+    const double get_weight(const unsigned idx) const {
+        return weights_v.empty() ? num_members_v[idx] : weights_v[idx];
+    }
+
     template <typename T>
     void add_member(T& count_it, const unsigned idx) {
         unsigned nid = 0;
@@ -211,6 +211,23 @@ public:
         return std::sqrt(sum);
     }
 
+    // Frobenius norm of (this - other) without materializing the difference
+    T frobenius_diff(dense_matrix& other) {
+        assert(nrow == other.get_nrow() && ncol == other.get_ncol());
+        const T* otherp = other.as_pointer();
+        const size_t nelem = nrow*ncol;
+
+        T sum = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:sum) if (nelem > 4096)
+#endif
+        for (size_t i = 0; i < nelem; i++) {
+            T diff = mat[i] - otherp[i];
+            sum += diff*diff;
+        }
+        return std::sqrt(sum);
+    }
+
     void zero() {
         std::fill(mat.begin(), mat.end(), 0);
     }
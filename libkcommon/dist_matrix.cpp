@@ -18,6 +18,7 @@
  */
 
 #include <cassert>
+#include <algorithm>
 #include <iostream>
 
 #include "dist_matrix.hpp"
@@ -87,14 +88,26 @@ void dist_matrix::print() {
 void dist_matrix::compute_dist(knor::base::prune_clusters::ptr cls,
         const unsigned ncol) {
     if (cls->get_nclust() <= 1) return;
+    compute_dist(cls, ncol, 0, cls->get_nclust());
+#if VERBOSE
+    for (unsigned cl = 0; cl < cls->get_nclust(); cl++) {
+        assert(cls->get_s_val(cl) == get_min_dist(cl));
+#ifndef BIND
+        printf("cl: %u get_s_val: %.6f\n", cl, cls->get_s_val(cl));
+#endif
+    }
+#endif
+}
+
+void dist_matrix::compute_dist(knor::base::prune_clusters::ptr cls,
+        const unsigned ncol, const unsigned begin, const unsigned end) {
+    if (cls->get_nclust() <= 1) return;
 
     assert(get_num_rows() == cls->get_nclust()-1);
-    cls->reset_s_val_v();
-#ifdef _OPENMP
-    //#pragma omp parallel for collapse(2) // FIXME: Opt Coalese perhaps
-#endif
-    for (unsigned i = 0; i < cls->get_nclust(); i++) {
-        for (unsigned j = i+1; j < cls->get_nclust(); j++) {
+    if (begin == 0)
+        cls->reset_s_val_v();
+    for (unsigned i = 0; i < end; i++) {
+        for (unsigned j = std::max(i+1, begin); j < end; j++) {
             double dist = knor::base::eucl_dist(&(cls->get_means()[i*ncol]),
                     &(cls->get_means()[j*ncol]), ncol) / 2.0;
             set(i,j, dist);
@@ -109,14 +122,6 @@ void dist_matrix::compute_dist(knor::base::prune_clusters::ptr cls,
             }
         }
     }
-#if VERBOSE
-    for (unsigned cl = 0; cl < cls->get_nclust(); cl++) {
-        assert(cls->get_s_val(cl) == get_min_dist(cl));
-#ifndef BIND
-        printf("cl: %u get_s_val: %.6f\n", cl, cls->get_s_val(cl));
-#endif
-    }
-#endif
 }
 
 // Used for PAM pairwise distance of all entries
@@ -68,6 +68,10 @@ public:
     void print();
     void compute_dist(std::shared_ptr<base::prune_clusters> cl,
             const unsigned ncol);
+    // Only the pairs (i, j) with i < j and j in [begin, end). Calling it
+    //  for consecutive ranges from 0 covers what compute_dist does.
+    void compute_dist(std::shared_ptr<base::prune_clusters> cl,
+            const unsigned ncol, const unsigned begin, const unsigned end);
     void compute_pairwise_dist(double* data,
             const size_t ncol, const knor::base::dist_t metric);
 };
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dist_tile_cache.hpp"
+
+namespace knor { namespace base {
+
+dist_tile* dist_tile_cache::get(const uint64_t key,
+        const uint64_t row_sig, const uint64_t col_sig) {
+    auto it = tiles.find(key);
+    if (it == tiles.end() || it->second.first.row_sig != row_sig ||
+            it->second.first.col_sig != col_sig) {
+        misses++;
+        return NULL;
+    }
+
+    hits++;
+    // Move to the front of the LRU list
+    lru.splice(lru.begin(), lru, it->second.second);
+    return &(it->second.first);
+}
+
+dist_tile* dist_tile_cache::put(const uint64_t key, const uint64_t row_sig,
+        const uint64_t col_sig, const size_t nrow, const size_t ncol) {
+    const size_t nbytes = sizeof(dist_tile) + (nrow*ncol*sizeof(double)) +
+        nrow;
+    if (nbytes > budget)
+        return NULL;
+
+    // Replace a stale tile at the same key
+    auto it = tiles.find(key);
+    if (it != tiles.end()) {
+        used -= it->second.first.nbytes();
+        lru.erase(it->second.second);
+        tiles.erase(it);
+    }
+
+    while (used + nbytes > budget)
+        evict();
+
+    lru.push_front(key);
+    entry& e = tiles[key];
+    e.second = lru.begin();
+
+    dist_tile& tile = e.first;
+    tile.nrow = nrow;
+    tile.ncol = ncol;
+    tile.row_sig = row_sig;
+    tile.col_sig = col_sig;
+    tile.dists.resize(nrow*ncol);
+    tile.row_done.assign(nrow, 0);
+    used += tile.nbytes();
+    return &tile;
+}
+
+void dist_tile_cache::evict() {
+    auto it = tiles.find(lru.back());
+    used -= it->second.first.nbytes();
+    tiles.erase(it);
+    lru.pop_back();
+    evictions++;
+}
+
+void dist_tile_cache::clear() {
+    tiles.clear();
+    lru.clear();
+    used = 0;
+}
+} } // End namespace knor::base
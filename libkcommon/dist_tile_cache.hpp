@@ -0,0 +1,103 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_DIST_TILE_CACHE_HPP__
+#define __KNOR_DIST_TILE_CACHE_HPP__
+
+#include <memory>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+
+namespace knor { namespace base {
+
+/**
+  * A tile of pairwise distances between two sets of rows. The signatures
+  *  identify the row sets the distances were computed for so a stale tile is
+  *  never served after cluster membership changes. Rows are filled lazily and
+  *  row_done marks the rows that hold distances.
+  */
+struct dist_tile {
+    size_t nrow, ncol;
+    uint64_t row_sig, col_sig;
+    std::vector<double> dists; // row-major nrow x ncol
+    std::vector<char> row_done;
+
+    const size_t nbytes() const {
+        return sizeof(dist_tile) + (dists.capacity()*sizeof(double)) +
+            row_done.capacity();
+    }
+};
+
+/**
+  * Least recently used cache of distance tiles bounded by a memory budget.
+  *  Not thread safe, give each thread its own.
+  */
+class dist_tile_cache {
+private:
+    typedef std::list<uint64_t> lru_list;
+    typedef std::pair<dist_tile, lru_list::iterator> entry;
+
+    std::unordered_map<uint64_t, entry> tiles;
+    lru_list lru; // Most recently used at the front
+    size_t budget; // In bytes
+    size_t used; // In bytes
+    size_t hits, misses, evictions;
+
+    dist_tile_cache(const size_t budget) : budget(budget), used(0),
+        hits(0), misses(0), evictions(0) { }
+
+    void evict();
+
+public:
+    typedef std::shared_ptr<dist_tile_cache> ptr;
+
+    static ptr create(const size_t budget) {
+        return ptr(new dist_tile_cache(budget));
+    }
+
+    // The tile at key if it was computed for these row sets, otherwise NULL
+    dist_tile* get(const uint64_t key, const uint64_t row_sig,
+            const uint64_t col_sig);
+    // Allocate an empty tile at key that the caller fills. Evicts as needed.
+    //  Returns NULL if a tile of this size can never fit in the budget.
+    dist_tile* put(const uint64_t key, const uint64_t row_sig,
+            const uint64_t col_sig, const size_t nrow, const size_t ncol);
+
+    void clear();
+    const size_t get_budget() const { return budget; }
+    const size_t get_used() const { return used; }
+    const size_t get_hits() const { return hits; }
+    const size_t get_misses() const { return misses; }
+    const size_t get_evictions() const { return evictions; }
+    const size_t size() const { return tiles.size(); }
+
+    // FNV-1a signature of a set of row ids
+    static uint64_t signature(const unsigned* rids, const size_t nrids) {
+        uint64_t sig = 14695981039346656037ULL;
+        for (size_t i = 0; i < nrids; i++) {
+            sig ^= rids[i];
+            sig *= 1099511628211ULL;
+        }
+        return sig ^ nrids;
+    }
+};
+} } // End namespace knor::base
+#endif
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include "hcluster_arena.hpp"
+#include "exception.hpp"
+#include "io.hpp"
+
+namespace knor { namespace base {
+
+void h_accumulator::reset(const size_t nslots, const size_t ncol) {
+    if (sums.size() < nslots*2*ncol) {
+        sums.resize(nslots*2*ncol);
+        nmembers.resize(nslots*2);
+        nchanged.resize(nslots);
+    }
+    std::fill(sums.begin(), sums.begin() + (nslots*2*ncol), 0);
+    std::fill(nmembers.begin(), nmembers.begin() + (nslots*2), 0);
+    std::fill(nchanged.begin(), nchanged.begin() + nslots, 0);
+}
+
+hcluster_arena::hcluster_arena(const size_t capacity, const size_t ncol) :
+    capacity(capacity), ncol(ncol), nkeys(0), metadata_size(0) {
+    means.assign(capacity*2*ncol, 0);
+    nmembers.assign(capacity*2, 0);
+    zeroids.assign(capacity, INVALID_CLUSTER_ID);
+    oneids.assign(capacity, INVALID_CLUSTER_ID);
+    present.assign(capacity, false);
+    converged.assign(capacity, false);
+    slots.assign(capacity, INVALID_CLUSTER_ID);
+}
+
+void hcluster_arena::add(const unsigned id, const unsigned zeroid,
+        const unsigned oneid) {
+    if (id >= capacity)
+        throw oob_exception("hcluster_arena::add");
+
+    if (!present[id])
+        nkeys++;
+    present[id] = true;
+    converged[id] = false;
+    zeroids[id] = zeroid;
+    oneids[id] = oneid;
+    std::fill(&means[id*2*ncol], &means[(id+1)*2*ncol], 0);
+    nmembers[id*2] = nmembers[(id*2)+1] = 0;
+}
+
+void hcluster_arena::erase(const unsigned id) {
+    if (has_key(id)) {
+        present[id] = false;
+        nkeys--;
+    }
+}
+
+void hcluster_arena::get_keys(std::vector<size_t>& ids) const {
+    for (size_t id = 0; id < capacity; id++)
+        if (present[id])
+            ids.push_back(id);
+}
+
+void hcluster_arena::set_mean(const unsigned id, const unsigned child,
+        const double* mean) {
+    std::copy(mean, mean + ncol, &means[((id*2) + child)*ncol]);
+}
+
+void hcluster_arena::set_metadata_size(const size_t size) {
+    if (metadata_size != size) {
+        metadata_size = size;
+        metadata.assign(capacity*size, 0);
+    }
+}
+
+void hcluster_arena::assign_slots() {
+    slot_ids.clear();
+    for (unsigned id = 0; id < capacity; id++) {
+        if (present[id] && !converged[id]) {
+            slots[id] = slot_ids.size();
+            slot_ids.push_back(id);
+        } else {
+            slots[id] = INVALID_CLUSTER_ID;
+        }
+    }
+}
+
+void hcluster_arena::reduce(const std::vector<const h_accumulator*>& accs) {
+    const size_t block = 2*ncol;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t slot = 0; slot < slot_ids.size(); slot++) {
+        const unsigned id = slot_ids[slot];
+        double* mean = &means[id*block];
+        llong_t* count = &nmembers[id*2];
+
+        std::fill(mean, mean + block, 0);
+        count[0] = count[1] = 0;
+        for (auto const& acc : accs) {
+            const double* sum = &(acc->sums[slot*block]);
+            for (size_t i = 0; i < block; i++)
+                mean[i] += sum[i];
+            count[0] += acc->nmembers[slot*2];
+            count[1] += acc->nmembers[(slot*2)+1];
+        }
+
+        for (unsigned child = 0; child < 2; child++) {
+            if (count[child] > 1) { // Less than 2 is the same result
+                for (size_t col = 0; col < ncol; col++)
+                    mean[(child*ncol)+col] /= double(count[child]);
+            }
+        }
+    }
+}
+
+const void hcluster_arena::print(const unsigned id) const {
+#ifndef BIND
+    for (unsigned child = 0; child < 2; child++) {
+        std::cout << "#memb = " << get_num_members(id, child) << " ";
+        base::print<double>(get_mean(id, child), ncol);
+    }
+    printf("Mean 0 ID: %u\n", zeroids[id]);
+    printf("Mean 1 ID: %u\n", oneids[id]);
+#endif
+}
+} } // End namespace knor::base
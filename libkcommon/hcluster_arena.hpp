@@ -0,0 +1,150 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_HCLUSTER_ARENA_HPP__
+#define __KNOR_HCLUSTER_ARENA_HPP__
+
+#include <memory>
+#include <vector>
+
+#include "types.hpp"
+
+namespace knor { namespace base {
+
+/**
+  * One thread's sums for the nodes of a hcluster_arena that are still
+  *  iterating. Indexed by the arena's slot numbering so the block is
+  *  contiguous and only as large as the number of iterating nodes.
+  */
+struct h_accumulator {
+    std::vector<double> sums; // nslots x 2 x ncol
+    std::vector<llong_t> nmembers; // nslots x 2
+    std::vector<unsigned> nchanged; // nslots
+
+    // Zero for nslots nodes. Storage is only ever grown.
+    void reset(const size_t nslots, const size_t ncol);
+
+    void add_member(const double* row, const unsigned slot,
+            const unsigned child, const size_t ncol) {
+        double* sum = &sums[((slot*2) + child)*ncol];
+        for (size_t col = 0; col < ncol; col++)
+            sum[col] += row[col];
+        nmembers[(slot*2) + child]++;
+    }
+};
+
+/**
+  * Flat store of the two child centroids of each node of the cluster
+  *  hierarchy, indexed by node id. Storage is allocated once for the
+  *  maximum number of nodes and reused as nodes are added and erased.
+  */
+class hcluster_arena {
+private:
+    size_t capacity, ncol;
+    std::vector<double> means; // capacity x 2 x ncol
+    std::vector<llong_t> nmembers; // capacity x 2
+    std::vector<unsigned> zeroids, oneids;
+    std::vector<char> present, converged;
+    size_t nkeys;
+
+    // Per node wildcard data, allocated on first use
+    std::vector<double> metadata;
+    size_t metadata_size;
+
+    // Present nodes that haven't converged, numbered densely
+    std::vector<unsigned> slot_ids;
+    std::vector<unsigned> slots; // id -> slot
+
+    hcluster_arena(const size_t capacity, const size_t ncol);
+
+public:
+    typedef std::shared_ptr<hcluster_arena> ptr;
+
+    static ptr create(const size_t capacity, const size_t ncol) {
+        return ptr(new hcluster_arena(capacity, ncol));
+    }
+
+    // Zero the node's centroids and counts and mark it as iterating
+    void add(const unsigned id, const unsigned zeroid=INVALID_CLUSTER_ID,
+            const unsigned oneid=INVALID_CLUSTER_ID);
+    void erase(const unsigned id);
+
+    const bool has_key(const unsigned id) const {
+        return id < capacity && present[id];
+    }
+    // Ascending order
+    void get_keys(std::vector<size_t>& ids) const;
+    const size_t keycount() const { return nkeys; }
+    const bool keyless() const { return !nkeys; }
+    const size_t get_capacity() const { return capacity; }
+    const size_t get_ncol() const { return ncol; }
+
+    void set_zeroid(const unsigned id, const unsigned zeroid) {
+        zeroids[id] = zeroid;
+    }
+    void set_oneid(const unsigned id, const unsigned oneid) {
+        oneids[id] = oneid;
+    }
+    const unsigned get_zeroid(const unsigned id) const { return zeroids[id]; }
+    const unsigned get_oneid(const unsigned id) const { return oneids[id]; }
+
+    void set_converged(const unsigned id, const bool status=true) {
+        converged[id] = status;
+    }
+    const bool has_converged(const unsigned id) const {
+        return converged[id];
+    }
+
+    // Both child centroids of a node are adjacent
+    const double* get_means(const unsigned id) const {
+        return &means[id*2*ncol];
+    }
+    const double* get_mean(const unsigned id, const unsigned child) const {
+        return &means[((id*2) + child)*ncol];
+    }
+    void set_mean(const unsigned id, const unsigned child, const double* mean);
+    const llong_t get_num_members(const unsigned id,
+            const unsigned child) const {
+        return nmembers[(id*2) + child];
+    }
+
+    void set_metadata_size(const size_t size);
+    double* get_metadata(const unsigned id) {
+        return &metadata[id*metadata_size];
+    }
+    const double* get_metadata(const unsigned id) const {
+        return &metadata[id*metadata_size];
+    }
+
+    // Number the iterating nodes. Call before threads accumulate.
+    void assign_slots();
+    const size_t nslots() const { return slot_ids.size(); }
+    const unsigned get_slot(const unsigned id) const { return slots[id]; }
+    const unsigned get_slot_id(const unsigned slot) const {
+        return slot_ids[slot];
+    }
+
+    // The centroids of each slotted node become the means of the members
+    //  summed by the threads. Parallel over nodes.
+    void reduce(const std::vector<const h_accumulator*>& accs);
+
+    const void print(const unsigned id) const;
+};
+} } // End namespace knor::base
+#endif
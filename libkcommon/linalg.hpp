@@ -20,16 +20,18 @@
 #ifndef __KNOR_LINALG_HPP__
 #define __KNOR_LINALG_HPP__
 
-// Adapted from: https://www.geeksforgeeks.org/adjoint-inverse-matrix/
+// Adjoint adapted from: https://www.geeksforgeeks.org/adjoint-inverse-matrix/
 
+#include <cmath>
 #include <numeric>
+#include <algorithm>
 #include "dense_matrix.hpp"
 
 namespace knor { namespace base {
 
     class linalg {
         public:
-        static void getCofactor(double* A, double* temp,
+        static void getCofactor(const double* A, double* temp,
                 double p, size_t q, double n, const size_t N) {
             size_t i = 0, j = 0;
 
@@ -59,27 +61,35 @@ namespace knor { namespace base {
             }
         }
 
-        /* Recursive function for finding determinant of matrix.
-           n is current dimension of A[][]. */
-        static double determinant(double* A, size_t n, const size_t N) {
-            double D = 0; // Initialize result
-
-            // Base case : if matrix contains single element
-            if (n == 1)
-                return A[0];
-
-            std::vector<double> temp(N*N); // To store cofactors
-
-            double sign = 1; // To store sign multiplier
-
-            // Iterate for each element of first row
-            for (size_t f = 0; f < n; f++) {
-                // Getting Cofactor of A[0][f]
-                getCofactor(A, &temp[0], 0, f, n, N);
-                D += sign * A[f] * determinant(&temp[0], n - 1, N);
+        /* Determinant via an LU decomposition with partial pivoting.
+           n is current dimension of A[][] and N is its row stride. */
+        static double determinant(const double* A, size_t n, const size_t N) {
+            std::vector<double> lu(n*n);
+            for (size_t row = 0; row < n; row++)
+                std::copy(&A[row*N], &A[row*N]+n, &lu[row*n]);
+
+            double D = 1;
+            for (size_t col = 0; col < n; col++) {
+                // Choose the largest pivot in this column for stability
+                size_t piv = col;
+                for (size_t row = col+1; row < n; row++)
+                    if (std::abs(lu[row*n+col]) > std::abs(lu[piv*n+col]))
+                        piv = row;
+
+                if (lu[piv*n+col] == 0)
+                    return 0; // Singular
+
+                if (piv != col) {
+                    std::swap_ranges(&lu[piv*n], &lu[piv*n]+n, &lu[col*n]);
+                    D = -D;
+                }
 
-                // terms are to be added with alternate sign
-                sign = -sign;
+                D *= lu[col*n+col];
+                for (size_t row = col+1; row < n; row++) {
+                    double factor = lu[row*n+col] / lu[col*n+col];
+                    for (size_t j = col+1; j < n; j++)
+                        lu[row*n+j] -= factor*lu[col*n+j];
+                }
             }
 
             return D;
@@ -119,27 +129,125 @@ namespace knor { namespace base {
         }
 
         // Function to calculate and store inverse, returns false if
-        // matrix is singular
-        static bool inverse(double* A, double* inverse, const size_t N) {
-            // Find determinant of A[][]
-            double det = determinant(A, N, N);
-            if (det == 0) {
-                printf("Singular matrix, can't find its inverse\n");
-                return false;
-            }
+        // matrix is singular. Gauss-Jordan elimination with partial pivoting.
+        static bool inverse(const double* A, double* inverse, const size_t N) {
+            std::vector<double> tmp(A, A+(N*N));
+
+            // Start from the identity
+            std::fill(inverse, inverse+(N*N), 0);
+            for (size_t i = 0; i < N; i++)
+                inverse[i*N+i] = 1;
+
+            for (size_t col = 0; col < N; col++) {
+                size_t piv = col;
+                for (size_t row = col+1; row < N; row++)
+                    if (std::abs(tmp[row*N+col]) > std::abs(tmp[piv*N+col]))
+                        piv = row;
+
+                if (tmp[piv*N+col] == 0) {
+#ifndef BIND
+                    printf("Singular matrix, can't find its inverse\n");
+#endif
+                    return false;
+                }
 
-            // Find adjoint
-            std::vector<double> adj(N*N);
-            adjoint(A, &adj[0], N);
+                if (piv != col) {
+                    std::swap_ranges(&tmp[piv*N], &tmp[piv*N]+N, &tmp[col*N]);
+                    std::swap_ranges(&inverse[piv*N], &inverse[piv*N]+N,
+                            &inverse[col*N]);
+                }
+
+                double div = tmp[col*N+col];
+                for (size_t j = 0; j < N; j++) {
+                    tmp[col*N+j] /= div;
+                    inverse[col*N+j] /= div;
+                }
 
-            // Find Inverse using formula "inverse(A) = adj(A)/det(A)"
-            for (size_t i=0; i<N; i++)
-                for (size_t j=0; j<N; j++)
-                    inverse[i*N+j] = adj[i*N+j]/det;
+                for (size_t row = 0; row < N; row++) {
+                    if (row == col || tmp[row*N+col] == 0)
+                        continue;
+
+                    double factor = tmp[row*N+col];
+                    for (size_t j = 0; j < N; j++) {
+                        tmp[row*N+j] -= factor*tmp[col*N+j];
+                        inverse[row*N+j] -= factor*inverse[col*N+j];
+                    }
+                }
+            }
 
             return true;
         }
 
+        /**
+          * Cholesky decomposition A = LL^T of a symmetric positive definite
+          *     matrix. Only the lower triangle of A is read and the upper
+          *     triangle of L is zeroed.
+          * \return false if A is not (numerically) positive definite.
+          */
+        static bool cholesky(const double* A, double* L, const size_t N) {
+            for (size_t row = 0; row < N; row++) {
+                for (size_t col = 0; col <= row; col++) {
+                    double sum = A[row*N+col];
+                    for (size_t i = 0; i < col; i++)
+                        sum -= L[row*N+i]*L[col*N+i];
+
+                    if (row == col) {
+                        if (sum <= 0 || std::isnan(sum))
+                            return false;
+                        L[row*N+col] = std::sqrt(sum);
+                    } else {
+                        L[row*N+col] = sum / L[col*N+col];
+                    }
+                }
+                std::fill(&L[row*N+row+1], &L[(row+1)*N], 0);
+            }
+            return true;
+        }
+
+        // log(det(A)) given the Cholesky factor L of A
+        static double chol_logdet(const double* L, const size_t N) {
+            double logdet = 0;
+            for (size_t i = 0; i < N; i++)
+                logdet += std::log(L[i*N+i]);
+            return 2*logdet;
+        }
+
+        // Solve Ly = b for lower triangular L. `y' may alias `b'
+        static void forward_sub(const double* L, const double* b,
+                double* y, const size_t N) {
+            for (size_t row = 0; row < N; row++) {
+                double sum = b[row];
+                for (size_t col = 0; col < row; col++)
+                    sum -= L[row*N+col]*y[col];
+                y[row] = sum / L[row*N+row];
+            }
+        }
+
+        // Solve L^Tx = y for lower triangular L. `x' may alias `y'
+        static void backward_sub(const double* L, const double* y,
+                double* x, const size_t N) {
+            for (size_t row = N; row-- > 0; ) {
+                double sum = y[row];
+                for (size_t col = row+1; col < N; col++)
+                    sum -= L[col*N+row]*x[col];
+                x[row] = sum / L[row*N+row];
+            }
+        }
+
+        // inverse(A) given the Cholesky factor L of A
+        static void chol_inverse(const double* L, double* inverse,
+                const size_t N) {
+            std::vector<double> col(N);
+            for (size_t j = 0; j < N; j++) {
+                std::fill(col.begin(), col.end(), 0);
+                col[j] = 1;
+                forward_sub(L, &col[0], &col[0], N);
+                backward_sub(L, &col[0], &col[0], N);
+                for (size_t i = 0; i < N; i++)
+                    inverse[i*N+j] = col[i];
+            }
+        }
+
         static void vdiff(const double* left, const double* right,
                 const size_t size, std::vector<double>& res) {
             if (!res.size()) res.resize(size);
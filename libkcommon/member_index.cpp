@@ -0,0 +1,94 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "member_index.hpp"
+
+namespace knor { namespace base {
+
+void member_index::build(const unsigned* assignments, const size_t nrow,
+        const size_t nclust) {
+#ifdef _OPENMP
+    const int nthreads = std::max(1, std::min(omp_get_max_threads(),
+                static_cast<int>(nrow / 4096) + 1));
+#else
+    const int nthreads = 1;
+#endif
+    offsets.assign(nclust+1, 0);
+    rids.resize(nrow);
+    thd_counts.assign(nthreads*nclust, 0);
+
+    // Each thread owns a contiguous block of rows so the scatter keeps rows
+    //  in ascending order within a cluster
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        // The runtime may grant fewer threads than requested
+#ifdef _OPENMP
+        const int tid = omp_get_thread_num();
+        const int nthds = omp_get_num_threads();
+#else
+        const int tid = 0;
+        const int nthds = 1;
+#endif
+        const size_t start = (nrow*tid) / nthds;
+        const size_t stop = (nrow*(tid+1)) / nthds;
+        size_t* counts = &thd_counts[tid*nclust];
+
+        for (size_t rid = start; rid < stop; rid++)
+            if (assignments[rid] < nclust)
+                counts[assignments[rid]]++;
+
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp for
+#endif
+        for (size_t cid = 0; cid < nclust; cid++) {
+            size_t tot = 0;
+            for (int t = 0; t < nthds; t++) {
+                size_t cnt = thd_counts[t*nclust + cid];
+                thd_counts[t*nclust + cid] = tot; // Offset within cluster
+                tot += cnt;
+            }
+            offsets[cid+1] = tot;
+        }
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+        {
+            for (size_t cid = 0; cid < nclust; cid++)
+                offsets[cid+1] += offsets[cid];
+            rids.resize(offsets[nclust]);
+        }
+
+        for (size_t rid = start; rid < stop; rid++) {
+            const unsigned cid = assignments[rid];
+            if (cid < nclust)
+                rids[offsets[cid] + counts[cid]++] = rid;
+        }
+    }
+}
+} } // End namespace knor::base
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_MEMBER_INDEX_HPP__
+#define __KNOR_MEMBER_INDEX_HPP__
+
+#include <memory>
+#include <vector>
+
+namespace knor { namespace base {
+
+/**
+  * Compact (CSR) list of the rows assigned to each cluster. Rows within a
+  *  cluster are kept in ascending order so walks over a cluster are
+  *  deterministic. Rows assigned to ids >= nclust are left out.
+  */
+class member_index {
+private:
+    std::vector<size_t> offsets; // nclust + 1
+    std::vector<unsigned> rids; // Rows grouped by cluster
+    std::vector<size_t> thd_counts; // Per-thread counts reused across builds
+
+    member_index() { }
+
+public:
+    typedef std::shared_ptr<member_index> ptr;
+
+    static ptr create() {
+        return ptr(new member_index());
+    }
+
+    // Rebuild from assignments in parallel, O(nrow + nthreads*nclust)
+    void build(const unsigned* assignments, const size_t nrow,
+            const size_t nclust);
+
+    const size_t get_nclust() const {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    // Rows in the index, all clusters together
+    const size_t nmembers() const { return rids.size(); }
+
+    // Flat list of rows, cid's members start at offset(cid)
+    const unsigned* data() const { return &rids[0]; }
+    const size_t offset(const unsigned cid) const { return offsets[cid]; }
+
+    const size_t size(const unsigned cid) const {
+        return cid < get_nclust() ? offsets[cid+1] - offsets[cid] : 0;
+    }
+
+    const unsigned* begin(const unsigned cid) const {
+        return &rids[0] + offsets[cid];
+    }
+
+    const unsigned* end(const unsigned cid) const {
+        return &rids[0] + offsets[cid+1];
+    }
+
+    const unsigned get(const unsigned cid, const size_t idx) const {
+        return rids[offsets[cid] + idx];
+    }
+};
+} } // End namespace knor::base
+#endif
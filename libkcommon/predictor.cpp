@@ -0,0 +1,290 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <algorithm>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "predictor.hpp"
+#include "exception.hpp"
+#include "util.hpp"
+
+namespace knor { namespace base {
+
+// Bytes of centroids a tile keeps hot, about half a typical L1
+static const size_t CENT_TILE_BYTES = 16*1024;
+static const size_t ROW_TILE = 64;
+static const size_t KERNEL_ROWS = 4;
+
+predictor::predictor(const double* means, const size_t k,
+        const size_t ncol, const dist_t dt) : k(k), ncol(ncol), dt(dt),
+    ef_search(0) {
+    if (!k || !ncol)
+        throw parameter_exception("predictor needs k > 0 and ncol > 0");
+
+    this->means.assign(means, means + (k*ncol));
+    if (is_eucl()) {
+        means_t.resize(k*ncol);
+        mean_norms.assign(k, 0);
+        for (size_t c = 0; c < k; c++) {
+            for (size_t col = 0; col < ncol; col++) {
+                const double v = means[c*ncol+col];
+                means_t[col*k+c] = v;
+                mean_norms[c] += v*v;
+            }
+        }
+    }
+
+    set_tiles(ROW_TILE, CENT_TILE_BYTES / (ncol*sizeof(double)));
+}
+
+void predictor::set_tiles(const size_t row_tile, const size_t cent_tile) {
+    this->row_tile = std::max(row_tile, (size_t)1);
+    this->cent_tile = std::min(std::max(cent_tile, (size_t)8), k);
+}
+
+void predictor::build_index(const unsigned degree,
+        const unsigned ef_search, const unsigned ef_construction) {
+    if (!degree) {
+        graph = nullptr;
+        entries.clear();
+        return;
+    }
+    if (!is_eucl())
+        throw parameter_exception(
+                "A centroid index is only supported for Euclidean distance");
+
+    graph = centroid_graph::create(degree, ef_construction, dt);
+    graph->build(&means[0], k, ncol);
+    this->ef_search = ef_search;
+
+    // Searches start at the nearest of ~sqrt(k) spread out centroids
+    //  rather than one fixed node, which is all a single layer offers
+    const size_t nentry = std::max((size_t)1,
+            (size_t)std::ceil(std::sqrt((double)k)));
+    entries.clear();
+    for (size_t i = 0; i < nentry; i++)
+        entries.push_back(static_cast<unsigned>((i*k) / nentry));
+}
+
+void predictor::predict_tile(const double* rows, const size_t nrow,
+        unsigned* asgn, double* dists, std::vector<double>& acc) const {
+    double best[ROW_TILE];
+    std::vector<double> spill;
+    double* best_dist = best;
+    if (nrow > ROW_TILE) {
+        spill.resize(nrow);
+        best_dist = &spill[0];
+    }
+    std::fill(best_dist, best_dist + nrow,
+            std::numeric_limits<double>::max());
+
+    for (size_t cstart = 0; cstart < k; cstart += cent_tile) {
+        const size_t nc = std::min(cent_tile, k - cstart);
+
+        if (is_eucl()) {
+            // ||x||^2 is the same for every centroid so argmin only needs
+            //  ||c||^2 - 2x.c. Rows go KERNEL_ROWS at a time so each load
+            //  of a centroid value feeds that many accumulators.
+            for (size_t r = 0; r < nrow; r += KERNEL_ROWS) {
+                const size_t nr = std::min(KERNEL_ROWS, nrow - r);
+                std::fill(acc.begin(), acc.begin() + (nr*nc), 0);
+
+                if (nr == KERNEL_ROWS) {
+                    double* a0 = &acc[0];
+                    double* a1 = a0 + nc;
+                    double* a2 = a1 + nc;
+                    double* a3 = a2 + nc;
+                    const double* x = &rows[r*ncol];
+                    for (size_t col = 0; col < ncol; col++) {
+                        const double v0 = x[col];
+                        const double v1 = x[ncol+col];
+                        const double v2 = x[2*ncol+col];
+                        const double v3 = x[3*ncol+col];
+                        const double* ct = &means_t[col*k + cstart];
+                        for (size_t c = 0; c < nc; c++) {
+                            a0[c] += v0*ct[c];
+                            a1[c] += v1*ct[c];
+                            a2[c] += v2*ct[c];
+                            a3[c] += v3*ct[c];
+                        }
+                    }
+                } else {
+                    for (size_t i = 0; i < nr; i++) {
+                        double* a = &acc[i*nc];
+                        const double* x = &rows[(r+i)*ncol];
+                        for (size_t col = 0; col < ncol; col++) {
+                            const double* ct = &means_t[col*k + cstart];
+                            for (size_t c = 0; c < nc; c++)
+                                a[c] += x[col]*ct[c];
+                        }
+                    }
+                }
+
+                for (size_t i = 0; i < nr; i++) {
+                    const double* a = &acc[i*nc];
+                    for (size_t c = 0; c < nc; c++) {
+                        const double d = mean_norms[cstart+c] - (2*a[c]);
+                        if (d < best_dist[r+i]) {
+                            best_dist[r+i] = d;
+                            asgn[r+i] = cstart + c;
+                        }
+                    }
+                }
+            }
+        } else {
+            for (size_t r = 0; r < nrow; r++) {
+                for (size_t c = cstart; c < cstart + nc; c++) {
+                    const double d = dist_comp_raw<double>(&rows[r*ncol],
+                            &means[c*ncol], ncol, dt);
+                    if (d < best_dist[r]) {
+                        best_dist[r] = d;
+                        asgn[r] = c;
+                    }
+                }
+            }
+        }
+    }
+
+    if (dists) {
+        for (size_t r = 0; r < nrow; r++)
+            dists[r] = is_eucl() ? dist_comp_raw<double>(&rows[r*ncol],
+                    &means[asgn[r]*ncol], ncol, dt) : best_dist[r];
+    }
+}
+
+void predictor::predict_index(const double* rows, const size_t nrow,
+        unsigned* asgn, double* dists,
+        centroid_graph::visit_list& vl) const {
+    for (size_t r = 0; r < nrow; r++) {
+        const double* row = &rows[r*ncol];
+
+        unsigned start = entries[0];
+        double start_dist = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < entries.size(); i++) {
+            const double d = dist_comp_raw<double>(row,
+                    &means[entries[i]*ncol], ncol, dt);
+            if (d < start_dist) {
+                start_dist = d;
+                start = entries[i];
+            }
+        }
+
+        double best_dist;
+        asgn[r] = graph->search(row, start, ef_search, best_dist, vl);
+        if (dists)
+            dists[r] = best_dist;
+    }
+}
+
+void predictor::predict(const double* rows, const size_t nrow,
+        unsigned* asgn, double* dists) const {
+    const size_t ntiles = (nrow + row_tile - 1) / row_tile;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        std::vector<double> acc(KERNEL_ROWS*cent_tile);
+        centroid_graph::visit_list vl;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (size_t tile = 0; tile < ntiles; tile++) {
+            const size_t first = tile*row_tile;
+            const size_t len = std::min(row_tile, nrow - first);
+            double* tile_dists = dists ? &dists[first] : NULL;
+
+            if (graph)
+                predict_index(&rows[first*ncol], len, &asgn[first],
+                        tile_dists, vl);
+            else
+                predict_tile(&rows[first*ncol], len, &asgn[first],
+                        tile_dists, acc);
+        }
+    }
+}
+
+size_t predictor::predict(const std::string fn, const size_t nrow,
+        const size_t block_nrow, block_fn fn_block) const {
+    if (!block_nrow)
+        throw parameter_exception("predictor block_nrow must be > 0");
+    if (filesize(fn.c_str()) < nrow*ncol*sizeof(double))
+        throw io_exception("File is smaller than nrow x ncol doubles");
+
+    FILE* f = fopen(fn.c_str(), "rb");
+    if (!f)
+        throw io_exception("Cannot open " + fn);
+
+    // The next block is read while the current one is assigned
+    std::vector<double> blocks[2];
+    std::vector<unsigned> asgn(std::min(block_nrow, nrow));
+    std::vector<double> dists(asgn.size());
+    auto read_block = [&](const unsigned buf, const size_t len) {
+        blocks[buf].resize(len*ncol);
+        return fread(&blocks[buf][0], sizeof(double)*ncol, len, f) == len;
+    };
+
+    unsigned cur = 0;
+    bool ok = nrow ? read_block(cur, asgn.size()) : true;
+    size_t first = 0;
+    while (ok && first < nrow) {
+        const size_t len = std::min(block_nrow, nrow - first);
+        const size_t next_len = std::min(block_nrow, nrow - (first + len));
+
+        bool next_ok = true;
+        std::thread reader;
+        if (next_len)
+            reader = std::thread([&] {
+                    next_ok = read_block(1 - cur, next_len); });
+
+        predict(&blocks[cur][0], len, &asgn[0], &dists[0]);
+        fn_block(first, len, &asgn[0], &dists[0]);
+
+        if (reader.joinable())
+            reader.join();
+        ok = next_ok;
+        first += len;
+        cur = 1 - cur;
+    }
+    fclose(f);
+
+    if (!ok)
+        throw io_exception("Short read from " + fn);
+    return first;
+}
+
+size_t predictor::predict(const std::string fn, const size_t nrow,
+        const size_t block_nrow, unsigned* asgn, double* dists) const {
+    return predict(fn, nrow, block_nrow,
+            [&](const size_t first, const size_t len,
+                const unsigned* block_asgn, const double* block_dists) {
+            std::copy(block_asgn, block_asgn + len, &asgn[first]);
+            if (dists)
+                std::copy(block_dists, block_dists + len, &dists[first]);
+            });
+}
+} } // End namespace knor::base
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_PREDICTOR_HPP__
+#define __KNOR_PREDICTOR_HPP__
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "types.hpp"
+#include "centroid_graph.hpp"
+
+namespace knor { namespace base {
+
+/**
+  * Assigns new rows to a fixed set of trained centroids without any of the
+  *  EM machinery. Rows are processed in tiles against cache sized blocks of
+  *  centroids. For Euclidean distances the block kernel expands
+  *  ||x - c||^2 = ||x||^2 - 2x.c + ||c||^2 over transposed centroids so the
+  *  inner loop runs across centroids and vectorizes; the winner's distance
+  *  is then recomputed directly. A centroid_graph index can replace the
+  *  exhaustive scan when k is large.
+  */
+class predictor {
+public:
+    typedef std::shared_ptr<predictor> ptr;
+    // Called with (first row, nrow, assignments, distances) of every block
+    typedef std::function<void(const size_t, const size_t,
+            const unsigned*, const double*)> block_fn;
+
+private:
+    const size_t k, ncol;
+    const dist_t dt;
+    std::vector<double> means; // k x ncol
+    std::vector<double> means_t; // ncol x k, Euclidean only
+    std::vector<double> mean_norms; // ||c||^2, Euclidean only
+    size_t row_tile, cent_tile;
+
+    centroid_graph::ptr graph;
+    unsigned ef_search;
+    std::vector<unsigned> entries; // Evenly spaced nodes to start from
+
+    predictor(const double* means, const size_t k, const size_t ncol,
+            const dist_t dt);
+
+    const bool is_eucl() const { return dt == EUCL || dt == SQEUCL; }
+    // Exhaustive scan of one tile of rows
+    void predict_tile(const double* rows, const size_t nrow,
+            unsigned* asgn, double* dists, std::vector<double>& acc) const;
+    void predict_index(const double* rows, const size_t nrow,
+            unsigned* asgn, double* dists,
+            centroid_graph::visit_list& vl) const;
+
+public:
+    static ptr create(const double* means, const size_t k,
+            const size_t ncol, const dist_t dt=dist_t::EUCL) {
+        return ptr(new predictor(means, k, ncol, dt));
+    }
+
+    /**
+      * Search a centroid graph instead of scanning every centroid. Only for
+      *  Euclidean distances; results are approximate.
+      * \param degree the graph degree, 0 drops the index.
+      * \param ef_search the beam width of every search.
+      */
+    void build_index(const unsigned degree, const unsigned ef_search=32,
+            const unsigned ef_construction=64);
+    const bool has_index() const { return graph != nullptr; }
+
+    /**
+      * Assign nrow x ncol rows in parallel.
+      * \param asgn set to the nearest centroid of every row.
+      * \param dists if not NULL set to the distance to it.
+      */
+    void predict(const double* rows, const size_t nrow, unsigned* asgn,
+            double* dists=NULL) const;
+
+    /**
+      * Stream a row major binary file through in blocks of block_nrow rows,
+      *  handing each block's results to fn. Two blocks are
+      *  resident: the next is read while the current one is assigned.
+      * \return the number of rows assigned.
+      */
+    size_t predict(const std::string fn, const size_t nrow,
+            const size_t block_nrow, block_fn fn_block) const;
+    // Stream a file into nrow assignments (and distances if not NULL)
+    size_t predict(const std::string fn, const size_t nrow,
+            const size_t block_nrow, unsigned* asgn,
+            double* dists=NULL) const;
+
+    // Override the tile shape picked from ncol (mostly for benchmarking)
+    void set_tiles(const size_t row_tile, const size_t cent_tile);
+
+    const size_t get_nclust() const { return k; }
+    const size_t get_ncol() const { return ncol; }
+    const size_t get_row_tile() const { return row_tile; }
+    const size_t get_cent_tile() const { return cent_tile; }
+};
+} } // End namespace knor::base
+#endif
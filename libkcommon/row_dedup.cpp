@@ -0,0 +1,139 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+
+#include "row_dedup.hpp"
+#include "member_index.hpp"
+#include "util.hpp"
+
+namespace knor { namespace base {
+
+// FNV-1a over the bytes of a row, so equal hashes follow bitwise equality
+static uint64_t hash_row(const double* row, const size_t ncol) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(row);
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < ncol*sizeof(double); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+row_dedup::row_dedup(const double* data, const size_t nrow,
+        const size_t ncol) : nrow(nrow), ncol(ncol) {
+    const size_t nbytes = ncol*sizeof(double);
+    const unsigned nshards = get_num_omp_threads()*8;
+
+    // Hash every row and shard rows by hash
+    std::vector<uint64_t> hashes(nrow);
+    std::vector<unsigned> shards(nrow);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t row = 0; row < nrow; row++) {
+        hashes[row] = hash_row(&data[row*ncol], ncol);
+        shards[row] = hashes[row] % nshards;
+    }
+
+    member_index::ptr shard_index = member_index::create();
+    shard_index->build(&shards[0], nrow, nshards);
+    std::vector<unsigned>().swap(shards);
+
+    // Within a shard every row is compared against the first occurrences
+    //  with the same hash. Rows are walked in ascending order so a row's
+    //  representative always precedes it.
+    std::vector<unsigned> rep_of(nrow);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (unsigned shard = 0; shard < nshards; shard++) {
+        std::unordered_map<uint64_t, std::vector<unsigned> > reps;
+        for (const unsigned* it = shard_index->begin(shard);
+                it != shard_index->end(shard); ++it) {
+            const unsigned row = *it;
+            std::vector<unsigned>& cands = reps[hashes[row]];
+
+            rep_of[row] = row;
+            for (size_t i = 0; i < cands.size(); i++) {
+                if (!std::memcmp(&data[row*ncol], &data[cands[i]*ncol],
+                            nbytes)) {
+                    rep_of[row] = cands[i];
+                    break;
+                }
+            }
+            if (rep_of[row] == row)
+                cands.push_back(row);
+        }
+    }
+
+    // Number the unique rows by first occurrence
+    row_map.resize(nrow);
+    std::vector<unsigned> uniq_rows;
+    for (size_t row = 0; row < nrow; row++) {
+        if (rep_of[row] == row) {
+            row_map[row] = uniq_rows.size();
+            uniq_rows.push_back(row);
+            weights.push_back(1);
+        } else {
+            row_map[row] = row_map[rep_of[row]];
+            weights[row_map[row]]++;
+        }
+    }
+
+    this->data.resize(uniq_rows.size()*ncol);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t uid = 0; uid < uniq_rows.size(); uid++)
+        std::copy(&data[uniq_rows[uid]*ncol], &data[(uniq_rows[uid]+1)*ncol],
+                &this->data[uid*ncol]);
+
+#ifndef BIND
+    printf("Collapsed %lu rows into %lu unique rows\n", nrow,
+            uniq_rows.size());
+#endif
+}
+
+void row_dedup::expand(const unsigned* uniq_assignments,
+        unsigned* assignments) const {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t row = 0; row < nrow; row++)
+        assignments[row] = uniq_assignments[row_map[row]];
+}
+
+cluster_t row_dedup::expand(const cluster_t& uniq) const {
+    cluster_t ret;
+    ret.set_params(nrow, ncol, uniq.iters, uniq.k);
+    ret.centroids = uniq.centroids;
+    ret.assignments.resize(nrow);
+    expand(&uniq.assignments[0], &ret.assignments[0]);
+
+    ret.assignment_count.assign(uniq.k, 0);
+    for (size_t uid = 0; uid < weights.size(); uid++) {
+        if (uniq.assignments[uid] < uniq.k)
+            ret.assignment_count[uniq.assignments[uid]] += weights[uid];
+    }
+    return ret;
+}
+} } // End namespace knor::base
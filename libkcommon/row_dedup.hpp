@@ -0,0 +1,69 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_ROW_DEDUP_HPP__
+#define __KNOR_ROW_DEDUP_HPP__
+
+#include <memory>
+#include <vector>
+
+#include "types.hpp"
+
+namespace knor { namespace base {
+
+/**
+  * Collapses exact duplicate rows (bitwise equal) into weighted unique rows.
+  *  A unique row's weight is its number of copies and unique rows keep the
+  *  order of their first occurrence. Clustering the unique rows with their
+  *  weights gives the same centroids as clustering every row; expand maps
+  *  the per unique row results back onto the original rows.
+  */
+class row_dedup {
+private:
+    size_t nrow, ncol;
+    std::vector<double> data; // nuniq x ncol
+    std::vector<double> weights; // nuniq
+    std::vector<unsigned> row_map; // nrow, unique id of every row
+
+    row_dedup(const double* data, const size_t nrow, const size_t ncol);
+
+public:
+    typedef std::shared_ptr<row_dedup> ptr;
+
+    // Rows are hashed & collapsed in parallel
+    static ptr create(const double* data, const size_t nrow,
+            const size_t ncol) {
+        return ptr(new row_dedup(data, nrow, ncol));
+    }
+
+    // The number of unique rows
+    const size_t get_nrow() const { return weights.size(); }
+    const size_t get_ncol() const { return ncol; }
+    double* get_data() { return &data[0]; }
+    const double* get_weights() const { return &weights[0]; }
+    const std::vector<unsigned>& get_row_map() const { return row_map; }
+
+    // Per unique row assignments to per row assignments (nrow)
+    void expand(const unsigned* uniq_assignments,
+            unsigned* assignments) const;
+    // A clustering of the unique rows as a clustering of every row
+    cluster_t expand(const cluster_t& uniq) const;
+};
+} } // End namespace knor::base
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "row_partition.hpp"
+#include "exception.hpp"
+
+namespace knor { namespace base {
+
+row_partition::row_partition(const size_t g_nrow, const unsigned nparts) {
+    if (!nparts)
+        throw parameter_exception("A partition needs at least one part");
+
+    offsets.resize(nparts+1);
+    for (unsigned part = 0; part < nparts; part++)
+        offsets[part] = (g_nrow / nparts) * part;
+    offsets[nparts] = g_nrow; // The last part always has more
+}
+
+row_partition::row_partition(const size_t g_nrow,
+        const std::vector<double>& weights) {
+    if (weights.empty())
+        throw parameter_exception("A partition needs at least one part");
+    if (g_nrow < weights.size())
+        throw parameter_exception("Fewer rows than parts to partition");
+
+    double total = 0;
+    for (double w : weights) {
+        if (!(w > 0))
+            throw parameter_exception("Partition weights must be > 0");
+        total += w;
+    }
+
+    // Floor of every share then the leftover rows go to the largest
+    //  remainders so the sizes sum to g_nrow
+    const size_t nparts = weights.size();
+    const size_t spare = g_nrow - nparts; // 1 row each is guaranteed
+    std::vector<size_t> sizes(nparts);
+    std::vector<std::pair<double, unsigned> > rems(nparts);
+    size_t given = 0;
+    for (size_t part = 0; part < nparts; part++) {
+        const double share = spare * (weights[part] / total);
+        sizes[part] = std::min(static_cast<size_t>(share), spare - given);
+        given += sizes[part];
+        rems[part] = std::pair<double, unsigned>(share - sizes[part], part);
+    }
+    std::stable_sort(rems.begin(), rems.end(),
+            [](const std::pair<double, unsigned>& a,
+                const std::pair<double, unsigned>& b) {
+            return a.first > b.first; });
+    for (size_t i = 0; given < spare; i = (i + 1) % nparts, given++)
+        sizes[rems[i].second]++;
+
+    offsets.resize(nparts+1);
+    offsets[0] = 0;
+    for (size_t part = 0; part < nparts; part++)
+        offsets[part+1] = offsets[part] + sizes[part] + 1;
+}
+
+const unsigned row_partition::owner(const size_t global_rid) const {
+    if (global_rid >= get_g_nrow())
+        throw parameter_exception("Row: " + std::to_string(global_rid) +
+                " out of bounds");
+    return std::upper_bound(offsets.begin(), offsets.end(), global_rid)
+        - offsets.begin() - 1;
+}
+
+const size_t row_partition::overlap(const unsigned a,
+        const row_partition& other, const unsigned b, size_t& begin) const {
+    begin = std::max(first(a), other.first(b));
+    const size_t end = std::min(first(a) + nrow(a),
+            other.first(b) + other.nrow(b));
+    return end > begin ? end - begin : 0;
+}
+} } // End namespace knor::base
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_ROW_PARTITION_HPP__
+#define __KNOR_ROW_PARTITION_HPP__
+
+#include <memory>
+#include <vector>
+
+namespace knor { namespace base {
+
+/**
+  * An explicit table of which contiguous block of rows every part (proc)
+  *  owns. Part p owns global rows [first(p), first(p) + nrow(p)).
+  */
+class row_partition {
+private:
+    std::vector<size_t> offsets; // nparts + 1, offsets[0] == 0
+
+    row_partition(const size_t g_nrow, const unsigned nparts);
+    row_partition(const size_t g_nrow, const std::vector<double>& weights);
+
+public:
+    typedef std::shared_ptr<row_partition> ptr;
+
+    // g_nrow / nparts rows each with the remainder on the last part
+    static ptr create(const size_t g_nrow, const unsigned nparts) {
+        return ptr(new row_partition(g_nrow, nparts));
+    }
+
+    // Rows proportional to weights (e.g. throughput), at least 1 per part
+    static ptr create(const size_t g_nrow, const std::vector<double>& weights) {
+        return ptr(new row_partition(g_nrow, weights));
+    }
+
+    const unsigned get_nparts() const { return offsets.size() - 1; }
+    const size_t get_g_nrow() const { return offsets.back(); }
+    const size_t first(const unsigned part) const { return offsets[part]; }
+    const size_t nrow(const unsigned part) const {
+        return offsets[part+1] - offsets[part];
+    }
+    // The part that owns a global row
+    const unsigned owner(const size_t global_rid) const;
+    // Rows of part `a' in this partition that `other' gives to part `b'
+    const size_t overlap(const unsigned a, const row_partition& other,
+            const unsigned b, size_t& begin) const;
+    const bool operator==(const row_partition& other) const {
+        return offsets == other.offsets;
+    }
+};
+} } // End namespace knor::base
+#endif
@@ -29,6 +29,7 @@ namespace knor {
         E, /*E steps of an EM algo*/
         M, /*M steps of an EM algo*/
         MEDOID, /*Medoids step*/
+        SWAP_CHECK, /*Re-evaluate a medoid swap after others were applied*/
         BOUNDS, /*A reduction computation of some kind*/
         NORMALIZE_DATA, /*Normalize the data*/
         MB_EM, /*Mini-batch EM step*/
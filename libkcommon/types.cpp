@@ -18,6 +18,8 @@
  */
 
 #include <fstream>
+#include <sstream>
+#include <algorithm>
 
 #include "types.hpp"
 #include "io.hpp"
@@ -35,9 +37,8 @@ cluster_t::cluster_t(const size_t nrow, const size_t ncol, const size_t iters,
     iters(iters), k(k) {
 
     assignment_count.resize(k);
-    assignments.resize(nrow);
-
-    std::copy(assignments_buf, assignments_buf + nrow, assignments.begin());
+    if (assignments_buf) // NULL when the assignments are kept elsewhere
+        assignments.assign(assignments_buf, assignments_buf + nrow);
     std::copy(assignment_count_buf, assignment_count_buf + k,
             assignment_count.begin());
     this->centroids = centroids; // copy
@@ -99,12 +100,7 @@ const void cluster_t::print() const {
 #endif
 }
 
-/**
-  * A simple text readable write
-  * \param dirname: the name of the dir to write to
-  */
-const void cluster_t::write(const std::string dirname) const {
-
+const std::string cluster_t::make_outfn(const std::string dirname) {
     std::string fn = "cluster_t.yml";
     int ret =
         std::system((std::string("python python/util.py ")
@@ -116,18 +112,16 @@ const void cluster_t::write(const std::string dirname) const {
     } else {
         fn = dirname + "/" + fn;
     }
+    return fn;
+}
 
-#ifndef BIND
-    printf("Opening '%s' \n", fn.c_str());
-#endif
-    std::ofstream f(fn, std::ios::out);
-    //assert_msg(f.is_open(), "Error opening file for writing!");
+const std::string cluster_t::yml_head() const {
+    std::ostringstream f;
     f << "k: " << k << std::endl;
     f << "niter: " << iters << std::endl;
     f << "nsamples: " << nrow << std::endl;
     f << "dim: " << ncol << std::endl;
 
-    /** Do it all here so we can stream the output **/
     // Sizes of each cluster
     f << "size: [";
     for (size_t _k = 0; _k < k; _k++) {
@@ -140,12 +134,23 @@ const void cluster_t::write(const std::string dirname) const {
 
     // Centroid assignemnt
     f << "\ncluster: [";
+    return f.str();
+}
+
+const std::string cluster_t::yml_assignments(const unsigned* assignments,
+        const size_t nrow, const bool first) {
+    std::ostringstream f;
     for (size_t row = 0; row < nrow; row++) {
-        if (row == 0)
+        if (row == 0 && first)
             f << assignments[row];
         else
             f << "," << assignments[row];
     }
+    return f.str();
+}
+
+const std::string cluster_t::yml_tail() const {
+    std::ostringstream f;
     f << "]";
 
     // Centroids
@@ -165,6 +170,29 @@ const void cluster_t::write(const std::string dirname) const {
     }
 
     f << "]\n";
+    return f.str();
+}
+
+/**
+  * A simple text readable write
+  * \param dirname: the name of the dir to write to
+  */
+const void cluster_t::write(const std::string dirname) const {
+    std::string fn = make_outfn(dirname);
+
+#ifndef BIND
+    printf("Opening '%s' \n", fn.c_str());
+#endif
+    std::ofstream f(fn, std::ios::out);
+    //assert_msg(f.is_open(), "Error opening file for writing!");
+
+    /** Stream the assignments in blocks **/
+    f << yml_head();
+    const size_t block = 1 << 16;
+    for (size_t row = 0; row < nrow; row += block)
+        f << yml_assignments(&assignments[row], std::min(block, nrow - row),
+                row == 0);
+    f << yml_tail();
     f.close();
 }
 
@@ -189,8 +217,8 @@ gmm_t::gmm_t(const size_t nrow, const size_t ncol, const size_t iters,
             cov_mats.push_back(v);
         }
 
-        resp_mat.resize(nrow);
-        std::copy(&(_resp_mat[0]), &(_resp_mat[nrow]), resp_mat.begin());
+        resp_mat.resize(nrow*k);
+        std::copy(&(_resp_mat[0]), &(_resp_mat[nrow*k]), resp_mat.begin());
 
         gaussian_prob.resize(k);
         std::copy(&(_gaussian_prob[0]), &(_gaussian_prob[k]),
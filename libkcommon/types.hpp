@@ -37,6 +37,7 @@ static const unsigned INVALID_CLUSTER_ID = std::numeric_limits<unsigned>::max();
 enum stage_t { INIT, ESTEP }; // What phase of the algo we're in
 enum dist_t { EUCL, COS, TAXI, SQEUCL }; // Euclidean, Cosine, Taxicab distance
 enum init_t { RANDOM, FORGY, PLUSPLUS, NONE }; // May have to use
+enum cov_t { FULL, DIAG, SPHERICAL, TIED }; // GMM covariance structure
 
 class cluster_t {
 public:
@@ -70,6 +71,16 @@ public:
 
     const void print() const;
     const void write(const std::string dirname) const;
+
+    // Create dirname and return the path of its cluster_t.yml
+    static const std::string make_outfn(const std::string dirname);
+    // cluster_t.yml before and after the assignments, which are comma
+    //  separated so parts can be written independently (e.g. per proc)
+    const std::string yml_head() const;
+    const std::string yml_tail() const;
+    // first is true for the part that holds the first row
+    static const std::string yml_assignments(const unsigned* assignments,
+            const size_t nrow, const bool first);
     bool operator==(const cluster_t& other);
 
     ~cluster_t() { }
@@ -18,6 +18,7 @@
  */
 
 #include <vector>
+#include <random>
 #include <cassert>
 #include <stdio.h>
 
@@ -47,5 +48,54 @@ int main() {
 	for (size_t i = 0; i < cv.size(); i++)
 		assert(cv[i] - CV_RES[i] < EPS);
 
+	// One value per bucket is exact
+	auto binned = AndersonDarling::compute_statistic_binned(4, &x[0], 1000);
+	printf("Binned AD: %.5f\n", binned);
+	assert(std::abs(binned - ad) < EPS);
+
+	// Many values per bucket stays close to the sorted statistic
+	for (auto const& shift : {0.0, 0.5}) {
+		std::default_random_engine gen(1234);
+		std::normal_distribution<double> norm;
+		std::vector<double> y(100000);
+		for (size_t i = 0; i < y.size(); i++)
+			y[i] = norm(gen) + (i % 2 ? shift : -shift);
+
+		binned = AndersonDarling::compute_statistic_binned(
+				y.size(), &y[0], 1024);
+		auto exact = AndersonDarling::compute_statistic(y.size(), &y[0]);
+		printf("Exact AD: %.5f, binned AD: %.5f\n", exact, binned);
+		assert(std::abs(binned - exact) < .01 * std::max(1.0, exact));
+	}
+
+	// Bucket sums of the parts of a sample add up to those of the whole
+	{
+		std::default_random_engine gen(4321);
+		std::normal_distribution<double> norm;
+		std::vector<double> y(10001);
+		for (size_t i = 0; i < y.size(); i++)
+			y[i] = norm(gen);
+
+		double avg = 0, sig = 0;
+		for (auto const& v : y)
+			avg += v;
+		avg /= y.size();
+		for (auto const& v : y)
+			sig += (v - avg) * (v - avg);
+		sig = std::sqrt(sig / (y.size() - 1));
+
+		const size_t nbins = 256, split = 3000;
+		std::vector<double> sums(4*nbins, 0);
+		AndersonDarling::bin_sums(split, &y[0], avg, sig, nbins, &sums[0]);
+		AndersonDarling::bin_sums(y.size() - split, &y[split], avg, sig,
+				nbins, &sums[0]);
+		auto merged = AndersonDarling::binned_statistic(y.size(), nbins,
+				&sums[0]);
+		binned = AndersonDarling::compute_statistic_binned(
+				y.size(), &y[0], nbins);
+		printf("Merged AD: %.5f, binned AD: %.5f\n", merged, binned);
+		assert(std::abs(merged - binned) < EPS);
+	}
+
 	printf("\nAndersonDarling test successful!\n");
 }
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <iostream>
+#include <random>
+#include <limits>
+
+#include <cassert>
+
+#include "centroid_graph.hpp"
+#include "util.hpp"
+
+namespace kbase = knor::base;
+
+static unsigned brute_force(const std::vector<double>& means,
+        const double* query, const size_t ncol) {
+    unsigned best = 0;
+    double best_dist = std::numeric_limits<double>::max();
+    for (size_t node = 0; node < means.size()/ncol; node++) {
+        double dist = kbase::eucl_dist(query, &means[node*ncol], ncol);
+        if (dist < best_dist) {
+            best_dist = dist;
+            best = node;
+        }
+    }
+    return best;
+}
+
+void test_search(const size_t nnodes, const size_t ncol, const unsigned ef,
+        const double min_recall) {
+    std::default_random_engine gen(nnodes);
+    std::normal_distribution<double> val(0, 1);
+    std::uniform_int_distribution<unsigned> node(0, nnodes-1);
+
+    std::vector<double> means(nnodes*ncol);
+    for (auto& v : means)
+        v = val(gen);
+
+    auto graph = kbase::centroid_graph::create(8, 32);
+    graph->build(&means[0], nnodes, ncol);
+    for (size_t n = 0; n < nnodes; n++)
+        assert(graph->get_degree(n) <= 16 && (nnodes == 1 ||
+                    graph->get_degree(n) > 0));
+
+    const unsigned nqueries = 500;
+    unsigned hits = 0;
+    kbase::centroid_graph::visit_list vl;
+    std::vector<double> query(ncol);
+    for (unsigned q = 0; q < nqueries; q++) {
+        for (auto& v : query)
+            v = val(gen);
+        double dist;
+        unsigned found = graph->search(&query[0], node(gen), ef, dist, vl);
+        assert(found < nnodes);
+        assert(dist == kbase::eucl_dist(&query[0], &means[found*ncol], ncol));
+        hits += found == brute_force(means, &query[0], ncol);
+    }
+
+    double recall = hits / (double)nqueries;
+    printf("centroid_graph nnodes: %lu, ncol: %lu, ef: %u, recall: %.3f\n",
+            nnodes, ncol, ef, recall);
+    assert(recall >= min_recall);
+}
+
+int main() {
+    test_search(1, 4, 1, 1);
+    test_search(50, 4, 50, 1); // Beam covers the whole graph
+    test_search(2000, 8, 64, .95);
+    test_search(5000, 16, 16, .6);
+    printf("Successful centroid_graph test!\n");
+    return EXIT_SUCCESS;
+}
@@ -164,10 +164,61 @@ void test_hclusters() {
     printf("Success ...\n");
 }
 
+void test_weighted() {
+    printf("Testing weighted members ...\n");
+    double a[NCOL] = {1, 2, 3, 4};
+    double b[NCOL] = {5, 6, 7, 8};
+
+    auto cls = kbase::clusters::create(2, NCOL);
+    auto part = kbase::clusters::create(2, NCOL);
+    cls->add_member(a, 0, 3);
+    part->add_member(b, 0, 1);
+    part->add_member(b, 1, 0.5);
+    cls->peq(part);
+
+    assert(cls->is_weighted());
+    assert(cls->get_num_members(0) == 2);
+    assert(cls->get_weight(0) == 4);
+    cls->finalize_all();
+    // (3*a + b) / 4 and b
+    for (unsigned col = 0; col < NCOL; col++) {
+        assert(cls->get_means()[col] == (3*a[col] + b[col]) / 4);
+        assert(cls->get_means()[NCOL+col] == b[col]);
+    }
+
+    // Moving b out of cluster 0 leaves a
+    cls->unfinalize_all();
+    cls->swap_membership(b, 0, 1, 1);
+    cls->finalize_all();
+    assert(cls->get_weight(0) == 3 && cls->get_weight(1) == 1.5);
+    for (unsigned col = 0; col < NCOL; col++) {
+        assert(cls->get_means()[col] == a[col]);
+        assert(cls->get_means()[NCOL+col] == b[col]);
+    }
+
+    cls->clear();
+    assert(cls->get_weight(0) == 0);
+
+    // A thread's first weighted change may be a removal
+    auto delta = kbase::clusters::create(2, NCOL);
+    delta->swap_membership(b, 1, 0, 2);
+    assert(delta->get_weight(0) == 2 && delta->get_weight(1) == -2);
+
+    // Unweighted members count once on either side of peq
+    auto plain = kbase::clusters::create(2, NCOL);
+    plain->add_member(&a[0], 0);
+    plain->peq(delta);
+    assert(plain->get_weight(0) == 3 && plain->get_weight(1) == -2);
+    delta->peq(plain);
+    assert(delta->get_weight(0) == 5 && delta->get_weight(1) == -4);
+    printf("Success ...\n");
+}
+
 int main() {
     test_clusters();
     test_prune_clusters();
     test_scaling();
     test_hclusters();
+    test_weighted();
     return EXIT_SUCCESS;
 }
@@ -148,6 +148,14 @@ void test_basic() {
             assert(sub->get(row, col) == 0);
 
     ////////////////////////////////////////////////////////////////////////////
+    ///////////////////////////// Test Frobenius diff //////////////////////////
+    assert(tmp->frobenius_diff(*l) == 0);
+    tmp->set(1, 2, 10); // l(1,2) == 7
+    tmp->set(0, 1, 6); // l(0,1) == 2
+    assert(tmp->frobenius_diff(*l) == 5);
+    assert(l->frobenius_diff(*tmp) == 5);
+    tmp->copy_from(l);
+    ////////////////////////////////////////////////////////////////////////////
 
     *tmp += *l;
     printf("Sum: \n"); tmp->print();
@@ -23,6 +23,7 @@
 #include <cassert>
 
 #include "dist_matrix.hpp"
+#include "clusters.hpp"
 #include "io.hpp"
 
 namespace kbase = knor::base;
@@ -50,8 +51,37 @@ void test_dist_matrix() {
     }
 }
 
+// Computing the centroid distances chunk by chunk matches computing them
+//  all at once
+void test_chunked_compute_dist() {
+    std::vector<double> data(NROW*NCOL);
+    kbase::bin_rm_reader<double> bm0("data_dm.bin");
+    bm0.read(data);
+
+    auto cls = kbase::prune_clusters::create(NROW, NCOL);
+    cls->set_mean(&data[0]);
+
+    auto full = kprune::dist_matrix::create(NROW);
+    full->compute_dist(cls, NCOL);
+    std::vector<double> s_vals;
+    for (unsigned c = 0; c < NROW; c++)
+        s_vals.push_back(cls->get_s_val(c));
+
+    auto chunked = kprune::dist_matrix::create(NROW);
+    const unsigned bounds[] = {0, 1, 5, 6, 11, NROW};
+    for (unsigned i = 0; i < 5; i++)
+        chunked->compute_dist(cls, NCOL, bounds[i], bounds[i+1]);
+
+    for (unsigned row = 0; row < NROW; row++) {
+        assert(cls->get_s_val(row) == s_vals[row]);
+        for (unsigned col = row + 1; col < NROW; col++)
+            assert(full->get(row, col) == chunked->get(row, col));
+    }
+}
+
 int main() {
     test_dist_matrix();
+    test_chunked_compute_dist();
     printf("Successful 'test_dist_matrix' test ...\n");
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "dist_tile_cache.hpp"
+
+namespace kbase = knor::base;
+
+void test_lru() {
+    constexpr size_t DIM = 4;
+    const size_t tile_bytes = sizeof(kbase::dist_tile) +
+        (DIM*DIM*sizeof(double)) + DIM;
+
+    // Room for exactly two tiles
+    auto cache = kbase::dist_tile_cache::create(2*tile_bytes);
+
+    for (uint64_t key = 0; key < 2; key++) {
+        kbase::dist_tile* tile = cache->put(key, key, key, DIM, DIM);
+        assert(tile);
+        assert(tile->row_done.size() == DIM && !tile->row_done[0]);
+        std::fill(tile->dists.begin(), tile->dists.end(), key);
+    }
+    assert(cache->size() == 2);
+    assert(cache->get_used() == 2*tile_bytes);
+
+    // Touch 0 so that 1 is the least recently used
+    assert(cache->get(0, 0, 0)->dists[DIM] == 0);
+    cache->put(2, 2, 2, DIM, DIM);
+    assert(cache->get_evictions() == 1);
+    assert(cache->get(1, 1, 1) == NULL);
+    assert(cache->get(0, 0, 0));
+    assert(cache->get(2, 2, 2));
+    assert(cache->get_hits() == 3);
+    assert(cache->get_misses() == 1);
+
+    // Stale signatures are misses and replacing them doesn't leak budget
+    assert(cache->get(0, 0, 1) == NULL);
+    cache->put(0, 0, 1, DIM, DIM);
+    assert(cache->size() == 2);
+    assert(cache->get_used() == 2*tile_bytes);
+
+    // Tiles larger than the budget are not cached
+    assert(cache->put(3, 3, 3, 3*DIM, 3*DIM) == NULL);
+
+    cache->clear();
+    assert(cache->size() == 0 && cache->get_used() == 0);
+}
+
+void test_signature() {
+    std::vector<unsigned> a = {1, 5, 9};
+    std::vector<unsigned> b = {1, 5, 10};
+    assert(kbase::dist_tile_cache::signature(&a[0], a.size()) ==
+            kbase::dist_tile_cache::signature(&a[0], a.size()));
+    assert(kbase::dist_tile_cache::signature(&a[0], a.size()) !=
+            kbase::dist_tile_cache::signature(&b[0], b.size()));
+    assert(kbase::dist_tile_cache::signature(&a[0], 2) !=
+            kbase::dist_tile_cache::signature(&a[0], 3));
+}
+
+int main() {
+    test_lru();
+    printf("Successful 'test_lru' test ...\n");
+    test_signature();
+    printf("Successful 'test_signature' test ...\n");
+    return EXIT_SUCCESS;
+}
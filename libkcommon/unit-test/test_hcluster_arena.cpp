@@ -0,0 +1,90 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+
+#include <cassert>
+
+#include "hcluster_arena.hpp"
+
+namespace kbase = knor::base;
+
+void test_keys() {
+    auto arena = kbase::hcluster_arena::create(7, 3);
+    assert(arena->keyless());
+
+    arena->add(0, 1, 2);
+    arena->add(2, 5, 6);
+    arena->add(1, 3, 4);
+    arena->erase(0);
+    arena->erase(0); // No-op
+    assert(arena->keycount() == 2);
+
+    std::vector<size_t> ids;
+    arena->get_keys(ids);
+    assert(ids.size() == 2 && ids[0] == 1 && ids[1] == 2);
+    assert(arena->get_zeroid(2) == 5 && arena->get_oneid(2) == 6);
+    printf("Successful 'hcluster_arena' keys test\n");
+}
+
+void test_reduce() {
+    const size_t ncol = 2;
+    auto arena = kbase::hcluster_arena::create(3, ncol);
+    arena->add(0, 1, 2);
+    arena->add(1);
+    arena->add(2);
+    arena->set_converged(1);
+    arena->assign_slots();
+    assert(arena->nslots() == 2);
+    assert(arena->get_slot(0) == 0 && arena->get_slot(2) == 1);
+    assert(arena->get_slot_id(1) == 2);
+
+    const double r0[] = {1, 2}, r1[] = {3, 4}, r2[] = {5, 6};
+    std::vector<kbase::h_accumulator> accs(2);
+    for (auto& acc : accs)
+        acc.reset(arena->nslots(), ncol);
+    accs[0].add_member(r0, 0, 0, ncol);
+    accs[1].add_member(r1, 0, 0, ncol);
+    accs[1].add_member(r2, 0, 1, ncol);
+    accs[1].add_member(r2, 1, 1, ncol);
+
+    std::vector<const kbase::h_accumulator*> ptrs {&accs[0], &accs[1]};
+    arena->reduce(ptrs);
+
+    assert(arena->get_num_members(0, 0) == 2);
+    assert(arena->get_num_members(0, 1) == 1);
+    assert(arena->get_mean(0, 0)[0] == 2 && arena->get_mean(0, 0)[1] == 3);
+    assert(arena->get_mean(0, 1)[0] == 5 && arena->get_mean(0, 1)[1] == 6);
+    // No members leaves a zero mean
+    assert(arena->get_mean(2, 0)[0] == 0);
+    assert(arena->get_mean(2, 1)[1] == 6);
+
+    // Reset only grows storage and zeroes the slots in use
+    accs[0].reset(1, ncol);
+    assert(accs[0].sums.size() == 2*2*ncol && accs[0].sums[0] == 0);
+    printf("Successful 'hcluster_arena' reduce test\n");
+}
+
+int main(int argc, char* argv[]) {
+    test_keys();
+    test_reduce();
+    return EXIT_SUCCESS;
+}
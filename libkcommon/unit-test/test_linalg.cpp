@@ -20,6 +20,8 @@
 
 // C++ program to find adjoint and inverse of a matrix
 
+#include <cassert>
+
 #include "linalg.hpp"
 #include "io.hpp"
 #include "dense_matrix.hpp"
@@ -55,12 +57,69 @@ void test_det() {
     printf("Input matrix is :\n");
     kbase::print(A, N, N);
 
-    printf("\nThe Determinant is : %.2f\n",
-            kbase::linalg::determinant(A,N, N));
+    double det = kbase::linalg::determinant(A,N, N);
+    printf("\nThe Determinant is : %.2f\n", det);
+    assert(std::abs(det - 1529) < 1E-8);
 
     printf("\nThe Inverse is :\n");
 	if (kbase::linalg::inverse(A, inv, N))
 		kbase::print(inv, N, N);
+
+    // A * inv(A) == I
+    for (size_t row = 0; row < N; row++) {
+        for (size_t col = 0; col < N; col++) {
+            double val = 0;
+            for (size_t i = 0; i < N; i++)
+                val += A[row*N+i]*inv[i*N+col];
+            assert(std::abs(val - (row == col ? 1 : 0)) < 1E-10);
+        }
+    }
+}
+
+void test_cholesky() {
+    // Symmetric positive definite
+    double A[3*3] = { 4, 12, -16,
+                     12, 37, -43,
+                    -16, -43, 98 };
+    const double L_truth[3*3] = { 2, 0, 0,
+                                  6, 1, 0,
+                                 -8, 5, 3 };
+    double L[3*3];
+    double inv[3*3];
+    constexpr double EPS = 1E-10;
+
+    assert(kbase::linalg::cholesky(A, L, 3));
+    for (size_t i = 0; i < 9; i++)
+        assert(std::abs(L[i] - L_truth[i]) < EPS);
+
+    // det(A) = (2*1*3)^2
+    assert(std::abs(kbase::linalg::chol_logdet(L, 3) - std::log(36.0)) < EPS);
+    assert(std::abs(kbase::linalg::determinant(A, 3, 3) - 36) < EPS);
+
+    // Solve Ax = b through LL^Tx = b
+    std::vector<double> b {1, 2, 3};
+    std::vector<double> x(3);
+    kbase::linalg::forward_sub(L, &b[0], &x[0], 3);
+    kbase::linalg::backward_sub(L, &x[0], &x[0], 3);
+    for (size_t row = 0; row < 3; row++) {
+        double val = 0;
+        for (size_t col = 0; col < 3; col++)
+            val += A[row*3+col]*x[col];
+        assert(std::abs(val - b[row]) < EPS);
+    }
+
+    kbase::linalg::chol_inverse(L, inv, 3);
+    double ref_inv[3*3];
+    assert(kbase::linalg::inverse(A, ref_inv, 3));
+    for (size_t i = 0; i < 9; i++)
+        assert(std::abs(inv[i] - ref_inv[i]) < 1E-8);
+
+    // Not positive definite
+    double B[2*2] = { 1, 2,
+                      2, 1 };
+    assert(!kbase::linalg::cholesky(B, L, 2));
+
+    printf("Successful 'test_cholesky' test!\n");
 }
 
 void test_det_dense_mat() {
@@ -84,9 +143,10 @@ void test_det_dense_mat() {
     printf("Input (dense) matrix is :\n");
     dm->print();
 
-    printf("\nThe Determinant is : %.2f\n",
-            kbase::linalg::determinant(dm->as_pointer(),
-                dm->get_nrow(), dm->get_ncol()));
+    double det = kbase::linalg::determinant(dm->as_pointer(),
+                dm->get_nrow(), dm->get_ncol());
+    printf("\nThe Determinant is : %.2f\n", det);
+    assert(std::abs(det - 1529) < 1E-8);
 
     printf("\nThe Inverse is :\n");
 	if (kbase::linalg::inverse(dm->as_pointer(), inv->as_pointer(),
@@ -101,6 +161,7 @@ int main() {
     test_det();
     test_det_dense_mat();
     test_scale();
+    test_cholesky();
 
     printf("Successful 'testit' test ...\n");
     return EXIT_SUCCESS;
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+#include <cassert>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "member_index.hpp"
+
+namespace kbase = knor::base;
+
+void test_build(const size_t nrow, const unsigned nclust,
+        const bool nested=false) {
+    std::default_random_engine gen(nrow);
+    // One id past the end is left out of the index
+    std::uniform_int_distribution<unsigned> dist(0, nclust);
+    std::vector<unsigned> assignments(nrow);
+    for (auto& cid : assignments)
+        cid = dist(gen);
+
+    auto index = kbase::member_index::create();
+    if (nested) {
+        // The inner region gets one thread, fewer than build asks for
+#ifdef _OPENMP
+        omp_set_num_threads(4);
+#pragma omp parallel num_threads(2)
+#pragma omp single
+#endif
+        index->build(&assignments[0], nrow, nclust);
+    } else {
+        index->build(&assignments[0], nrow, nclust);
+    }
+    assert(index->get_nclust() == nclust);
+
+    size_t nmembers = 0;
+    for (unsigned cid = 0; cid < nclust; cid++) {
+        std::vector<unsigned> expected;
+        for (size_t rid = 0; rid < nrow; rid++)
+            if (assignments[rid] == cid)
+                expected.push_back(rid);
+
+        assert(index->size(cid) == expected.size());
+        assert(std::equal(index->begin(cid), index->end(cid),
+                    expected.begin()));
+        nmembers += expected.size();
+    }
+    assert(index->size(nclust) == 0);
+
+    // Rebuilding with fewer clusters reuses the same storage
+    index->build(&assignments[0], nrow, 1);
+    assert(index->get_nclust() == 1);
+    for (size_t i = 0; i < index->size(0); i++)
+        assert(assignments[index->get(0, i)] == 0);
+
+    printf("Successful 'member_index' test for nrow: %lu, nclust: %u, "
+            "nmembers: %lu\n", nrow, nclust, nmembers);
+}
+
+int main(int argc, char* argv[]) {
+    test_build(10, 3);
+    test_build(100000, 64);
+    test_build(100000, 64, true);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <iostream>
+#include <random>
+#include <limits>
+#include <cmath>
+
+#include <cassert>
+
+#include "predictor.hpp"
+#include "util.hpp"
+#include "io.hpp"
+
+namespace kbase = knor::base;
+
+static void brute_force(const std::vector<double>& means,
+        const std::vector<double>& rows, const size_t ncol,
+        const kbase::dist_t dt, std::vector<double>& best_dist) {
+    const size_t nrow = rows.size()/ncol;
+    best_dist.assign(nrow, std::numeric_limits<double>::max());
+    for (size_t row = 0; row < nrow; row++) {
+        for (size_t c = 0; c < means.size()/ncol; c++) {
+            double dist = kbase::dist_comp_raw<double>(&rows[row*ncol],
+                    &means[c*ncol], ncol, dt);
+            if (dist < best_dist[row])
+                best_dist[row] = dist;
+        }
+    }
+}
+
+static void rand_fill(std::vector<double>& v, const unsigned seed) {
+    std::default_random_engine gen(seed);
+    std::normal_distribution<double> val(0, 1);
+    for (auto& x : v)
+        x = val(gen);
+}
+
+// Assignments are only checked through distances since ties may break
+//  differently between the tiled and direct kernels
+void test_exact(const size_t nrow, const size_t ncol, const size_t k,
+        const kbase::dist_t dt) {
+    std::vector<double> rows(nrow*ncol), means(k*ncol);
+    rand_fill(rows, nrow);
+    rand_fill(means, k);
+
+    std::vector<double> expected;
+    brute_force(means, rows, ncol, dt, expected);
+
+    auto pred = kbase::predictor::create(&means[0], k, ncol, dt);
+    // Odd tiles so the remainders of both loops are exercised
+    pred->set_tiles(7, 11);
+    std::vector<unsigned> asgn(nrow);
+    std::vector<double> dists(nrow);
+    pred->predict(&rows[0], nrow, &asgn[0], &dists[0]);
+
+    for (size_t row = 0; row < nrow; row++) {
+        assert(asgn[row] < k);
+        assert(dists[row] == kbase::dist_comp_raw<double>(&rows[row*ncol],
+                    &means[asgn[row]*ncol], ncol, dt));
+        assert(std::abs(dists[row] - expected[row]) < 1e-9);
+    }
+    printf("predictor exact nrow: %lu, ncol: %lu, k: %lu, dist: %d OK\n",
+            nrow, ncol, k, dt);
+}
+
+void test_stream() {
+    const size_t nrow = 1001, ncol = 5, k = 9;
+    std::vector<double> rows(nrow*ncol), means(k*ncol);
+    rand_fill(rows, 1);
+    rand_fill(means, 2);
+
+    const std::string fn = "test_predictor.bin";
+    {
+        kbase::bin_io<double> bio(fn, "wb");
+        bio.write(rows, rows.size());
+    }
+
+    auto pred = kbase::predictor::create(&means[0], k, ncol);
+    std::vector<unsigned> asgn(nrow), stream_asgn(nrow);
+    pred->predict(&rows[0], nrow, &asgn[0]);
+
+    size_t nblocks = 0;
+    assert(pred->predict(fn, nrow, 100,
+                [&](const size_t first, const size_t len,
+                    const unsigned* block_asgn, const double* dists) {
+                assert(first == nblocks*100);
+                assert(len == std::min((size_t)100, nrow - first));
+                std::copy(block_asgn, block_asgn + len, &stream_asgn[first]);
+                nblocks++;
+                }) == nrow);
+    assert(nblocks == 11);
+    assert(stream_asgn == asgn);
+
+    std::fill(stream_asgn.begin(), stream_asgn.end(), k);
+    assert(pred->predict(fn, nrow, 4096, &stream_asgn[0]) == nrow);
+    assert(stream_asgn == asgn);
+    remove(fn.c_str());
+    printf("predictor stream OK\n");
+}
+
+// The index's recall against the blocked kernel on rows near the centroids
+void test_index(const size_t nrow, const size_t ncol, const size_t k) {
+    std::vector<double> rows(nrow*ncol), means(k*ncol);
+    rand_fill(means, 3);
+    // Rows near the centroids as after training
+    std::default_random_engine gen(4);
+    std::normal_distribution<double> noise(0, .1);
+    std::uniform_int_distribution<size_t> cent(0, k-1);
+    for (size_t row = 0; row < nrow; row++) {
+        size_t c = cent(gen);
+        for (size_t col = 0; col < ncol; col++)
+            rows[row*ncol+col] = means[c*ncol+col] + noise(gen);
+    }
+
+    auto pred = kbase::predictor::create(&means[0], k, ncol,
+            kbase::dist_t::EUCL);
+    std::vector<unsigned> exact(nrow), asgn(nrow);
+    pred->predict(&rows[0], nrow, &exact[0]);
+
+    pred->build_index(12, 16);
+    pred->predict(&rows[0], nrow, &asgn[0]);
+    size_t hits = 0;
+    for (size_t row = 0; row < nrow; row++)
+        hits += asgn[row] == exact[row];
+
+    printf("predictor index nrow: %lu, ncol: %lu, k: %lu recall: %.4f\n",
+            nrow, ncol, k, hits / (double)nrow);
+    assert(hits / (double)nrow >= .95);
+}
+
+int main() {
+    test_exact(100, 3, 1, kbase::dist_t::EUCL);
+    test_exact(1000, 13, 37, kbase::dist_t::EUCL);
+    test_exact(1000, 13, 37, kbase::dist_t::SQEUCL);
+    test_exact(1000, 13, 37, kbase::dist_t::COS);
+    test_exact(1000, 13, 37, kbase::dist_t::TAXI);
+    test_stream();
+
+    bool threw = false;
+    std::vector<double> means(4, 1);
+    auto pred = kbase::predictor::create(&means[0], 2, 2,
+            kbase::dist_t::COS);
+    try {
+        pred->build_index(8);
+    } catch (kbase::parameter_exception& e) {
+        threw = true;
+    }
+    assert(threw);
+
+    test_index(20000, 32, 4000);
+    printf("Successful predictor test!\n");
+    return EXIT_SUCCESS;
+}
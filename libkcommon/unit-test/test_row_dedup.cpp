@@ -0,0 +1,108 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <iostream>
+#include <random>
+#include <cstring>
+
+#include <cassert>
+
+#include "row_dedup.hpp"
+
+namespace kbase = knor::base;
+
+void test_dedup(const size_t nrow, const size_t ncol,
+        const unsigned ndistinct) {
+    std::default_random_engine gen(nrow);
+    std::uniform_int_distribution<unsigned> pick(0, ndistinct-1);
+    std::uniform_real_distribution<double> val(-1, 1);
+
+    std::vector<double> distinct(ndistinct*ncol);
+    for (auto& v : distinct)
+        v = val(gen);
+
+    std::vector<double> data(nrow*ncol);
+    for (size_t row = 0; row < nrow; row++) {
+        unsigned src = pick(gen);
+        std::copy(&distinct[src*ncol], &distinct[(src+1)*ncol],
+                &data[row*ncol]);
+    }
+
+    auto dedup = kbase::row_dedup::create(&data[0], nrow, ncol);
+    assert(dedup->get_nrow() <= ndistinct);
+
+    // Every row maps to an equal unique row & weights count the copies
+    std::vector<double> counts(dedup->get_nrow(), 0);
+    size_t prev_first = 0;
+    for (size_t row = 0; row < nrow; row++) {
+        unsigned uid = dedup->get_row_map()[row];
+        assert(uid < dedup->get_nrow());
+        assert(!std::memcmp(&data[row*ncol], &dedup->get_data()[uid*ncol],
+                    ncol*sizeof(double)));
+        // Unique rows are numbered by first occurrence
+        if (counts[uid] == 0) {
+            assert(uid == prev_first);
+            prev_first++;
+        }
+        counts[uid]++;
+    }
+    assert(prev_first == dedup->get_nrow());
+    for (size_t uid = 0; uid < dedup->get_nrow(); uid++)
+        assert(counts[uid] == dedup->get_weights()[uid]);
+
+    // Unique rows are pairwise distinct
+    for (size_t i = 0; i < dedup->get_nrow(); i++)
+        for (size_t j = i+1; j < dedup->get_nrow(); j++)
+            assert(std::memcmp(&dedup->get_data()[i*ncol],
+                        &dedup->get_data()[j*ncol], ncol*sizeof(double)));
+
+    // Expanding a clustering of the unique rows
+    const unsigned k = 3;
+    std::vector<unsigned> uasgn(dedup->get_nrow());
+    std::vector<knor::llong_t> ucount(k, 0);
+    for (size_t uid = 0; uid < uasgn.size(); uid++) {
+        uasgn[uid] = uid % k;
+        ucount[uid % k]++;
+    }
+    kbase::cluster_t uniq(dedup->get_nrow(), ncol, 1, k, &uasgn[0],
+            &ucount[0], std::vector<double>(k*ncol, 0));
+    kbase::cluster_t full = dedup->expand(uniq);
+
+    assert(full.nrow == nrow && full.assignments.size() == nrow);
+    std::vector<size_t> chk(k, 0);
+    for (size_t row = 0; row < nrow; row++) {
+        assert(full.assignments[row] == dedup->get_row_map()[row] % k);
+        chk[full.assignments[row]]++;
+    }
+    for (unsigned c = 0; c < k; c++)
+        assert(chk[c] == full.assignment_count[c]);
+
+    printf("row_dedup nrow: %lu, ncol: %lu, distinct: %lu OK ...\n",
+            nrow, ncol, dedup->get_nrow());
+}
+
+int main() {
+    test_dedup(1, 4, 1);
+    test_dedup(100, 3, 7);
+    test_dedup(20000, 8, 500);
+    test_dedup(5000, 2, 5000);
+    printf("Successful row_dedup test!\n");
+    return EXIT_SUCCESS;
+}
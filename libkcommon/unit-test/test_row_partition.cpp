@@ -0,0 +1,104 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <vector>
+
+#include <cassert>
+
+#include "row_partition.hpp"
+#include "exception.hpp"
+
+namespace kbase = knor::base;
+
+// Every row has exactly one owner and parts are contiguous
+void check_cover(const kbase::row_partition& part) {
+    size_t next = 0;
+    for (unsigned p = 0; p < part.get_nparts(); p++) {
+        assert(part.first(p) == next);
+        for (size_t rid = next; rid < next + part.nrow(p); rid++)
+            assert(part.owner(rid) == p);
+        next += part.nrow(p);
+    }
+    assert(next == part.get_g_nrow());
+}
+
+void test_even() {
+    auto part = kbase::row_partition::create(103, 4);
+    check_cover(*part);
+    // The same layout as g_nrow/nprocs with the remainder on the last proc
+    for (unsigned p = 0; p < 3; p++) {
+        assert(part->first(p) == 25*p);
+        assert(part->nrow(p) == 25);
+    }
+    assert(part->nrow(3) == 28);
+    printf("Even partition test successful!\n");
+}
+
+void test_weighted() {
+    std::vector<double> weights {1, 3, 2, 2};
+    auto part = kbase::row_partition::create(1000, weights);
+    check_cover(*part);
+    assert(part->nrow(1) > part->nrow(2) && part->nrow(2) > part->nrow(0));
+    for (unsigned p = 0; p < weights.size(); p++) {
+        const double share = 1000 * weights[p] / 8;
+        assert(part->nrow(p) + 1 >= share && part->nrow(p) <= share + 1);
+    }
+
+    // Tiny weights still get a row
+    std::vector<double> skew {1e-9, 1, 1};
+    auto small = kbase::row_partition::create(10, skew);
+    check_cover(*small);
+    assert(small->nrow(0) == 1);
+
+    bool thrown = false;
+    try {
+        std::vector<double> bad {1, 0};
+        kbase::row_partition::create(10, bad);
+    } catch (kbase::parameter_exception& e) {
+        thrown = true;
+    }
+    assert(thrown);
+    printf("Weighted partition test successful!\n");
+}
+
+void test_overlap() {
+    auto even = kbase::row_partition::create(100, 2);
+    std::vector<double> weights {3, 1};
+    auto moved = kbase::row_partition::create(100, weights);
+
+    // Rows 50..74 move from part 1 to part 0
+    size_t begin, total = 0;
+    assert(moved->overlap(0, *even, 1, begin) == moved->nrow(0) - 50);
+    assert(begin == 50);
+    for (unsigned a = 0; a < 2; a++)
+        for (unsigned b = 0; b < 2; b++)
+            total += moved->overlap(a, *even, b, begin);
+    assert(total == 100);
+    assert(!(*moved == *even));
+    assert(*even == *kbase::row_partition::create(100, 2));
+    printf("Partition overlap test successful!\n");
+}
+
+int main(int argc, char* argv[]) {
+    test_even();
+    test_weighted();
+    test_overlap();
+    return EXIT_SUCCESS;
+}
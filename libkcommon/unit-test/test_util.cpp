@@ -75,9 +75,44 @@ void test_hclust_ceil() {
     printf("hclust_ceil test OK ...\n");
 }
 
+void test_get_bic() {
+    std::vector<double> dist_v {1.5, 2, 0.25, 4};
+    assert(get_bic(dist_v, 4, 3, 2) == get_bic(7.75, 4, 3, 2));
+    assert(get_bic(0, 1, 3, 2) == 0);
+    assert(get_bic(7.75, 100, 3, 4) > get_bic(7.75, 100, 3, 2));
+
+    printf("get_bic test OK ...\n");
+}
+
+void test_weighted_select() {
+    std::vector<double> weights {0, 2, 0, 1.5, 3};
+    double draw = 1;
+    assert(weighted_select(&weights[0], weights.size(), draw) == 1);
+    assert(draw == 1);
+    draw = 2;
+    assert(weighted_select(&weights[0], weights.size(), draw) == 1);
+    draw = 2.5;
+    assert(weighted_select(&weights[0], weights.size(), draw) == 3);
+    assert(draw == .5);
+    draw = 6.5;
+    assert(weighted_select(&weights[0], weights.size(), draw) == 4);
+    assert(draw == 3);
+    draw = 7; // Past the total
+    assert(weighted_select(&weights[0], weights.size(), draw) == 4);
+    assert(draw == 3);
+
+    std::vector<double> zeros(3, 0);
+    draw = 0;
+    assert(weighted_select(&zeros[0], zeros.size(), draw) == 0);
+
+    printf("weighted_select test OK ...\n");
+}
+
 int main() {
     test_hclust_floor();
     test_hclust_ceil();
     test_get_max_hnodes();
+    test_get_bic();
+    test_weighted_select();
     printf("Successful util test!\n");
 }
@@ -49,7 +49,31 @@ double get_bic(const std::vector<double>& dist_v, const size_t nrow,
     printf("Distance sum: %f\n", bic);
 #endif
 
-    return 2*bic + std::log(static_cast<double>(nrow))*ncol*k;
+    return get_bic(bic, nrow, ncol, k);
+}
+
+double get_bic(const double dist_sum, const size_t nrow,
+        const size_t ncol, const unsigned k) {
+    return 2*dist_sum + std::log(static_cast<double>(nrow))*ncol*k;
+}
+
+size_t weighted_select(const double* weights, const size_t n,
+        double& draw) {
+    size_t last = n; // The last index with a positive weight
+    for (size_t i = 0; i < n; i++) {
+        if (weights[i] <= 0)
+            continue;
+        if (draw <= weights[i])
+            return i;
+        draw -= weights[i];
+        last = i;
+    }
+
+    // Rounding can leave the draw just past the total
+    if (last == n)
+        return 0;
+    draw = weights[last];
+    return last;
 }
 
 void spherical_projection(double* data, const size_t nrow,
@@ -122,6 +146,21 @@ dist_t get_dist_type(const std::string dist_type) {
                  "'taxi', 'sqeucl'. It is '") + dist_type + std::string("'"));
 }
 
+cov_t get_cov_type(const std::string cov_type) {
+    if (cov_type == "full")
+        return cov_t::FULL;
+    else if (cov_type == "diag")
+        return cov_t::DIAG;
+    else if (cov_type == "spherical")
+        return cov_t::SPHERICAL;
+    else if (cov_type == "tied")
+        return cov_t::TIED;
+    else
+        throw parameter_exception(std::string
+                ("param cov_type must be one of: 'full', 'diag', "
+                 "'spherical', 'tied'. It is '") + cov_type + std::string("'"));
+}
+
 bool is_file_exist(const char *fn) {
     std::ifstream infile(fn);
     return infile.good();
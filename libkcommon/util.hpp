@@ -35,9 +35,17 @@ namespace knor { namespace base {
 
 double get_bic(const std::vector<double>& dist_v, const size_t nrow,
         const size_t ncol, const unsigned k);
+// BIC from the already summed distances
+double get_bic(const double dist_sum, const size_t nrow,
+        const size_t ncol, const unsigned k);
 void spherical_projection(double* data, const size_t nrow,
         const size_t ncol);
 
+// The index whose running sum of weights first reaches draw, skipping zero
+//  weights. draw is left as what remains of it within that index. 0 if
+//  every weight is 0.
+size_t weighted_select(const double* weights, const size_t n, double& draw);
+
 // Hierarchical ceiling of the number of clusters you can get given some non
 //  power of two
 unsigned get_hclust_ceil(const unsigned k);
@@ -246,6 +254,7 @@ unsigned get_num_nodes();
 
 init_t get_init_type(const std::string init);
 dist_t get_dist_type(const std::string dist_type);
+cov_t get_cov_type(const std::string cov_type);
 void int_handler(int sig_num);
 bool is_file_exist(const char *fn);
 size_t filesize(const char* filename);
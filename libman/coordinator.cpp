@@ -37,7 +37,7 @@ coordinator::coordinator(const std::string fn,
     nthreads(static_cast<unsigned>(std::min(
                     static_cast<size_t>(nthreads), this->nrow))),
     _init_t(it), tolerance(tolerance), _dist_t(dt), num_changed(0),
-    pending_threads(0) {
+    pending_threads(0), row_weights(NULL) {
 
     kbase::assert_msg(k >= 1, "[FATAL]: 'k' must be >= 1");
     cluster_assignments.resize(nrow);
@@ -134,6 +134,15 @@ void coordinator::set_thd_dist_v_ptr(double* v) {
     }
 }
 
+void coordinator::set_thd_weights_ptr(const double* w) {
+    row_weights = w;
+    for (unsigned thd_id = 0; thd_id < threads.size(); thd_id++) {
+        pthread_mutex_lock(&threads[thd_id]->get_lock());
+        threads[thd_id]->set_weights_ptr(w);
+        pthread_mutex_unlock(&threads[thd_id]->get_lock());
+    }
+}
+
 double coordinator::reduction_on_cuml_sum() {
     double tot = 0;
     for (thread_iter it = threads.begin(); it != threads.end(); ++it)
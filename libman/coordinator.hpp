@@ -55,6 +55,7 @@ protected:
     std::vector<unsigned> cluster_assignments;
     std::vector<llong_t>cluster_assignment_counts;
     std::vector<unsigned> thd_max_row_idx;
+    const double* row_weights; // Per row weights. NULL if unweighted
 
     // threading
     pthread_mutex_t mutex;
@@ -94,6 +95,14 @@ public:
 
     virtual void run_init();
     void set_thd_dist_v_ptr(double* v);
+    // Weight every row's contribution to the centroids, e.g. for a coreset.
+    //  Only the kmeans family (kmeans_thread and its subclasses e.g.
+    //  skmeans, kmeans_task_thread, kmeans_multi) honors the weights, the
+    //  other algorithms throw if given any.
+    virtual void set_thd_weights_ptr(const double* w);
+    const double get_row_weight(const size_t row) const {
+        return row_weights ? row_weights[row] : 1;
+    }
     void wake4run(thread_state_t state);
     const double* get_thd_data(const unsigned row_id) const;
     std::pair<unsigned, unsigned> get_rid_len_tup(const unsigned thd_id);
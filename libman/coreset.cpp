@@ -0,0 +1,108 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <algorithm>
+
+#include "coreset.hpp"
+#include "kmeans_multi_coordinator.hpp"
+
+namespace knor {
+coreset::coreset(const std::string fn, const size_t nrow, const size_t ncol,
+        const unsigned k, const size_t size, const unsigned nnodes,
+        const unsigned nthreads, const std::string dist_type,
+        double* allocd_data) : ncol(ncol) {
+
+    if (!size)
+        throw base::parameter_exception("Coreset size must be > 0");
+
+    // Seed k centers in k passes. Rows keep their nearest seed.
+    coordinator::ptr kc = kmeans_multi_coordinator::create(fn, nrow, ncol, k,
+            0, nnodes, nthreads, 1, "kmeanspp", -1, dist_type);
+    base::cluster_t seeding = kc->run(allocd_data);
+    const base::dist_t dt = base::get_dist_type(dist_type);
+    seeds = seeding.centroids;
+
+    // Cost of each row w.r.t. its seed
+    std::vector<double> cost(nrow);
+    double total_cost = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:total_cost)
+#endif
+    for (size_t row = 0; row < nrow; row++) {
+        double dist = base::dist_comp_raw<double>(kc->get_thd_data(row),
+                &seeding.centroids[seeding.assignments[row]*ncol], ncol, dt);
+        cost[row] = dt == base::dist_t::SQEUCL ? dist : dist*dist;
+        total_cost += cost[row];
+    }
+
+    std::vector<double> seed_cost(k, 0);
+    for (size_t row = 0; row < nrow; row++)
+        seed_cost[seeding.assignments[row]] += cost[row];
+
+    // Sensitivity bound of every row (Bachem et al. "Practical coreset
+    //  constructions for machine learning"), accumulated for sampling.
+    const double alpha = 16*(std::log(static_cast<double>(k)) + 2);
+    const double mean_cost = std::max(total_cost / nrow,
+            std::numeric_limits<double>::min());
+    std::vector<double>& cuml_sens = cost; // Reuse the memory
+    double sens_sum = 0;
+    for (size_t row = 0; row < nrow; row++) {
+        const unsigned seed = seeding.assignments[row];
+        const double nmemb = seeding.assignment_count[seed];
+        sens_sum += (alpha*cost[row] + 2*alpha*seed_cost[seed]/nmemb) /
+            mean_cost + 4*nrow/nmemb;
+        cuml_sens[row] = sens_sum;
+    }
+
+    // Draw rows proportional to sensitivity & weight by 1/(size*prob)
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> ur_distribution(0.0, sens_sum);
+    std::vector<size_t> draws(size);
+    for (size_t i = 0; i < size; i++) {
+        draws[i] = std::min<size_t>(std::upper_bound(cuml_sens.begin(),
+                    cuml_sens.end(), ur_distribution(generator)) -
+                cuml_sens.begin(), nrow-1);
+    }
+    std::sort(draws.begin(), draws.end());
+
+    for (size_t i = 0; i < size; i++) {
+        const size_t row = draws[i];
+        const double prob = (cuml_sens[row] -
+                (row ? cuml_sens[row-1] : 0)) / sens_sum;
+        const double weight = 1/(size*prob);
+
+        if (!rids.empty() && rids.back() == row) {
+            weights.back() += weight;
+        } else {
+            rids.push_back(row);
+            weights.push_back(weight);
+            const double* dp = kc->get_thd_data(row);
+            data.insert(data.end(), dp, dp + ncol);
+        }
+    }
+
+#ifndef BIND
+    printf("Coreset of %lu distinct rows from %lu draws over %lu rows\n",
+            rids.size(), size, nrow);
+#endif
+}
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __KNOR_CORESET_HPP__
+#define __KNOR_CORESET_HPP__
+
+#include <memory>
+#include <vector>
+
+#include "types.hpp"
+#include "util.hpp"
+
+namespace knor {
+
+/**
+  * A small weighted sample of a dataset for approximate clustering.
+  *  Built by sensitivity sampling: one kmeans++ seeding (k centers, no
+  *  iterations) bounds each row's contribution to the clustering cost,
+  *  rows are drawn with probability proportional to that bound and weighted
+  *  by the inverse so weighted sums over the coreset estimate sums over the
+  *  data. A row drawn more than once is stored once with the summed weight.
+  */
+class coreset {
+    private:
+        size_t ncol;
+        std::vector<double> data; // npoints x ncol
+        std::vector<double> weights; // npoints
+        std::vector<size_t> rids; // Row ids in the original data
+        std::vector<double> seeds; // k x ncol kmeans++ seeds of the data
+
+        coreset(const std::string fn, const size_t nrow, const size_t ncol,
+                const unsigned k, const size_t size, const unsigned nnodes,
+                const unsigned nthreads, const std::string dist_type,
+                double* allocd_data);
+
+    public:
+        typedef std::shared_ptr<coreset> ptr;
+
+        /**
+          * \param k the number of kmeans++ seeds used to bound sensitivity.
+          * \param size the number of rows drawn (with replacement).
+          */
+        static ptr create(const std::string fn, const size_t nrow,
+                const size_t ncol, const unsigned k, const size_t size,
+                const unsigned nnodes, const unsigned nthreads,
+                const std::string dist_type="eucl",
+                double* allocd_data=NULL) {
+            return ptr(new coreset(fn, nrow, ncol, k, size, nnodes, nthreads,
+                        dist_type, allocd_data));
+        }
+
+        // The number of distinct rows in the coreset
+        const size_t get_nrow() const { return weights.size(); }
+        const size_t get_ncol() const { return ncol; }
+        double* get_data() { return &data[0]; }
+        const double* get_weights() const { return &weights[0]; }
+        const std::vector<size_t>& get_rids() const { return rids; }
+        // The kmeans++ seeds, a good init for clustering the coreset
+        const double* get_seeds() const { return &seeds[0]; }
+};
+}
+#endif
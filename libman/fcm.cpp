@@ -17,6 +17,8 @@
  * limitations under the License.
  */
 
+#include <limits>
+
 #include "fcm.hpp"
 #include "types.hpp"
 #include "dense_matrix.hpp"
@@ -28,58 +30,64 @@ fcm::fcm(const int node_id, const unsigned thd_id,
             const unsigned start_rid, const unsigned nprocrows,
             const unsigned ncol, const unsigned nclust,
             const unsigned fuzzindex,
-            base::dense_matrix<double>* um,
+            unsigned* cluster_assignments,
             base::dense_matrix<double>* centers,
             const std::string fn, base::dist_t dist_metric) :
-        thread(node_id, thd_id, ncol, NULL, start_rid, fn, dist_metric),
-        nprocrows(nprocrows), centers(centers), um(um),
+        thread(node_id, thd_id, ncol, cluster_assignments,
+                start_rid, fn, dist_metric),
+        nprocrows(nprocrows), centers(centers),
         nclust(nclust), fuzzindex(fuzzindex){
 
             this->innerprod = base::dense_matrix<double>::create(nclust, ncol);
             set_data_size(sizeof(double)*nprocrows*ncol);
     }
 
+/**
+  * Single pass over this threads rows that computes memberships, normalizes
+  *  them, raises them to the fuzziness index and accumulates the weighted
+  *  center sums (innerprod) and their normalizers (um_sum).
+  */
 void fcm::Estep() {
+    // First touch happens here so the membership block is NUMA local
+    if (um.size() != (size_t)nprocrows*nclust)
+        um.resize(nprocrows*nclust);
+
+    innerprod->zero(); // Reset this
+    um_sum.assign(nclust, 0);
+    double* ip = innerprod->as_pointer();
+
     for (unsigned row = 0; row < nprocrows; row++) {
         unsigned true_rid = get_global_data_id(row);
+        const double* x = &local_data[row*ncol];
+        double* rum = &um[row*nclust];
+
+        double rowsum = 0;
         for (unsigned cid = 0; cid < nclust; cid++) {
-            double dist = base::dist_comp_raw<double>(&local_data[row*ncol],
+            double dist = base::dist_comp_raw<double>(x,
                     &(centers->as_pointer()[cid*ncol]), ncol, dist_metric);
-            if (dist > 0) {
-                //TODO: Fix bad access pattern. um -> col major
-                um->set(cid, true_rid,
-                        std::pow((1.0 / dist), (1.0 / (fuzzindex-1))));
-            } else {
-                um->set(cid, true_rid, 2.2E-16);
-            }
+            if (dist > 0)
+                rum[cid] = std::pow((1.0 / dist), (1.0 / (fuzzindex-1)));
+            else
+                rum[cid] = 2.2E-16;
+            rowsum += rum[cid];
         }
-    }
-}
-
-// NOTE: Sequential access on all 3 matrices, but lh matrix (um) has strided
-//  access.
-void fcm::Mstep() {
-#if 1
-    innerprod->zero(); // Reset this
 
-    for (unsigned lcid = start_rid; lcid < start_rid+nprocrows; lcid++) {
-        unsigned rrid = lcid - start_rid;
-        for (unsigned lrid = 0; lrid < nclust; lrid++) {
-            for (unsigned rcid = 0; rcid < ncol; rcid++) {
-                innerprod->peq(lrid, rcid,
-                        um->get(lrid, lcid) * local_data[rrid*ncol+rcid]);
+        unsigned asgnd_clust = 0;
+        double max_um = std::numeric_limits<double>::min();
+        for (unsigned cid = 0; cid < nclust; cid++) {
+            rum[cid] = std::pow(rum[cid] / rowsum, fuzzindex);
+            if (rum[cid] > max_um) {
+                max_um = rum[cid];
+                asgnd_clust = cid;
             }
+
+            um_sum[cid] += rum[cid];
+            double* cip = &ip[cid*ncol];
+            for (size_t col = 0; col < ncol; col++)
+                cip[col] += rum[cid] * x[col];
         }
+        cluster_assignments[true_rid] = asgnd_clust;
     }
-#else
-    // For testing matrix mult
-    base::dense_matrix<double>* _data =
-        base::dense_matrix<double>::create(nprocrows, ncol);
-    _data->set(local_data);
-    auto ip = ((*um) * (*_data));
-    innerprod->copy_from(ip);
-    innerprod->print();
-#endif
 }
 
 void fcm::run() {
@@ -93,9 +101,6 @@ void fcm::run() {
         case E:
             Estep();
             break;
-        case M:
-            Mstep();
-            break;
         case EXIT:
             throw kbase::thread_exception(
                     "Thread state is EXIT but running!\n");
@@ -31,8 +31,11 @@ class fcm : public thread {
     protected:
         unsigned nprocrows; // How many rows to process
         base::dense_matrix<double>* centers;
-        base::dense_matrix<double>* um; // Contribution matrix
+        // Contribution matrix (nprocrows x nclust) of this threads rows
+        std::vector<double> um;
+        // Partition of result matrix of um.dot(data)
         base::dense_matrix<double>* innerprod;
+        std::vector<double> um_sum; // Column sums of um (nclust)
         unsigned nclust;
         unsigned fuzzindex;
 
@@ -41,33 +44,34 @@ class fcm : public thread {
                 const unsigned ncol,
                 const unsigned nclust,
                 const unsigned fuzzindex,
-                base::dense_matrix<double>* um,
+                unsigned* cluster_assignments,
                 base::dense_matrix<double>* centers,
-                // Partition of result matrix of um.dot(data)
                 const std::string fn, base::dist_t dist_metric);
     public:
         static thread::ptr create(
                 const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
                 const unsigned ncol, const unsigned nclust,
-                const unsigned fuzzindex, base::dense_matrix<double>* um,
+                const unsigned fuzzindex, unsigned* cluster_assignments,
                 base::dense_matrix<double>* centers,
                 const std::string fn, base::dist_t dist_metric) {
             return thread::ptr(
                     new fcm(node_id, thd_id, start_rid,
-                        nprocrows, ncol, nclust, fuzzindex, um,
-                        centers, fn, dist_metric));
+                        nprocrows, ncol, nclust, fuzzindex,
+                        cluster_assignments, centers, fn, dist_metric));
         }
 
         void start(const thread_state_t state) override;
         // Allocate and move data using this thread
         void Estep();
-        void Mstep();
 
         void run() override;
         base::dense_matrix<double>* get_innerprod() {
             return innerprod;
         }
+        const std::vector<double>& get_um_sum() const {
+            return um_sum;
+        }
         ~fcm();
 };
 }
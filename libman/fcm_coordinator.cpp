@@ -46,7 +46,7 @@ fcm_coordinator::fcm_coordinator(const std::string fn, const size_t nrow,
 
         this->centers = base::dense_matrix<double>::create(k, ncol);
         this->prev_centers = base::dense_matrix<double>::create(k, ncol);
-        this->um = base::dense_matrix<double>::create(k, nrow);
+        um_sum.resize(k);
 
         if (centers)
             this->centers->set(centers);
@@ -63,17 +63,19 @@ void fcm_coordinator::build_thread_state() {
         threads.push_back(
                 fcm::create((thd_id % nnodes),
                     thd_id, tup.first, tup.second,
-                    ncol, k, fuzzindex, um, centers, fn, _dist_t));
+                    ncol, k, fuzzindex, &cluster_assignments[0], centers,
+                    fn, _dist_t));
         threads[thd_id]->set_parent_cond(&cond);
         threads[thd_id]->set_parent_pending_threads(&pending_threads);
         threads[thd_id]->start(WAIT); // Thread puts itself to sleep
+        thd_innerprods.push_back(std::static_pointer_cast<fcm>(
+                    threads[thd_id])->get_innerprod()->as_pointer());
     }
 }
 
 fcm_coordinator::~fcm_coordinator() {
     delete (centers);
     delete (prev_centers);
-    delete (um);
 }
 
 void fcm_coordinator::forgy_init() {
@@ -94,32 +96,39 @@ void fcm_coordinator::forgy_init() {
 #endif
 }
 
-void fcm_coordinator::update_contribution_matrix() {
-    std::vector<double> colsums;
-    um->sum(0, colsums); // k x nrow
-    um->div_eq_pow(colsums, 0, fuzzindex);
-}
-
+/**
+  * Reduce the per-thread weighted sums into centers in place, in parallel
+  *  over the k x ncol entries.
+  */
 void fcm_coordinator::update_centers() {
-    if (threads.size() == 1) {
-        centers->copy_from(std::static_pointer_cast<fcm>(
-                    threads[0])->get_innerprod());
-    } else {
-        auto sum = *(std::static_pointer_cast<fcm>(threads[0])->get_innerprod()) +
-                *(std::static_pointer_cast<fcm>(threads[1])->get_innerprod());
-        centers->copy_from(sum);
-        delete (sum);
-
-        for (size_t tid = 2; tid < threads.size(); tid++) {
-            *centers += *(std::static_pointer_cast<fcm>(
-                            threads[tid])->get_innerprod());
-        }
+    std::fill(um_sum.begin(), um_sum.end(), 0);
+    for (auto const& th : threads) {
+        const std::vector<double>& thd_um_sum =
+            std::static_pointer_cast<fcm>(th)->get_um_sum();
+        for (unsigned cid = 0; cid < k; cid++)
+            um_sum[cid] += thd_um_sum[cid];
     }
 
-    // Take sum along axis
-    std::vector<double> sum;
-    um->sum(1, sum);
-    centers->div_eq(sum, 1);
+    double* cp = centers->as_pointer();
+    const size_t nelem = k*ncol;
+    const size_t nthd = thd_innerprods.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < nelem; i++) {
+        double sum = 0;
+        for (size_t tid = 0; tid < nthd; tid++)
+            sum += thd_innerprods[tid][i];
+        cp[i] = sum;
+    }
+
+    reduce_sums();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < nelem; i++)
+        cp[i] /= um_sum[i / ncol];
 }
 
 /**
@@ -153,45 +162,31 @@ base::cluster_t fcm_coordinator::run(double* allocd_data,
 #ifndef BIND
         std::cout << "Running iteration: "  << iter << std::endl;
 #endif
-        // Compute new um
+        // Compute new um and the per-thread center sums
         wake4run(E);
         wait4complete();
 
-        update_contribution_matrix();
-
-#if VERBOSE
-#ifndef BIND
-        std::cout << "After Estep contribution matrix is: \n";
-        um->print();
-#endif
-#endif
         // Compute new centers
         prev_centers->copy_from(centers);
-
-        wake4run(M);
-        wait4complete();
         update_centers();
 
 #if VERBOSE
 #ifndef BIND
-        std::cout << "After Mstep centers are: \n";
+        std::cout << "Updated centers are: \n";
         centers->print();
 #endif
 #endif
 
-        auto diff = (*centers - *prev_centers);
-        auto frob_norm = diff->frobenius_norm();
+        auto frob_norm = centers->frobenius_diff(*prev_centers);
 #ifndef BIND
         std::cout << "Centers frob diff: " << frob_norm << "\n\n";
 #endif
 
         if (frob_norm < tolerance) {
             converged = true;
-            delete (diff);
             break;
         }
 
-        delete (diff);
         iter++;
     }
 #ifdef PROFILER
@@ -215,7 +210,7 @@ base::cluster_t fcm_coordinator::run(double* allocd_data,
 #endif
     }
 
-    um->argmax(1, cluster_assignments);
+    // Assignments are from the last Estep
     cluster_assignment_counts.assign(k, 0);
     for (auto const& i : cluster_assignments)
         cluster_assignment_counts[i]++;
@@ -30,7 +30,8 @@ class fcm_coordinator : public coordinator {
         // max index stored within each threads partition
         base::dense_matrix<double>* centers; // k x ncol
         base::dense_matrix<double>* prev_centers; // k x ncol
-        base::dense_matrix<double>* um; // nrow x k
+        std::vector<const double*> thd_innerprods; // Per thread k x ncol
+        std::vector<double> um_sum; // Total membership of each cluster
         unsigned fuzzindex;
 
         fcm_coordinator(const std::string fn, const size_t nrow,
@@ -62,10 +63,17 @@ class fcm_coordinator : public coordinator {
         base::cluster_t run(double* allocd_data,
                 const bool numa_opt) override;
 
-        void update_contribution_matrix();
         void update_centers();
+        // Combine the summed center numerators (centers) and um_sum with
+        //  those computed elsewhere before they are divided
+        virtual void reduce_sums() { }
         void forgy_init() override;
         void build_thread_state() override;
+        // Every row counts once
+        void set_thd_weights_ptr(const double* w) override {
+            if (w)
+                throw base::not_implemented_exception();
+        }
 
         ~fcm_coordinator();
 };
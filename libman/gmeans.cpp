@@ -47,8 +47,7 @@ void gmeans::H_split_step() {
             continue; // Skip it
 
         const size_t offset = row*ncol;
-        auto const& v = std::static_pointer_cast<base::h_clusters>(
-                            g_hcltrs[part_id[true_row_id]])->metadata;
+        const double* v = g_hcltrs->get_metadata(part_id[true_row_id]);
 
         double dotprod = 0;
         for (size_t col = 0; col < ncol; col++)
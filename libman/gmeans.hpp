@@ -31,7 +31,7 @@ class gmeans : public xmeans {
                 const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
                 const unsigned ncol, unsigned k,
-                hclust_map& g_hcltrs,
+                base::hcluster_arena::ptr g_hcltrs,
                 unsigned* cluster_assignments, const std::string fn,
                 base::dist_t dist_metric,
                 const std::shared_ptr<base::thd_safe_bool_vector> cltr_active_vec,
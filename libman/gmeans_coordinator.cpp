@@ -29,6 +29,8 @@
 #include "AndersonDarling.hpp"
 #include "hclust_id_generator.hpp"
 #include "thd_safe_bool_vector.hpp"
+#include "member_index.hpp"
+#include "hcluster_arena.hpp"
 
 namespace knor {
 
@@ -38,10 +40,13 @@ gmeans_coordinator::gmeans_coordinator(const std::string fn,
         const unsigned nnodes, const unsigned nthreads,
         const double* centers, const base::init_t it,
         const double tolerance, const base::dist_t dt,
-        const unsigned min_clust_size, const short strictness) :
+        const unsigned min_clust_size, const short strictness,
+        const size_t ad_bins) :
     xmeans_coordinator(fn, nrow, ncol, k, max_iters, nnodes, nthreads,
             centers, it, tolerance, dt, min_clust_size),
-            strictness(strictness) {
+            strictness(strictness), ad_bins(ad_bins) {
+        part_index = base::member_index::create();
+        ad_buf.resize(nrow);
 }
 
 void gmeans_coordinator::deactivate(const unsigned id) {
@@ -76,78 +81,76 @@ void gmeans_coordinator::build_thread_state() {
     }
 }
 
-void gmeans_coordinator::assemble_ad_vecs(std::unordered_map<unsigned,
-        std::vector<double>>& ad_vecs) {
-    for (size_t i = 0; i < nearest_cdist.size(); i++) {
-        ad_vecs[part_id[i]].push_back(nearest_cdist[i]);
-    }
-}
-
-void gmeans_coordinator::compute_ad_stats(
-        std::unordered_map<unsigned, std::vector<double>>& ad_vecs) {
+// Group each row's projection by partition into ad_buf
+void gmeans_coordinator::assemble_ad_vecs() {
+    part_index->build(&part_id[0], nrow, max_nodes);
 
-    std::vector<unsigned> keys;
-    for (auto const& kv : ad_vecs)
-        keys.push_back(kv.first);
+    const unsigned* rids = part_index->data();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < part_index->nmembers(); i++)
+        ad_buf[i] = nearest_cdist[rids[i]];
+}
 
-    std::vector<double> scores(keys.size());
+void gmeans_coordinator::compute_ad_stats(const std::vector<size_t>& pids,
+        std::vector<double>& scores) {
+    scores.resize(pids.size());
 
-#pragma omp parallel for
-    for (size_t idx = 0; idx < keys.size(); idx++) {
-        double score = base::AndersonDarling::compute_statistic(
-                ad_vecs[keys[idx]].size(), &(ad_vecs[keys[idx]][0]));
-        scores[idx] = score;
+    // The statistic standardizes its input so the projections aren't scaled
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t idx = 0; idx < pids.size(); idx++) {
+        const size_t n = part_index->size(pids[idx]);
+        double* X = &ad_buf[part_index->offset(pids[idx])];
+
+        if (ad_bins && n > ad_bins)
+            scores[idx] = base::AndersonDarling::compute_statistic_binned(
+                    n, X, ad_bins);
+        else
+            scores[idx] = base::AndersonDarling::compute_statistic(n, X);
     }
+}
 
-    // NOTE: We push the score onto the back
-    for (size_t idx = 0; idx < keys.size(); idx++)
-        ad_vecs[keys[idx]].push_back(scores[idx]);
+const size_t gmeans_coordinator::count_partitions() const {
+    size_t nparts = 0;
+    for (size_t pid = 0; pid < part_index->get_nclust(); pid++)
+        if (part_index->size(pid))
+            nparts++;
+    return nparts;
 }
 
 // NOTE: This modifies hcltrs
 void gmeans_coordinator::partition_decision() {
-    // Each Anderson Darling (AD) vector represents the vector for which
-    //  each cluster gets its AD statistic.
-    std::unordered_map<unsigned, std::vector<double>> ad_vecs;
-    std::vector<double> critical_values;
+    // Populate the AD vectors. Each partition's projections are contiguous.
+    assemble_ad_vecs();
 
-    // Populate the AD vectors
-    assemble_ad_vecs(ad_vecs);
-
-    for (auto& kv : ad_vecs) {
-        base::linalg::scale(&(kv.second)[0], kv.second.size());
-    }
-
-    // Compute Critical values
-    base::AndersonDarling::compute_critical_values(
-            ad_vecs.size(), critical_values);
-
-    // Compute AD statistics
-    compute_ad_stats(ad_vecs);
+    std::vector<double> critical_values;
+    base::AndersonDarling::compute_critical_values(count_partitions(),
+            critical_values);
 
+    // Compute AD statistics for partitions still being split
     std::vector<size_t> keys;
+    hcltrs->get_keys(keys);
+    std::vector<double> scores;
+    compute_ad_stats(keys, scores);
 
-    hcltrs.get_keys(keys);
-    std::vector<bool> revert_cache;
-    auto max_pid = (*std::max_element(keys.begin(), keys.end()));
-    revert_cache.assign(max_pid+1, false);
-
-    // NOTE: We use ad_vecs.back() to store the score
+    std::vector<unsigned> reverted;
     for (size_t i = 0; i < keys.size(); i++) {
         unsigned pid = keys[i];
-        auto score = ad_vecs[pid].back();
 
-        if (score <= critical_values[strictness]) {
-            unsigned lid = hcltrs[pid]->get_zeroid();
-            unsigned rid = hcltrs[pid]->get_oneid();
+        if (scores[i] <= critical_values[strictness]) {
+            unsigned lid = hcltrs->get_zeroid(pid);
+            unsigned rid = hcltrs->get_oneid(pid);
 
             // Deactivate both lid and rid
             deactivate(lid); deactivate(rid);
             // Deactivate pid
             deactivate(pid);
 
-            revert_cache[pid] = true;
-            hcltrs.erase(pid);
+            reverted.push_back(pid);
+            hcltrs->erase(pid);
             // We can reuse these children ids
             ider->reclaim_id(lid);
             ider->reclaim_id(rid);
@@ -162,36 +165,37 @@ void gmeans_coordinator::partition_decision() {
         }
     }
 
-    // Assemble cluster membership
-    // TODO: Use dynamic or guided scheduler
+    // Row assignments in reverted partitions go back to the partition id
 #ifdef _OPENMP
-#pragma omp parallel for default(shared) firstprivate(revert_cache)
+#pragma omp parallel for schedule(dynamic)
 #endif
-    for (size_t rid = 0; rid < nrow; rid++) {
-        auto pid = part_id[rid];
-        // Ignore keys outside in hcltrs
-        if (pid < revert_cache.size() && revert_cache[pid]) {
-                // Means that row assignments needs to be reverted to part_id
-                cluster_assignments[rid] = pid;
-        }
+    for (size_t i = 0; i < reverted.size(); i++) {
+        const unsigned pid = reverted[i];
+        for (auto rid = part_index->begin(pid);
+                rid != part_index->end(pid); rid++)
+            cluster_assignments[*rid] = pid;
     }
 }
 
 void gmeans_coordinator::compute_cluster_diffs() {
-    auto itr = hcltrs.get_iterator();
-    while (itr.has_next()) {
-        auto kv = itr.next();
-        auto c = std::static_pointer_cast<base::h_clusters>(kv.second);
-        c->metadata.resize(ncol+1); // +1th index stores the divisor
+    hcltrs->set_metadata_size(ncol+1); // +1th index stores the divisor
+
+    std::vector<size_t> ids;
+    hcltrs->get_keys(ids);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < ids.size(); i++) {
+        double* v = hcltrs->get_metadata(ids[i]);
+        const double* mean0 = hcltrs->get_mean(ids[i], 0);
+        const double* mean1 = hcltrs->get_mean(ids[i], 1);
 
         // Compute difference
-        for (size_t i = 0; i < ncol; i++)
-            base::linalg::vdiff(c->get_mean_rawptr(0),
-                    c->get_mean_rawptr(1), ncol, c->metadata);
+        for (size_t col = 0; col < ncol; col++)
+            v[col] = mean0[col] - mean1[col];
 
         // Compute v.dot(v)
-        c->metadata[ncol] = base::linalg::dot(&c->metadata[0],
-                &c->metadata[0], ncol); // NOTE: last element intentionally ignored
+        v[ncol] = base::linalg::dot(v, v, ncol);
     }
 }
 
@@ -231,6 +235,7 @@ base::cluster_t gmeans_coordinator::run(
             printf("\nNCLUST: %lu, Iteration: %lu\n", curr_nclust, iter);
 #endif
             // Now pick between the cluster splits
+            hcltrs->assign_slots();
             wake4run(H_EM);
             wait4complete();
             update_clusters();
@@ -262,7 +267,7 @@ base::cluster_t gmeans_coordinator::run(
         init_splits(); // Initialize possible splits
 
         // Break when clusters are inactive due to size
-        if (hcltrs.keyless()) {
+        if (hcltrs->keyless()) {
             assert(steady_state()); // NOTE: Comment when benchmarking
 #ifndef BIND
             printf("\n\nSTEADY STATE EXIT!\n");
@@ -24,10 +24,15 @@
 namespace knor {
 
 class gmeans_coordinator : public xmeans_coordinator {
-    private:
+    protected:
         const short strictness;
+        // Buckets for the binned AD statistic. 0 sorts every partition.
+        const size_t ad_bins;
         std::vector<double> cluster_diff_v;
         std::vector<double> cluster_diff_scalar;
+        // Rows of each partition and their projections grouped to match
+        std::shared_ptr<base::member_index> part_index;
+        std::vector<double> ad_buf;
 
     public:
         gmeans_coordinator(const std::string fn, const size_t nrow,
@@ -35,7 +40,8 @@ class gmeans_coordinator : public xmeans_coordinator {
                 const unsigned nnodes, const unsigned nthreads,
                 const double* centers, const base::init_t it,
                 const double tolerance, const base::dist_t dt,
-                const unsigned min_clust_size, const short strictness);
+                const unsigned min_clust_size, const short strictness,
+                const size_t ad_bins);
 
         typedef std::shared_ptr<gmeans_coordinator> ptr;
 
@@ -45,7 +51,8 @@ class gmeans_coordinator : public xmeans_coordinator {
                 const unsigned nnodes, const unsigned nthreads,
                 const double* centers=NULL, const std::string init="kmeanspp",
                 const double tolerance=-1, const std::string dist_type="eucl",
-                const unsigned min_clust_size=2, const short strictness=4) {
+                const unsigned min_clust_size=2, const short strictness=4,
+                const size_t ad_bins=0) {
 
             base::init_t _init_t = base::get_init_type(init);
             base::dist_t _dist_t = base::get_dist_type(dist_type);
@@ -60,7 +67,7 @@ class gmeans_coordinator : public xmeans_coordinator {
             return xmeans_coordinator::ptr(
                     new gmeans_coordinator(fn, nrow, ncol, k, max_iters,
                     nnodes, nthreads, centers, _init_t, tolerance, _dist_t,
-                    min_clust_size, strictness));
+                    min_clust_size, strictness, ad_bins));
         }
 
         void build_thread_state() override;
@@ -69,10 +76,11 @@ class gmeans_coordinator : public xmeans_coordinator {
             const bool numa_opt=false) override;
         void partition_decision() override;
         void compute_cluster_diffs();
-        void assemble_ad_vecs(std::unordered_map<unsigned,
-                std::vector<double>>& ad_vecs);
-        void compute_ad_stats(
-                std::unordered_map<unsigned, std::vector<double>>& ad_vecs);
+        virtual void assemble_ad_vecs();
+        // Partitions with members, which scale the critical values
+        virtual const size_t count_partitions() const;
+        virtual void compute_ad_stats(const std::vector<size_t>& pids,
+                std::vector<double>& scores);
         void deactivate(const unsigned id) override;
         void activate(const unsigned id) override;
 };
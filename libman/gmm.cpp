@@ -20,6 +20,8 @@
 #include <math.h>
 #include <iostream>
 #include <cassert>
+#include <limits>
+#include <algorithm>
 
 #include "gmm.hpp"
 #include "types.hpp"
@@ -27,19 +29,23 @@
 #include "io.hpp"
 #include "linalg.hpp"
 
+// Responsibilities below this contribute nothing measurable to the M-step
+#define MIN_RESP 1E-10
+
 namespace knor {
 gmm::gmm(const int node_id, const unsigned thd_id,
         const unsigned start_rid,
         const unsigned nprocrows, const unsigned ncol,
+        unsigned* cluster_assignments,
         const std::string fn, kbase::dist_t dist_metric) :
             thread(node_id, thd_id, ncol,
-            NULL, start_rid, fn, dist_metric), nprocrows(nprocrows),
-            L(0){
+            cluster_assignments, start_rid, fn, dist_metric),
+            nprocrows(nprocrows), L(0) {
 
             local_clusters = nullptr;
             set_data_size(sizeof(double)*nprocrows*ncol);
 #if VERBOSE
-#ifndef
+#ifndef BIND
             std::cout << "Initializing gmm. Metadata: thd_id: "
                 << this->thd_id << ", start_rid: " << this->start_rid <<
                 ", node_id: " << this->node_id << ", nprocrows: " <<
@@ -48,58 +54,214 @@ gmm::gmm(const int node_id, const unsigned thd_id,
 #endif
         }
 
-void gmm::set_alg_metadata(unsigned k, base::dense_matrix<double>* mu_k,
-        base::dense_matrix<double>** sigma_k, base::dense_matrix<double>* P_nk,
-        double* Pk, base::dense_matrix<double>** isk, double* dets,
-        double* Px) {
+void gmm::set_alg_metadata(unsigned k, base::cov_t cov_type,
+        base::dense_matrix<double>* mu_k,
+        base::dense_matrix<double>** chol_sigma_k, double* inv_std_k,
+        base::dense_matrix<double>* P_nk, double* Pk, double* logdets) {
     this->k = k;
+    this->cov_type = cov_type;
     this->mu_k = mu_k;
-    this->sigma_k = sigma_k;
+    this->chol_sigma_k = chol_sigma_k;
+    this->inv_std_k = inv_std_k;
     this->P_nk = P_nk;
-    inv_sigma_k = isk;
-    this->dets = dets;
     this->Pk = Pk;
-    this->Px = Px;
+    this->logdets = logdets;
 }
 
-void gmm::Estep() {
-    // Compute Pnk
-    L = 0; // Reset
+const size_t gmm::sum_xx_size(const base::cov_t cov_type,
+        const unsigned k, const size_t ncol) {
+    switch (cov_type) {
+        case base::cov_t::FULL:
+            return k*ncol*ncol;
+        case base::cov_t::TIED:
+            return ncol*ncol;
+        case base::cov_t::DIAG:
+            return k*ncol;
+        case base::cov_t::SPHERICAL:
+            return k;
+        default:
+            throw base::parameter_exception("Unknown covariance type");
+    }
+}
+
+/**
+  * Squared Mahalanobis distance of x to every component. Leaves x - mu_k in
+  *  diff for accumulate. No covariance inverse is ever formed.
+  */
+template <base::cov_t C>
+void gmm::mahalanobis(const double* x, double* maha) {
+    const double* means = mu_k->as_pointer();
+
+    for (unsigned cid = 0; cid < k; cid++) {
+        double* d = &diff[cid*ncol];
+        const double* mean = &means[cid*ncol];
+        for (size_t col = 0; col < ncol; col++)
+            d[col] = x[col] - mean[col];
+    }
+
+    for (unsigned cid = 0; cid < k; cid++) {
+        const double* d = &diff[cid*ncol];
+        double sum = 0;
+        if (C == base::cov_t::FULL || C == base::cov_t::TIED) {
+            const double* chol = chol_sigma_k[
+                C == base::cov_t::FULL ? cid : 0]->as_pointer();
+            // ||L^{-1}(x - mu)||^2
+            base::linalg::forward_sub(chol, d, &z[0], ncol);
+            for (size_t col = 0; col < ncol; col++)
+                sum += z[col]*z[col];
+        } else if (C == base::cov_t::DIAG) {
+            const double* inv_std = &inv_std_k[cid*ncol];
+            for (size_t col = 0; col < ncol; col++) {
+                double v = d[col]*inv_std[col];
+                sum += v*v;
+            }
+        } else {
+            for (size_t col = 0; col < ncol; col++)
+                sum += d[col]*d[col];
+            sum *= inv_std_k[cid]*inv_std_k[cid];
+        }
+        maha[cid] = sum;
+    }
+}
+
+/**
+  * Add row contribution with responsibility r to the component cid
+  *  sufficient statistics. Expects diff to hold x - mu_k.
+  */
+template <base::cov_t C>
+void gmm::accumulate(const double r, const unsigned cid) {
+    Nk[cid] += r;
+    const double* d = &diff[cid*ncol];
+    double* sx = &sum_x[cid*ncol];
+    for (size_t i = 0; i < ncol; i++)
+        sx[i] += r*d[i];
+
+    if (C == base::cov_t::FULL || C == base::cov_t::TIED) {
+        double* sxx = (C == base::cov_t::FULL) ?
+            &sum_xx[cid*ncol*ncol] : &sum_xx[0];
+        for (size_t i = 0; i < ncol; i++) {
+            double rd = r*d[i];
+            // Lower triangle only
+            for (size_t j = 0; j <= i; j++)
+                sxx[i*ncol+j] += rd*d[j];
+        }
+    } else if (C == base::cov_t::DIAG) {
+        double* sxx = &sum_xx[cid*ncol];
+        for (size_t i = 0; i < ncol; i++)
+            sxx[i] += r*d[i]*d[i];
+    } else {
+        double sum = 0;
+        for (size_t i = 0; i < ncol; i++)
+            sum += d[i]*d[i];
+        sum_xx[cid] += r*sum;
+    }
+}
+
+/**
+  * The E-step over this thread's rows for one covariance type, so the
+  *  per row work has no dispatch on it.
+  */
+template <base::cov_t C>
+void gmm::estep_rows(const std::vector<double>& log_norm) {
+    std::vector<double> log_resp(k);
+
     for (unsigned row = 0; row < nprocrows; row++) {
         unsigned true_row_id = get_global_data_id(row);
 
+        mahalanobis<C>(&local_data[row*ncol], &log_resp[0]);
+
+        double max_lr = -std::numeric_limits<double>::max();
+        unsigned asgnd_clust = 0;
         for (unsigned cid = 0; cid < k; cid++) {
-            std::vector<double> diff(ncol);
-            base::linalg::vdiff(&local_data[row*ncol],
-                    &(mu_k->as_pointer()[row*ncol]), ncol, diff);
-
-            std::vector<double> resdot(inv_sigma_k[cid]->get_ncol());
-            base::linalg::dot(&diff[0],
-                    inv_sigma_k[cid]->as_pointer(),
-                    inv_sigma_k[cid]->get_nrow(),
-                    inv_sigma_k[cid]->get_ncol(), resdot);
-            double lhs = -.5*(base::linalg::dot(resdot, diff));
-            double rhs = .5*M*std::log2(2*M_PI) - (.5*std::log2(dets[cid]));
-            double gaussian_density = lhs - rhs; // for one of the k guassians
-
-            auto tmp = gaussian_density * Pk[cid];
-            Px[true_row_id] += tmp;
-            P_nk->set(row, cid, tmp);
+            log_resp[cid] = log_norm[cid] - .5*log_resp[cid];
+            if (log_resp[cid] > max_lr) {
+                max_lr = log_resp[cid];
+                asgnd_clust = cid;
+            }
         }
 
-        // Finish P_nk
+        // log-sum-exp for the marginal likelihood of the row
+        double sum = 0;
+        for (unsigned cid = 0; cid < k; cid++)
+            sum += std::exp(log_resp[cid] - max_lr);
+        double log_px = max_lr + std::log(sum);
+        L += log_px;
+
+        double* resp = &(P_nk->as_pointer()[true_row_id*k]);
         for (unsigned cid = 0; cid < k; cid++) {
-            P_nk->set(row, cid, P_nk->get(row, cid)/Px[true_row_id]);
+            double r = std::exp(log_resp[cid] - log_px);
+            resp[cid] = r;
+            if (r >= MIN_RESP)
+                accumulate<C>(r, cid);
         }
 
-        // L is Per thread
-        if (L == 0) L = Px[true_row_id];
-        else L *= Px[true_row_id];
+        if (asgnd_clust != cluster_assignments[true_row_id])
+            meta.num_changed++;
+        cluster_assignments[true_row_id] = asgnd_clust;
     }
 }
 
-void gmm::Mstep() {
+/**
+  * Compute the responsibilities of each row and accumulate the sufficient
+  *  statistics needed by the coordinator for the M-step.
+  */
+void gmm::Estep() {
+    // First touch happens here so the accumulators are NUMA local
+    if (Nk.size() != k) {
+        Nk.resize(k);
+        sum_x.resize(k*ncol);
+        sum_xx.resize(sum_xx_size(cov_type, k, ncol));
+        diff.resize(k*ncol);
+        z.resize(ncol);
+    }
+
+    std::fill(Nk.begin(), Nk.end(), 0);
+    std::fill(sum_x.begin(), sum_x.end(), 0);
+    std::fill(sum_xx.begin(), sum_xx.end(), 0);
+    meta.num_changed = 0;
+    L = 0;
 
+    const double log2pi = ncol*std::log(2*M_PI);
+    std::vector<double> log_norm(k);
+    for (unsigned cid = 0; cid < k; cid++)
+        log_norm[cid] = std::log(Pk[cid]) - .5*(log2pi + logdets[cid]);
+
+    switch (cov_type) {
+        case base::cov_t::FULL:
+            estep_rows<base::cov_t::FULL>(log_norm);
+            break;
+        case base::cov_t::TIED:
+            estep_rows<base::cov_t::TIED>(log_norm);
+            break;
+        case base::cov_t::DIAG:
+            estep_rows<base::cov_t::DIAG>(log_norm);
+            break;
+        case base::cov_t::SPHERICAL:
+            estep_rows<base::cov_t::SPHERICAL>(log_norm);
+            break;
+        default:
+            throw base::parameter_exception("Unknown covariance type");
+    }
+}
+
+/** Method for a distance computation vs a single cluster.
+ * Used in kmeans++ init
+ */
+void gmm::kmspp_dist() {
+    unsigned clust_idx = meta.clust_idx;
+    for (unsigned row = 0; row < nprocrows; row++) {
+        unsigned true_row_id = get_global_data_id(row);
+
+        double dist = kbase::dist_comp_raw<double>(&local_data[row*ncol],
+                &(mu_k->as_pointer()[clust_idx*ncol]), ncol,
+                dist_metric);
+
+        if (dist < dist_v[true_row_id]) { // Found a closer cluster than before
+            dist_v[true_row_id] = dist;
+            cluster_assignments[true_row_id] = clust_idx;
+        }
+        cuml_dist += dist_v[true_row_id];
+    }
 }
 
 void gmm::run() {
@@ -110,12 +272,12 @@ void gmm::run() {
         case ALLOC_DATA:
             numa_alloc_mem();
             break;
+        case KMSPP_INIT:
+            kmspp_dist();
+            break;
         case E:
             Estep();
             break;
-        case M:
-            Mstep();
-            break;
         case EXIT:
             throw kbase::thread_exception(
                     "Thread state is EXIT but running!\n");
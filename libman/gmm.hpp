@@ -34,43 +34,69 @@ class gmm : public thread {
          // Pointer to global cluster data
         unsigned nprocrows; // How many rows to process
         unsigned k;
+        base::cov_t cov_type;
         base::dense_matrix<double>* mu_k;
-        base::dense_matrix<double>* local_mu_k;
-        base::dense_matrix<double>** sigma_k;
+        // Cholesky factor of sigma. One per component for FULL, one for TIED
+        base::dense_matrix<double>** chol_sigma_k;
+        // Inverse standard deviations. k x ncol for DIAG, k for SPHERICAL
+        double* inv_std_k;
         base::dense_matrix<double>* P_nk;
         double* Pk;
-        double* dets; // The determinant of each covariance matrix
-        base::dense_matrix<double>** inv_sigma_k; // Inverse of sigma
-        double* Px;
-        double L;
+        double* logdets; // The log determinant of each covariance matrix
+        double L; // Log-likelihood of this threads rows
+
+        // Sufficient statistics accumulated during the E-step. The first
+        //  and second moments are centered on the current means. sum_xx is
+        //  k x ncol x ncol (FULL), ncol x ncol (TIED), k x ncol (DIAG) or
+        //  k (SPHERICAL).
+        std::vector<double> Nk; // Soft membership count (k)
+        std::vector<double> sum_x; // Weighted diff sum (k x ncol)
+        std::vector<double> sum_xx; // Weighted second moment
+        std::vector<double> diff; // Scratch (k x ncol)
+        std::vector<double> z; // Scratch (ncol)
+
+        template <base::cov_t C>
+            void mahalanobis(const double* x, double* maha);
+        template <base::cov_t C>
+            void accumulate(const double r, const unsigned cid);
+        template <base::cov_t C>
+            void estep_rows(const std::vector<double>& log_norm);
 
         gmm(const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
-                const unsigned ncol,
+                const unsigned ncol, unsigned* cluster_assignments,
                 const std::string fn, kbase::dist_t dist_metric);
     public:
         static thread::ptr create(
                 const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
-                const unsigned ncol,
+                const unsigned ncol, unsigned* cluster_assignments,
                 const std::string fn,
-
                 kbase::dist_t dist_metric) {
             return thread::ptr(
                     new gmm(node_id, thd_id, start_rid,
-                        nprocrows, ncol, fn, dist_metric));
+                        nprocrows, ncol, cluster_assignments, fn,
+                        dist_metric));
         }
 
-        void set_alg_metadata(unsigned k, base::dense_matrix<double>* mu_k,
-                base::dense_matrix<double>** sigma_k,
+        void set_alg_metadata(unsigned k, base::cov_t cov_type,
+                base::dense_matrix<double>* mu_k,
+                base::dense_matrix<double>** chol_sigma_k, double* inv_std_k,
                 base::dense_matrix<double>* P_nk, double* Pk,
-                base::dense_matrix<double>** isk, double* dets, double* Px);
+                double* logdets);
 
+        // Length of sum_xx for this covariance structure
+        static const size_t sum_xx_size(const base::cov_t cov_type,
+                const unsigned k, const size_t ncol);
         double get_L() { return L; }
+        const std::vector<double>& get_Nk() const { return Nk; }
+        const std::vector<double>& get_sum_x() const { return sum_x; }
+        const std::vector<double>& get_sum_xx() const { return sum_xx; }
+
         void start(const thread_state_t state) override;
         // Allocate and move data using this thread
         void Estep();
-        void Mstep();
+        void kmspp_dist();
         virtual void run() override;
 };
 }
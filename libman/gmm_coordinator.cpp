@@ -20,6 +20,12 @@
 #include <random>
 #include <stdexcept>
 #include <algorithm>
+#include <limits>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "gmm_coordinator.hpp"
 #include "gmm.hpp"
@@ -34,25 +40,52 @@ gmm_coordinator::gmm_coordinator(const std::string fn, const size_t nrow,
                 const unsigned nnodes, const unsigned nthreads,
                 const base::init_t it,
                 const double tolerance, const base::dist_t dt,
-                const double cov_regularizer) :
+                const double cov_regularizer, const base::cov_t ct) :
     coordinator(fn, nrow, ncol, k, max_iters,
             nnodes, nthreads, mu_k, it, tolerance, dt) {
 
         this->cov_regularizer = cov_regularizer;
+        this->cov_type = ct;
         this->k = k;
         this->mu_k = base::dense_matrix<double>::create(k, ncol);
 
-        for (unsigned i = 0; i < k; i++) {
+        // Only the structured covariances are stored. Start from unit ones.
+        size_t nmats = 0;
+        switch (cov_type) {
+            case base::cov_t::FULL:
+                nmats = k;
+                break;
+            case base::cov_t::TIED:
+                nmats = 1;
+                break;
+            case base::cov_t::DIAG:
+                var_k.assign(k*ncol, 1);
+                break;
+            case base::cov_t::SPHERICAL:
+                var_k.assign(k, 1);
+                break;
+            default:
+                throw base::parameter_exception("Unknown covariance type");
+        }
+        inv_std_k.resize(var_k.size());
+
+        for (size_t i = 0; i < nmats; i++) {
             sigma_k.push_back(base::dense_matrix<double>::create(ncol, ncol));
-            inv_sigma_k.push_back(
+            chol_sigma_k.push_back(
                     base::dense_matrix<double>::create(ncol, ncol));
+            sigma_k[i]->zero();
+            for (size_t col = 0; col < ncol; col++)
+                sigma_k[i]->set(col, col, 1);
         }
 
         this->P_nk = base::dense_matrix<double>::create(nrow, k);
-        this->Pk.resize(k);
-        this->dets.resize(k);
-        this->Px.assign(nrow, 0);
-        Pnk_sum.resize(k);
+        this->Pk.assign(k, 1.0/k);
+        this->logdets.resize(k);
+        this->L = 0;
+        this->g_nrow = nrow;
+#ifdef _OPENMP
+        omp_set_num_threads(this->nthreads);
+#endif
 
         if (mu_k) {
             this->_init_t = base::init_t::NONE;
@@ -69,34 +102,29 @@ void gmm_coordinator::build_thread_state() {
         std::pair<unsigned, unsigned> tup = get_rid_len_tup(thd_id);
         thd_max_row_idx.push_back((thd_id*thds_row) + tup.second);
         threads.push_back(gmm::create((thd_id % nnodes),
-                    thd_id, tup.first, tup.second, ncol, fn, _dist_t));
+                    thd_id, tup.first, tup.second, ncol,
+                    &cluster_assignments[0], fn, _dist_t));
         threads[thd_id]->set_parent_cond(&cond);
         threads[thd_id]->set_parent_pending_threads(&pending_threads);
         threads[thd_id]->start(WAIT); // Thread puts itself to sleep
         std::static_pointer_cast<gmm>(threads[thd_id])->set_alg_metadata(
-                k, mu_k, &(sigma_k[0]), P_nk, &Pk[0],
-                &inv_sigma_k[0], &dets[0], &Px[0]);
+                k, cov_type, mu_k, chol_sigma_k.data(), inv_std_k.data(),
+                P_nk, &Pk[0], &logdets[0]);
     }
 }
 
+/**
+  * M-step: reduce the per-thread sufficient statistics into new mixing
+  *  weights, means and covariances then refactor the covariances.
+  */
 void gmm_coordinator::update_clusters() {
-    L = 0; // Reset
-    Pnk_sum.assign(k, 0);
-    for (size_t row = 0; row < nrow; row++) {
-        for (size_t col = 0; col < ncol; col++) {
-            Pnk_sum[col] += P_nk->get(row, col);
-        }
-    }
-
-    for (auto const& th : threads) {
-        // Now L is complete
-        L += std::static_pointer_cast<gmm>(th)->get_L();
-    }
-
+    reduce_stats();
+    L = stats[stats.size() - 2];
+    num_changed = static_cast<size_t>(stats.back());
 
+    compute_cov_mat();
     // Updates pointer data in threads
     compute_shared_linalg();
-    Px.assign(nrow, 0); // reset
 }
 
 void gmm_coordinator::kmeanspp_init() {
@@ -128,7 +156,7 @@ void gmm_coordinator::kmeanspp_init() {
 // Sum the per thread cumulative dists
         double cuml_dist = reduction_on_cuml_sum();
 
-        cuml_dist = (cuml_dist * ur_distribution(generator)) / (RAND_MAX - 1.0);
+        cuml_dist *= ur_distribution(generator);
         if (++clust_idx >= k)  // No more  needed
             break;
 
@@ -196,37 +224,218 @@ void gmm_coordinator::random_prob_fill(std::vector<double>& v,
         v[i] /= sum;
 }
 
+/**
+  * Sum the threads' sufficient statistics, log-likelihoods and number of
+  *  changed assignments into stats, in parallel over its entries.
+  */
+void gmm_coordinator::reduce_stats() {
+    const size_t sum_x_end = k + k*ncol;
+    const size_t nsums = sum_x_end + gmm::sum_xx_size(cov_type, k, ncol);
+    stats.assign(nsums + 2, 0);
+
+    std::vector<std::shared_ptr<gmm> > gths;
+    for (auto const& th : threads) {
+        auto gth = std::static_pointer_cast<gmm>(th);
+        stats[nsums] += gth->get_L();
+        stats[nsums + 1] += gth->get_num_changed();
+        if (!gth->get_Nk().empty())
+            gths.push_back(gth);
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < nsums; i++) {
+        double sum = 0;
+        for (auto const& gth : gths) {
+            if (i < k)
+                sum += gth->get_Nk()[i];
+            else if (i < sum_x_end)
+                sum += gth->get_sum_x()[i - k];
+            else
+                sum += gth->get_sum_xx()[i - sum_x_end];
+        }
+        stats[i] = sum;
+    }
+}
+
+/**
+  * Threads accumulate moments centered on the current means so
+  *  Sigma = S2/Nk - d*d^T with d = S1/Nk is numerically stable and
+  *  the new mean is mu + d.
+  */
 void gmm_coordinator::compute_cov_mat() {
-    throw base::not_implemented_exception(); // TODO
+    std::vector<double> delta(k*ncol, 0);
+    std::vector<double> Nks(k);
+    const double* g_Nk = &stats[0];
+    const double* g_sum_x = g_Nk + k;
+    const double* g_sum_xx = g_sum_x + k*ncol;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (unsigned cid = 0; cid < k; cid++) {
+        double Nk = 10*std::numeric_limits<double>::epsilon() + g_Nk[cid];
+        double* S1 = &delta[cid*ncol];
+        for (size_t i = 0; i < ncol; i++)
+            S1[i] = g_sum_x[cid*ncol+i] / Nk;
+
+        switch (cov_type) {
+            case base::cov_t::FULL:
+                {
+                    double* cov = sigma_k[cid]->as_pointer();
+                    const double* sxx = &g_sum_xx[cid*ncol*ncol];
+                    for (size_t i = 0; i < ncol; i++) {
+                        for (size_t j = 0; j <= i; j++) {
+                            cov[i*ncol+j] = sxx[i*ncol+j]/Nk - S1[i]*S1[j];
+                            cov[j*ncol+i] = cov[i*ncol+j];
+                        }
+                        cov[i*ncol+i] += cov_regularizer;
+                    }
+                }
+                break;
+            case base::cov_t::DIAG:
+                {
+                    double* var = &var_k[cid*ncol];
+                    const double* sxx = &g_sum_xx[cid*ncol];
+                    for (size_t i = 0; i < ncol; i++)
+                        var[i] = sxx[i]/Nk - S1[i]*S1[i] + cov_regularizer;
+                }
+                break;
+            case base::cov_t::SPHERICAL:
+                {
+                    double sq_delta = 0;
+                    for (size_t i = 0; i < ncol; i++)
+                        sq_delta += S1[i]*S1[i];
+                    var_k[cid] = (g_sum_xx[cid]/Nk - sq_delta)/ncol +
+                        cov_regularizer;
+                }
+                break;
+            default: // TIED is reduced across components below
+                break;
+        }
+
+        double* mean = &(mu_k->as_pointer()[cid*ncol]);
+        for (size_t i = 0; i < ncol; i++)
+            mean[i] += S1[i];
+        Nks[cid] = Nk;
+        Pk[cid] = Nk / g_nrow;
+    }
+
+    if (cov_type == base::cov_t::TIED) {
+        // sum_c sum_n r(x - mu_c)(x - mu_c)^T over the new means
+        double* cov = sigma_k[0]->as_pointer();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-    for (size_t i = 0; i < mu_k->get_nrow(); i++) {
+        for (size_t i = 0; i < ncol; i++) {
+            for (size_t j = 0; j <= i; j++) {
+                double sum = g_sum_xx[i*ncol+j];
+                for (unsigned cid = 0; cid < k; cid++)
+                    sum -= Nks[cid]*delta[cid*ncol+i]*delta[cid*ncol+j];
+                cov[i*ncol+j] = sum/g_nrow;
+            }
+        }
+
+        for (size_t i = 0; i < ncol; i++) {
+            for (size_t j = 0; j < i; j++)
+                cov[j*ncol+i] = cov[i*ncol+j];
+            cov[i*ncol+i] += cov_regularizer;
+        }
     }
 }
 
 void gmm_coordinator::random_partition_init() {
     forgy_init();
-
     random_prob_fill(Pk);
-    random_prob_fill(P_nk);
-    for (auto const& cov : sigma_k)
-        random_prob_fill(cov);
 }
 
 void gmm_coordinator::compute_shared_linalg() {
-    // Compute Inverse sigma
-    dets.clear();
-    for (size_t cid = 0; cid < k; cid++) {
-        base::linalg::inverse(sigma_k[cid]->as_pointer(),
-                inv_sigma_k[cid]->as_pointer(), sigma_k[cid]->get_nrow());
-        dets[cid] = base::linalg::determinant(sigma_k[cid]->as_pointer(),
-                sigma_k[cid]->get_nrow(), sigma_k[cid]->get_nrow());
+    bool pd = true;
+
+    switch (cov_type) {
+        case base::cov_t::FULL:
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (unsigned cid = 0; cid < k; cid++) {
+                if (base::linalg::cholesky(sigma_k[cid]->as_pointer(),
+                            chol_sigma_k[cid]->as_pointer(), ncol))
+                    logdets[cid] = base::linalg::chol_logdet(
+                            chol_sigma_k[cid]->as_pointer(), ncol);
+                else
+                    pd = false;
+            }
+            break;
+        case base::cov_t::TIED:
+            pd = base::linalg::cholesky(sigma_k[0]->as_pointer(),
+                    chol_sigma_k[0]->as_pointer(), ncol);
+            if (pd)
+                logdets.assign(k, base::linalg::chol_logdet(
+                            chol_sigma_k[0]->as_pointer(), ncol));
+            break;
+        case base::cov_t::DIAG:
+        case base::cov_t::SPHERICAL:
+            {
+                // Spherical components have one variance for all ncol dims
+                const size_t nvar = var_k.size() / k;
+                const size_t mult = (nvar == 1) ? ncol : 1;
+                for (unsigned cid = 0; cid < k; cid++) {
+                    double logdet = 0;
+                    for (size_t i = cid*nvar; i < (cid+1)*nvar; i++) {
+                        if (var_k[i] <= 0) {
+                            pd = false;
+                            break;
+                        }
+                        inv_std_k[i] = 1/std::sqrt(var_k[i]);
+                        logdet += mult*std::log(var_k[i]);
+                    }
+                    logdets[cid] = logdet;
+                }
+            }
+            break;
+        default:
+            throw base::parameter_exception("Unknown covariance type");
+    }
+
+    if (!pd)
+        throw base::parameter_exception("Covariance matrix is not positive "
+                "definite. Try increasing the covariance regularizer");
+}
+
+/**
+  * Expand the stored covariance structure into k ncol x ncol matrices
+  */
+base::gmm_t gmm_coordinator::build_gmm_t(const size_t iter) {
+    if (cov_type == base::cov_t::FULL)
+        return base::gmm_t(this->nrow, this->ncol, iter, this->k,
+                mu_k->as_pointer(), this->sigma_k,
+                P_nk->as_pointer(), &Pk[0]);
+
+    std::vector<base::dense_matrix<double>*> cov_mats;
+    for (unsigned cid = 0; cid < k; cid++) {
+        if (cov_type == base::cov_t::TIED) {
+            cov_mats.push_back(base::dense_matrix<double>::create(sigma_k[0]));
+            continue;
+        }
+
+        base::dense_matrix<double>* cov =
+            base::dense_matrix<double>::create(ncol, ncol, true);
+        for (size_t i = 0; i < ncol; i++)
+            cov->set(i, i, (cov_type == base::cov_t::DIAG) ?
+                    var_k[cid*ncol+i] : var_k[cid]);
+        cov_mats.push_back(cov);
     }
+
+    base::gmm_t ret(this->nrow, this->ncol, iter, this->k,
+            mu_k->as_pointer(), cov_mats, P_nk->as_pointer(), &Pk[0]);
+    for (auto cov : cov_mats)
+        delete cov;
+    return ret;
 }
 
 /**
- * Main driver for kmeans
+ * Main driver for gmm
  */
 base::gmm_t gmm_coordinator::soft_run(double* allocd_data) {
 #ifdef PROFILER
@@ -244,26 +453,9 @@ base::gmm_t gmm_coordinator::soft_run(double* allocd_data) {
     gettimeofday(&start , NULL);
     run_init(); // Initialize clusters
 
-    ////////////////////////////////////////////////////////////////////////////
-#ifndef BIND
-    std::cout << "\nAFTER INIT:\nPk:\n";
-    base::print(Pk);
-    std::cout << "mu_k:\n"; mu_k->print();
-    std::cout << "P_nk:\n"; P_nk->print();
-    std::cout << "cov_regularizer: " << cov_regularizer << "\n"
-        << "sigma_k:\n";
-    for (auto const& cov : sigma_k) {
-        cov->print();
-        std::cout << "\n";
-    }
-    std::cout << "\n\n";
-    std::cout << "DATA:\n";
-    print_thread_data();
-    exit(911);
-#endif
-    ////////////////////////////////////////////////////////////////////////////
+    compute_shared_linalg();
 
-    // Run kmeans loop
+    // Run EM loop
     bool converged = false;
     size_t iter = 0;
 
@@ -277,18 +469,18 @@ base::gmm_t gmm_coordinator::soft_run(double* allocd_data) {
         wake4run(E);
         wait4complete();
 
+        double prev_L = L;
         update_clusters();
-        wake4run(M);
 
 #if VERBOSE
 #ifndef BIND
-        printf("Cluster assignment counts: \n");
+        printf("Iter: %lu, log-likelihood: %.6f, changed: %lu\n",
+                iter, L, num_changed);
 #endif
-        base::print(cluster_assignment_counts);
 #endif
 
-        if (num_changed == 0 ||
-                ((num_changed/(double)nrow)) <= tolerance) {
+        // Converge when the mean log-likelihood stops improving
+        if (iter > 1 && std::abs(L - prev_L)/g_nrow <= tolerance) {
             converged = true;
             break;
         }
@@ -315,15 +507,26 @@ base::gmm_t gmm_coordinator::soft_run(double* allocd_data) {
 #endif
     }
 
+    cluster_assignment_counts.assign(k, 0);
+    for (auto const& i : cluster_assignments)
+        cluster_assignment_counts[i]++;
+
 #ifndef BIND
+    printf("Final log-likelihood: %.6f\n", L);
     printf("Final cluster counts: \n");
     base::print(cluster_assignment_counts);
     printf("\n******************************************\n");
 #endif
 
-    return base::gmm_t(this->nrow, this->ncol, iter, this->k,
-            mu_k->as_pointer(), this->sigma_k,
-            P_nk->as_pointer(), &Pk[0]);
+    return build_gmm_t(iter);
+}
+
+base::cluster_t gmm_coordinator::run(double* allocd_data,
+        const bool numa_opt) {
+    base::gmm_t ret = soft_run(allocd_data);
+    return base::cluster_t(this->nrow, this->ncol, ret.iters, this->k,
+            &cluster_assignments[0], &cluster_assignment_counts[0],
+            ret.means);
 }
 
 gmm_coordinator::~gmm_coordinator() {
@@ -331,7 +534,7 @@ gmm_coordinator::~gmm_coordinator() {
     delete mu_k; // estimated guassians (k means)
     for (size_t i = 0; i < sigma_k.size(); i++) {
         delete sigma_k[i];
-        delete inv_sigma_k[i];
+        delete chol_sigma_k[i];
     }
     delete P_nk; // responsibility matrix (nxk)
 }
@@ -34,16 +34,24 @@ class gmm_coordinator : public coordinator {
         // max index stored within each threads partition
 
         base::dense_matrix<double>* mu_k; // estimated guassians (k means)
-        std::vector<base::dense_matrix<double>*> sigma_k; // k Covar matrices
-        std::vector<base::dense_matrix<double>*> inv_sigma_k; // k Covar matrices
-        std::vector<double> dets; // Determinants
+        base::cov_t cov_type;
+        // k Covar matrices when FULL, one shared matrix when TIED
+        std::vector<base::dense_matrix<double>*> sigma_k;
+        // Lower triangular Cholesky factors of sigma_k
+        std::vector<base::dense_matrix<double>*> chol_sigma_k;
+        // Variances. k x ncol when DIAG, k when SPHERICAL
+        std::vector<double> var_k;
+        std::vector<double> inv_std_k; // 1/sqrt(var_k)
+        std::vector<double> logdets; // Log determinants
         base::dense_matrix<double>* P_nk; // responsibility matrix (nxk)
         std::vector<double> Pk; // Frac of points in component k
         double cov_regularizer;
-        std::vector<double> Px;
-        std::vector<double> Pnk_sum; // 1 x k
         unsigned k;
-        double L;
+        double L; // Log-likelihood of the data
+        size_t g_nrow; // Rows the statistics are summed over, nrow in memory
+        // E-step statistics summed over threads laid out as
+        //  [Nk (k) | sum_x (k x ncol) | sum_xx | L | num_changed]
+        std::vector<double> stats;
 
         gmm_coordinator(const std::string fn, const size_t nrow,
                 const size_t ncol, const unsigned k,
@@ -51,39 +59,44 @@ class gmm_coordinator : public coordinator {
                 const unsigned nnodes, const unsigned nthreads,
                 const base::init_t it,
                 const double tolerance, const base::dist_t dt,
-                const double cov_regularizer);
+                const double cov_regularizer, const base::cov_t ct);
+
+        base::gmm_t build_gmm_t(const size_t iter);
 
     public:
         static coordinator::ptr create(const std::string fn,
                 const size_t nrow, const size_t ncol, const unsigned k,
                 const unsigned max_iters, double* mu_k,
                 const unsigned nnodes, const unsigned nthreads,
-                const std::string init="forgy", const double tolerance=-1,
+                const std::string init="forgy", const double tolerance=1E-3,
                 const std::string dist_type="eucl",
-                const double cov_regularizer=1E-6) {
+                const double cov_regularizer=1E-6,
+                const std::string cov_type="full") {
 
             base::init_t _init_t = base::get_init_type(init);
             base::dist_t _dist_t = base::get_dist_type(dist_type);
+            base::cov_t _cov_t = base::get_cov_type(cov_type);
 #if KM_TEST
 #ifndef BIND
             printf("gmm coordinator => NUMA nodes: %u, nthreads: %u, "
-                    "nrow: %lu, ncol: %lu, init: '%s', dist_t: '%s', fn: '%s'"
-                    "\n\n", nnodes, nthreads, nrow, ncol, init.c_str(),
-                    dist_type.c_str(), fn.c_str());
+                    "nrow: %lu, ncol: %lu, init: '%s', dist_t: '%s', "
+                    "cov_type: '%s', fn: '%s'\n\n", nnodes, nthreads, nrow,
+                    ncol, init.c_str(), dist_type.c_str(), cov_type.c_str(),
+                    fn.c_str());
 #endif
 #endif
             return coordinator::ptr(
                     new gmm_coordinator(fn, nrow, ncol, k, max_iters,
                     mu_k, nnodes, nthreads, _init_t, tolerance, _dist_t,
-                    cov_regularizer));
+                    cov_regularizer, _cov_t));
         }
 
         // Pass file handle to threads to read & numa alloc
+        // Hard assignment of each row to its most likely component
         virtual base::cluster_t run(double* allocd_data=NULL,
-            const bool numa_opt=false) override {
-            throw base::not_implemented_exception();
-        };
+            const bool numa_opt=false) override;
 
+        virtual void reduce_stats();
         void compute_cov_mat();
         base::gmm_t soft_run(double* allocd_data=NULL);
         void compute_shared_linalg();
@@ -95,6 +108,11 @@ class gmm_coordinator : public coordinator {
         void random_partition_init() override;
         void forgy_init() override;
         void kmeanspp_init() override;
+        // Every row counts once
+        void set_thd_weights_ptr(const double* w) override {
+            if (w)
+                throw base::not_implemented_exception();
+        }
         virtual void preprocess_data() {
             throw base::not_implemented_exception();
         }
@@ -31,7 +31,7 @@ namespace knor {
 hclust::hclust(const int node_id, const unsigned thd_id,
         const unsigned start_rid,
         const unsigned nprocrows, const unsigned ncol, unsigned k,
-        hclust_map& g_hcltrs, unsigned* cluster_assignments,
+        base::hcluster_arena::ptr g_hcltrs, unsigned* cluster_assignments,
         const std::string fn, base::dist_t dist_metric,
         const base::thd_safe_bool_vector::ptr cltr_active_vec) :
             thread(node_id, thd_id, ncol,
@@ -40,8 +40,6 @@ hclust::hclust(const int node_id, const unsigned thd_id,
             k(k), nprocrows(nprocrows) {
 
             set_data_size(sizeof(double)*nprocrows*ncol);
-            local_hcltrs.set_capacity(base::get_max_hnodes(k*2));
-            nchanged.set_capacity(base::get_max_hnodes(k*2));
         }
 
 void hclust::run() {
@@ -79,19 +77,8 @@ void hclust::start(const thread_state_t state=WAIT) {
 }
 
 void hclust::H_EM_step() {
-    local_hcltrs.clear();
-    nchanged.clear();
-
-    auto itr = g_hcltrs.get_iterator();
-    while (itr.has_next()) {
-        auto kv = itr.next();
-        if (kv.second->has_converged()) {
-            continue;
-        }
-            // No need to set id, zeroid, oneid because global hcltrs knows them
-            local_hcltrs[kv.first] = base::h_clusters::create(2, ncol);
-            local_hcltrs[kv.first]->clear(); // NOTE: Could be combined into ctor
-    }
+    // Allocated (first touch) by this thread & only grown
+    local_hcltrs.reset(g_hcltrs->nslots(), ncol);
 
     for (unsigned row = 0; row < nprocrows; row++) {
         // What cluster is this row in?
@@ -100,7 +87,7 @@ void hclust::H_EM_step() {
 
         // Not active or has converged
         if (!(cltr_active_vec->get(cluster_assignments[true_row_id])) ||
-                g_hcltrs[rpart_id]->has_converged())
+                g_hcltrs->has_converged(rpart_id))
             continue; // Skip it
 
         unsigned asgnd_clust = base::INVALID_CLUSTER_ID;
@@ -110,14 +97,14 @@ void hclust::H_EM_step() {
 
         for (unsigned clust_idx = 0; clust_idx < 2; clust_idx++) {
             dist = base::dist_comp_raw<double>(&local_data[row*ncol],
-                    &(g_hcltrs[rpart_id]->
-                        get_means()[clust_idx*ncol]), ncol, dist_metric);
+                    g_hcltrs->get_mean(rpart_id, clust_idx), ncol,
+                    dist_metric);
             if (dist < best) {
                 best = dist;
                 if (clust_idx == 0) {
-                    asgnd_clust = g_hcltrs[rpart_id]->get_zeroid();
+                    asgnd_clust = g_hcltrs->get_zeroid(rpart_id);
                 } else {
-                    asgnd_clust = g_hcltrs[rpart_id]->get_oneid();
+                    asgnd_clust = g_hcltrs->get_oneid(rpart_id);
                     flag = 1;
                 }
             }
@@ -125,9 +112,10 @@ void hclust::H_EM_step() {
 
         assert(asgnd_clust != base::INVALID_CLUSTER_ID);
 
+        const unsigned slot = g_hcltrs->get_slot(rpart_id);
         if (asgnd_clust != cluster_assignments[true_row_id])
-            nchanged[rpart_id]++;
-        local_hcltrs[rpart_id]->add_member(&local_data[row*ncol], flag);
+            local_hcltrs.nchanged[slot]++;
+        local_hcltrs.add_member(&local_data[row*ncol], slot, flag, ncol);
         cluster_assignments[true_row_id] = asgnd_clust;
     }
 }
@@ -22,22 +22,20 @@
 
 #include "types.hpp"
 #include "thread.hpp"
+#include "hcluster_arena.hpp"
 
 namespace knor {
 namespace base {
     class clusters;
-    class h_clusters;
     class thd_safe_bool_vector;
 }
 
-typedef base::vmap<std::shared_ptr<base::clusters>> hclust_map;
-
 class hclust : public thread {
     protected:
          // Pointer to global cluster data
-        hclust_map& g_hcltrs;
-        hclust_map local_hcltrs;
-        base::vmap<unsigned> nchanged; // How many change in each partition
+        base::hcluster_arena::ptr g_hcltrs;
+        // Sums & number changed for each partition still iterating
+        base::h_accumulator local_hcltrs;
         const std::shared_ptr<base::thd_safe_bool_vector> cltr_active_vec; // Clusters still active
 
         unsigned k;
@@ -47,7 +45,7 @@ class hclust : public thread {
         hclust(const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
                 const unsigned ncol, unsigned k,
-                hclust_map& g_hcltrs,
+                base::hcluster_arena::ptr g_hcltrs,
                 unsigned* cluster_assignments,
                 const std::string fn, base::dist_t dist_metric,
                 const std::shared_ptr<base::thd_safe_bool_vector> cltr_active_vec);
@@ -56,7 +54,7 @@ class hclust : public thread {
                 const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
                 const unsigned ncol, unsigned k,
-                hclust_map& g_hcltrs,
+                base::hcluster_arena::ptr g_hcltrs,
                 unsigned* cluster_assignments, const std::string fn,
                 base::dist_t dist_metric,
                 const std::shared_ptr<base::thd_safe_bool_vector> cltr_active_vec) {
@@ -71,11 +69,7 @@ class hclust : public thread {
             this->part_id = part_id;
         }
 
-        const base::vmap<unsigned>& get_nchanged() const {
-            return this->nchanged;
-        }
-
-        hclust_map& get_local_hcltrs() {
+        const base::h_accumulator& get_local_hcltrs() const {
             return local_hcltrs;
         }
 
@@ -26,6 +26,8 @@
 #include "clusters.hpp"
 #include "hclust_id_generator.hpp"
 #include "thd_safe_bool_vector.hpp"
+#include "member_index.hpp"
+#include "hcluster_arena.hpp"
 
 namespace knor {
 
@@ -42,18 +44,17 @@ hclust_coordinator::hclust_coordinator(const std::string fn, const size_t nrow,
         ui_distribution = std::uniform_int_distribution<unsigned>(0, nrow-1);
 
         max_nodes = base::get_max_hnodes(k*2);
-        hcltrs.set_capacity(max_nodes);
+        hcltrs = base::hcluster_arena::create(max_nodes, ncol);
 
         cltr_active_vec = base::thd_safe_bool_vector::create(max_nodes, false);
         activate(0);
 
+        hcltrs->add(0);
         if (centers) {
             // There must be at least one
-            hcltrs[0] = base::h_clusters::create(2, ncol, centers);
-        } else {
-            hcltrs[0] = base::h_clusters::create(2, ncol);
+            hcltrs->set_mean(0, 0, centers);
+            hcltrs->set_mean(0, 1, &centers[ncol]);
         }
-        hcltrs[0]->set_id(0);
 
         std::fill(cluster_assignments.begin(), cluster_assignments.end(), 0);
         part_id.assign(nrow, 0);
@@ -61,6 +62,7 @@ hclust_coordinator::hclust_coordinator(const std::string fn, const size_t nrow,
         nchanged.set_capacity(max_nodes);
         cluster_assignment_counts.assign(max_nodes, 0);
         ider = hclust_id_generator::create();
+        memb_index = base::member_index::create();
     }
 
 void hclust_coordinator::build_thread_state() {
@@ -81,89 +83,45 @@ void hclust_coordinator::build_thread_state() {
     }
 }
 
-void hclust_coordinator::partition_mean(base::vmap<
-        std::shared_ptr<base::clusters>>& part_hcltrs) {
-    wake4run(MEAN);
-    wait4complete();
-
-    if (part_hcltrs.empty())
-        part_hcltrs.set_capacity(max_nodes);
-    else
-        part_hcltrs.clear();
-
-    for (auto const& thd : threads) {
-        // Update the global hcltrs with local ones
-        auto itr = (std::static_pointer_cast<hclust>(
-                        thd))->get_local_hcltrs().get_iterator();
-
-        while (itr.has_next()) {
-            auto kv = itr.next();
-            part_hcltrs[kv.first]->peq(kv.second);
-        }
-    }
-
-    for (size_t i = 0; i < part_hcltrs.size(); i++) {
-        if (part_hcltrs.has_key(i))
-            part_hcltrs[i]->finalize_all();
-    }
-}
-
 /**
   * Require a method by which to pick centroids when samples in a cluster are
-  *     not contiguously numbered
+  *     not contiguously numbered. Uses the member index so the index must be
+  *     current with cluster_assignments.
   */
 unsigned hclust_coordinator::forgy_select(const unsigned cid) {
+    const size_t nmembers = memb_index->size(cid);
+    if (!nmembers)
+        throw std::runtime_error((std::string("No samples in cluster ")
+                    + std::to_string(cid)).c_str());
+
     _mutex.lock(); // We need these ordered for a determinant result
     unsigned rand_idx = ui_distribution(ui_generator);
     _mutex.unlock();
-    const long max_rid = nrow - 1;
-
-    // The random item we picked is indeed in the cluster we're evaluating
-    if (cluster_assignments[rand_idx] == cid)
-        return rand_idx;
-
-    // Else walk the cluster assignments until you find and row that is
-    long cnt = static_cast<long>(rand_idx);
-    // Go forward first
-    while (++cnt < max_rid)
-        if (cluster_assignments[cnt] == cid)
-            return cnt;
-
-    cnt = static_cast<long>(rand_idx);
-    // Go backward
-    while (--cnt < max_rid)
-        if (cluster_assignments[cnt] == cid)
-            return cnt;
-
-    throw std::runtime_error((std::string("No samples in cluster ")
-                + std::to_string(cid)).c_str());
+
+    return memb_index->get(cid, rand_idx % nmembers);
 }
 
 void hclust_coordinator::forgy_init() {
     auto splits = ider->get_split_ids();
-    auto cluster_ptr = hcltrs[0];
 
     auto rand_idx = ui_distribution(ui_generator);
-    cluster_ptr->set_mean(get_thd_data(
-                rand_idx), 0);
-    cluster_ptr->set_zeroid(splits.first);
+    hcltrs->set_mean(0, 0, get_thd_data(rand_idx));
+    hcltrs->set_zeroid(0, splits.first);
     activate(splits.first);
 
     rand_idx = ui_distribution(ui_generator);
-    cluster_ptr->set_mean(get_thd_data(
-                rand_idx), 1);
-    cluster_ptr->set_oneid(splits.second);
+    hcltrs->set_mean(0, 1, get_thd_data(rand_idx));
+    hcltrs->set_oneid(0, splits.second);
     activate(splits.second);
 }
 
 void hclust_coordinator::none_init() {
     auto splits = ider->get_split_ids();
-    auto cluster_ptr = hcltrs[0];
 
-    cluster_ptr->set_zeroid(splits.first);
+    hcltrs->set_zeroid(0, splits.first);
     activate(splits.first);
 
-    cluster_ptr->set_oneid(splits.second);
+    hcltrs->set_oneid(0, splits.second);
     activate(splits.second);
 }
 
@@ -182,25 +140,24 @@ void hclust_coordinator::run_hinit() {
 
 void hclust_coordinator::print_clusters() {
 #ifndef BIND
-    auto itr = hcltrs.get_iterator();
-    while (itr.has_next()) {
-        auto kv = itr.next();
-        printf("cid: %lu\n", kv.first);
-        kv.second->print_means();
+    std::vector<size_t> ids;
+    hcltrs->get_keys(ids);
+    for (auto const& id : ids) {
+        printf("cid: %lu\n", id);
+        hcltrs->print(id);
     }
 #endif
 }
 
 // How to initialize when splitting
 void hclust_coordinator::inner_init(std::vector<unsigned>& remove_cache) {
-    // TODO: ||ize
     std::vector<size_t> ids;
-    hcltrs.get_keys(ids);
+    hcltrs->get_keys(ids);
 
     // Early termination so we do not overcluster
     for (auto const& id : ids) {
-        auto zeroid = hcltrs[id]->get_zeroid();
-        auto oneid = hcltrs[id]->get_oneid();
+        auto zeroid = hcltrs->get_zeroid(id);
+        auto oneid = hcltrs->get_oneid(id);
 
         // l0 & l1 are associated with zeroid
         // r0 & r1 are associated with oneid
@@ -213,8 +170,7 @@ void hclust_coordinator::inner_init(std::vector<unsigned>& remove_cache) {
             deactivate(zeroid); // So we no longer process this
             // Record this as an output
             final_centroids[zeroid] = std::vector<double>(
-                    hcltrs[id]->get_mean_rawptr(0),
-                    hcltrs[id]->get_mean_rawptr(0) + ncol);
+                    hcltrs->get_mean(id, 0), hcltrs->get_mean(id, 0) + ncol);
             // Don't split
             l0_complete = l1_complete = true;
         }
@@ -223,8 +179,7 @@ void hclust_coordinator::inner_init(std::vector<unsigned>& remove_cache) {
                 || at_cluster_cap()) {
             deactivate(oneid);
             final_centroids[oneid] = std::vector<double>(
-                    hcltrs[id]->get_mean_rawptr(1),
-                    hcltrs[id]->get_mean_rawptr(1) + ncol);
+                    hcltrs->get_mean(id, 1), hcltrs->get_mean(id, 1) + ncol);
             // Don't split
             r0_complete = r1_complete = true;
         }
@@ -232,61 +187,48 @@ void hclust_coordinator::inner_init(std::vector<unsigned>& remove_cache) {
         remove_cache.push_back(id); // Should have no data members
         assert(cluster_assignment_counts[id] == 0);
 
+        // Seed each child's split with its two lowest numbered members
         c_part cp;
+        if (!l0_complete)
+            get_split_seeds(zeroid, cp.l0, cp.l1);
 
-        for (unsigned vid = 0; vid < nrow; vid++) {
-            if (l0_complete && l1_complete && r0_complete && r1_complete)
-                break; // Out of inner loop
-
-            if (cluster_assignments[vid] == zeroid) {
-                if (!l0_complete) {
-                    cp.l0 = vid;
-                    l0_complete = true;
-                } else if (!l1_complete) {
-                    cp.l1 = vid;
-                    l1_complete = true;
-
-                    // oneid has too few members to split
-                    if (!is_active(oneid))
-                        break;
-                }
-            } else if (cluster_assignments[vid] == oneid) {
-                if (!r0_complete) {
-                    cp.r0 = vid;
-                    r0_complete = true;
-                } else if (!r1_complete) {
-                    cp.r1 = vid;
-                    r1_complete = true;
-
-                    // zeroid has too few membs to split
-                    if (!is_active(zeroid))
-                        break;
-                }
-            }
-        }
+        if (!r0_complete)
+            get_split_seeds(oneid, cp.r0, cp.r1);
         spawn(zeroid, oneid, cp); // This edits hcltrs
     }
 }
 
+const bool hclust_coordinator::get_split_seeds(const unsigned cid,
+        unsigned& s0, unsigned& s1) {
+    if (memb_index->size(cid) < 2)
+        return false;
+
+    s0 = memb_index->get(cid, 0);
+    s1 = memb_index->get(cid, 1);
+    return true;
+}
+
+const double* hclust_coordinator::get_seed(const unsigned rid) {
+    return get_thd_data(rid);
+}
+
 void hclust_coordinator::spawn(const unsigned& zeroid,
         const unsigned& oneid, const c_part& cp) {
     // Add parent with two children
     if (cp.l_splittable()) { // NOTE: Could do an active check, but redundant
         auto zero_child_ids = ider->get_split_ids();
-        hcltrs[zeroid] = base::h_clusters::create(2, ncol, zeroid,
-                zero_child_ids.first, zero_child_ids.second);
-        hcltrs[zeroid]->set_mean(get_thd_data(cp.l0), 0);
-        hcltrs[zeroid]->set_mean(get_thd_data(cp.l1), 1);
+        hcltrs->add(zeroid, zero_child_ids.first, zero_child_ids.second);
+        hcltrs->set_mean(zeroid, 0, get_seed(cp.l0));
+        hcltrs->set_mean(zeroid, 1, get_seed(cp.l1));
         activate(zero_child_ids.first);
         activate(zero_child_ids.second);
     }
 
     if (cp.r_splittable()) {
         auto one_child_ids = ider->get_split_ids();
-        hcltrs[oneid] = base::h_clusters::create(2, ncol, oneid,
-                one_child_ids.first, one_child_ids.second);
-        hcltrs[oneid]->set_mean(get_thd_data(cp.r0), 0);
-        hcltrs[oneid]->set_mean(get_thd_data(cp.r1), 1);
+        hcltrs->add(oneid, one_child_ids.first, one_child_ids.second);
+        hcltrs->set_mean(oneid, 0, get_seed(cp.r0));
+        hcltrs->set_mean(oneid, 1, get_seed(cp.r1));
         activate(one_child_ids.first);
         activate(one_child_ids.second);
     }
@@ -294,11 +236,12 @@ void hclust_coordinator::spawn(const unsigned& zeroid,
 
 void hclust_coordinator::init_splits() {
     std::vector<unsigned> remove_cache;
+    build_member_index();
     inner_init(remove_cache);
 
     // Now update with new clusters added and delete parent
     for (unsigned id : remove_cache) {
-        hcltrs.erase(id); // Delete
+        hcltrs->erase(id); // Delete
         deactivate(id);
         ider->reclaim_id(id);
         curr_nclust--;
@@ -317,6 +260,10 @@ void hclust_coordinator::accumulate_cluster_counts() {
     }
 }
 
+void hclust_coordinator::build_member_index() {
+    memb_index->build(&cluster_assignments[0], nrow, max_nodes);
+}
+
 void hclust_coordinator::deactivate(const unsigned id) {
     cltr_active_vec->set(id, false);
 }
@@ -340,56 +287,45 @@ const bool hclust_coordinator::steady_state() const {
     return true; // No more clusters are active & none can be split
 }
 
-void hclust_coordinator::update_clusters() {
-    // clear nchanged & means
-    nchanged.clear();
+void hclust_coordinator::reduce_accumulators() {
+    // Means of the partitions that are still iterating
+    std::vector<const base::h_accumulator*> accs;
+    for (auto const& thd : threads)
+        accs.push_back(&(std::static_pointer_cast<hclust>(
+                        thd)->get_local_hcltrs()));
+    hcltrs->reduce(accs);
 
-    auto itr = hcltrs.get_iterator();
-    while (itr.has_next()) {
-        auto kv = itr.next();
-        assert(is_active(kv.first));
-        if (!kv.second->has_converged()) {
-            kv.second->clear();
-        }
+    // Update the changed cluster count
+    nchanged.clear();
+    for (size_t slot = 0; slot < hcltrs->nslots(); slot++) {
+        unsigned pid = hcltrs->get_slot_id(slot);
+        for (auto const& acc : accs)
+            nchanged[pid] += acc->nchanged[slot];
     }
+}
 
-    // Serial aggregate of nthread vectors
-    for (auto const& thd : threads) {
-        // Update the changed cluster count
-        auto thd_nchanged =
-            (std::static_pointer_cast<hclust>(thd))->get_nchanged();
-        for (size_t i = 0; i < thd_nchanged.size(); i++)
-            nchanged[i] += thd_nchanged[i];
-
-        // Update the global hcltrs with local ones
-        auto itr = (std::static_pointer_cast<hclust>(
-                        thd))->get_local_hcltrs().get_iterator();
-        while (itr.has_next()) {
-            auto kv = itr.next();
-            hcltrs[kv.first]->peq(kv.second);
-        }
-    }
+void hclust_coordinator::update_clusters() {
+    reduce_accumulators();
 
-    auto _itr = hcltrs.get_iterator();
-    while (_itr.has_next()) {
-        auto kv = _itr.next();
+    std::vector<size_t> ids;
+    hcltrs->get_keys(ids);
+    for (auto const& pid : ids) { // partition ID
+        assert(is_active(pid));
         // There are only ever 2 of these for hclust
-        auto pid = kv.first; // partition ID
-        auto c = kv.second;
-        auto part_nmembers = c->get_num_members(0) + c->get_num_members(1);
-        cluster_assignment_counts[kv.first] = 0; // Zero out parent
-        cluster_assignment_counts[c->get_zeroid()] = c->get_num_members(0);
-        cluster_assignment_counts[c->get_oneid()] = c->get_num_members(1);
+        auto part_nmembers = hcltrs->get_num_members(pid, 0) +
+            hcltrs->get_num_members(pid, 1);
+        cluster_assignment_counts[pid] = 0; // Zero out parent
+        cluster_assignment_counts[hcltrs->get_zeroid(pid)] =
+            hcltrs->get_num_members(pid, 0);
+        cluster_assignment_counts[hcltrs->get_oneid(pid)] =
+            hcltrs->get_num_members(pid, 1);
 
         // Skip clusters that have converged, but are active
-        if (!c->has_converged()) {
-            c->finalize(0);
-            c->finalize(1);
-
+        if (!hcltrs->has_converged(pid)) {
             // Premature End of computation
             if (nchanged[pid] == 0 ||
                     (nchanged[pid]/(double)part_nmembers) <= tolerance) {
-                c->set_converged();
+                hcltrs->set_converged(pid);
             }
         }
     }
@@ -408,15 +344,15 @@ void hclust_coordinator::verify_consistency() {
 
 void hclust_coordinator::complete_final_centroids() {
     // Finally update the final centroids with the values in hcltrs
-    auto itr = hcltrs.get_iterator();
-    while (itr.has_next()) {
-        auto const& c = itr.next().second;
-        final_centroids[c->get_zeroid()] =
-            std::vector<double>(c->get_mean_rawptr(0),
-                    c->get_mean_rawptr(0) + ncol);
-        final_centroids[c->get_oneid()] =
-            std::vector<double>(c->get_mean_rawptr(1),
-                    c->get_mean_rawptr(1) + ncol);
+    std::vector<size_t> ids;
+    hcltrs->get_keys(ids);
+    for (auto const& id : ids) {
+        final_centroids[hcltrs->get_zeroid(id)] =
+            std::vector<double>(hcltrs->get_mean(id, 0),
+                    hcltrs->get_mean(id, 0) + ncol);
+        final_centroids[hcltrs->get_oneid(id)] =
+            std::vector<double>(hcltrs->get_mean(id, 1),
+                    hcltrs->get_mean(id, 1) + ncol);
     }
 }
 
@@ -455,6 +391,7 @@ base::cluster_t hclust_coordinator::run(
             printf("%lu ", iter);
 #endif
             // Now pick between the cluster splits
+            hcltrs->assign_slots();
             wake4run(H_EM);
             wait4complete();
 
@@ -477,7 +414,7 @@ base::cluster_t hclust_coordinator::run(
         init_splits(); // Initialize possible splits
 
         // Break when clusters are inactive due to size
-        if (hcltrs.keyless()) {
+        if (hcltrs->keyless()) {
 #ifndef BIND
             printf("\n\nSTEADY STATE EXIT!\n");
 #endif
@@ -29,8 +29,9 @@ namespace knor {
 
 namespace base {
     class clusters;
-    class h_clusters;
+    class hcluster_arena;
     class thd_safe_bool_vector;
+    class member_index;
 }
 
 class hclust_id_generator;
@@ -67,7 +68,8 @@ struct c_part {
 
 class hclust_coordinator : public coordinator {
     protected:
-        base::vmap<std::shared_ptr<base::clusters>> hcltrs;
+        // Centroid pairs of the partitions being split, by partition id
+        std::shared_ptr<base::hcluster_arena> hcltrs;
         size_t max_nodes;
 
         base::vmap<unsigned> nchanged;
@@ -83,6 +85,8 @@ class hclust_coordinator : public coordinator {
         unsigned min_clust_size;
         std::unordered_map<unsigned, std::vector<double>> final_centroids;
         size_t curr_nclust;
+        // Rows of each cluster, rebuilt from cluster_assignments before splits
+        std::shared_ptr<base::member_index> memb_index;
     public:
         hclust_coordinator(const std::string fn, const size_t nrow,
                 const size_t ncol, const unsigned k, const unsigned max_iters,
@@ -123,25 +127,37 @@ class hclust_coordinator : public coordinator {
         virtual base::cluster_t run(double* allocd_data=NULL,
             const bool numa_opt=false) override;
         virtual void update_clusters();
+        // Sum the threads' H_EM accumulators into hcltrs and nchanged
+        virtual void reduce_accumulators();
         virtual void forgy_init() override;
         void none_init();
+        // Every row counts once
+        void set_thd_weights_ptr(const double* w) override {
+            if (w)
+                throw base::not_implemented_exception();
+        }
         virtual void preprocess_data() {
             throw knor::base::abstract_exception();
         }
 
         // Used to take the mean of the full dataset
         virtual void build_thread_state() override;
-        virtual void partition_mean(base::vmap<
-        std::shared_ptr<base::clusters>>& part_hcltrs);
         virtual void init_splits();
         virtual void inner_init(std::vector<unsigned>& remove_cache);
         virtual void spawn(const unsigned& zeroid,
                 const unsigned& oneid, const c_part& cp);
+        // The two lowest numbered members of cid seed its split. False if it
+        //  has fewer than 2 members. Uses the member index.
+        virtual const bool get_split_seeds(const unsigned cid,
+                unsigned& s0, unsigned& s1);
+        // The data of a row returned by get_split_seeds
+        virtual const double* get_seed(const unsigned rid);
         virtual void deactivate(const unsigned id);
         virtual void activate(const unsigned id);
         virtual const bool is_active(const unsigned i) const ;
         virtual const bool steady_state() const;
         virtual void accumulate_cluster_counts();
+        virtual void build_member_index();
         virtual void complete_final_centroids();
         virtual bool at_cluster_cap() { return curr_nclust > k*2; }
         void verify_consistency();
@@ -24,6 +24,7 @@
 #include "kmeans_thread.hpp"
 #include "io.hpp"
 #include "clusters.hpp"
+#include "centroid_graph.hpp"
 
 namespace knor {
 kmeans_coordinator::kmeans_coordinator(const std::string fn, const size_t nrow,
@@ -32,7 +33,8 @@ kmeans_coordinator::kmeans_coordinator(const std::string fn, const size_t nrow,
         const double* centers, const kbase::init_t it,
         const double tolerance, const kbase::dist_t dt) :
     coordinator(fn, nrow, ncol, k, max_iters,
-            nnodes, nthreads, centers, it, tolerance, dt) {
+            nnodes, nthreads, centers, it, tolerance, dt), graph(nullptr),
+    ef_search(0), approx_sample(0), approx_mismatch(0) {
 
         cltrs = kbase::clusters::create(k, ncol);
         if (centers) {
@@ -63,6 +65,46 @@ void kmeans_coordinator::build_thread_state() {
     }
 }
 
+void kmeans_coordinator::set_approx_assign(const unsigned degree,
+        const unsigned ef_search, const unsigned ef_construction,
+        const size_t nsample) {
+    graph = kbase::centroid_graph::create(degree, ef_construction, _dist_t);
+    this->ef_search = ef_search;
+    approx_sample = std::min(nsample, nrow);
+
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        std::static_pointer_cast<kmeans_thread>(*it)->set_graph(graph,
+                ef_search);
+}
+
+void kmeans_coordinator::check_approx() {
+    if (!approx_sample)
+        return;
+
+    // Evenly spaced rows vs the means the E-step used
+    size_t nmismatch = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:nmismatch)
+#endif
+    for (size_t i = 0; i < approx_sample; i++) {
+        const size_t row = (i*nrow) / approx_sample;
+        const double* dp = get_thd_data(row);
+
+        double best = std::numeric_limits<double>::max();
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+            best = std::min(best, kbase::dist_comp_raw<double>(dp,
+                        &(cltrs->get_means()[clust_idx*ncol]), ncol,
+                        _dist_t));
+
+        double asgnd = kbase::dist_comp_raw<double>(dp,
+                &(cltrs->get_means()[cluster_assignments[row]*ncol]), ncol,
+                _dist_t);
+        if (asgnd > best)
+            nmismatch++;
+    }
+    approx_mismatch = nmismatch / (double)approx_sample;
+}
+
 void kmeans_coordinator::update_clusters() {
     num_changed = 0; // Always reset here since there's no pruning
     cltrs->clear();
@@ -116,12 +158,12 @@ void kmeans_coordinator::kmeanspp_init() {
         wait4complete();
         double cuml_dist = reduction_on_cuml_sum(); // Sum the per thread cumulative dists
 
-        cuml_dist = (cuml_dist * ur_distribution(generator)) / (RAND_MAX - 1.0);
+        cuml_dist *= ur_distribution(generator);
         if (++clust_idx >= k)  // No more centers needed
             break;
 
         for (size_t row = 0; row < nrow; row++) {
-            cuml_dist -= dist_v[row];
+            cuml_dist -= get_row_weight(row)*dist_v[row];
             if (cuml_dist <= 0) {
                 cltrs->set_mean(get_thd_data(row), clust_idx);
                 cluster_assignments[row] = clust_idx;
@@ -190,9 +232,22 @@ kbase::cluster_t kmeans_coordinator::run(
         if (iter == 1)
             clear_cluster_assignments();
 
+        if (graph)
+            graph->build(&(cltrs->get_means()[0]), k, ncol);
+
         wake4run(EM);
         wait4complete();
 
+#if VERBOSE
+        if (graph) {
+            check_approx();
+#ifndef BIND
+            printf("Approximate assignment: %.4f of %lu sampled rows differ "
+                    "from exact\n", approx_mismatch, approx_sample);
+#endif
+        }
+#endif
+
         update_clusters();
 
 #if VERBOSE
@@ -213,6 +268,9 @@ kbase::cluster_t kmeans_coordinator::run(
 #endif
 
     gettimeofday(&end, NULL);
+    // The exact rescan is diagnostic only, so it runs once, not per iteration
+    if (graph)
+        check_approx();
 #ifndef BIND
     printf("\n\nAlgorithmic time taken = %.6f sec\n",
         kbase::time_diff(start, end));
@@ -230,6 +288,10 @@ kbase::cluster_t kmeans_coordinator::run(
     }
 
 #ifndef BIND
+    if (graph)
+        printf("Approximate assignment: %.4f of %lu sampled rows differed "
+                "from exact under the final means\n", approx_mismatch,
+                approx_sample);
     printf("Final cluster counts: \n");
     kbase::print(cluster_assignment_counts);
     printf("\n******************************************\n");
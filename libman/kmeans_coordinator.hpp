@@ -26,6 +26,7 @@ namespace knor {
 
 namespace base {
     class clusters;
+    class centroid_graph;
 }
 
 class kmeans_coordinator : public coordinator {
@@ -34,6 +35,14 @@ class kmeans_coordinator : public coordinator {
         // max index stored within each threads partition
         std::shared_ptr<base::clusters> cltrs;
 
+        // Approximate assignment through a centroid graph. NULL for exact.
+        std::shared_ptr<base::centroid_graph> graph;
+        unsigned ef_search;
+        size_t approx_sample; // Rows checked against exact after the run
+        double approx_mismatch; // Fraction of them assigned differently
+
+        void check_approx();
+
         kmeans_coordinator(const std::string fn, const size_t nrow,
                 const size_t ncol, const unsigned k, const unsigned max_iters,
                 const unsigned nnodes, const unsigned nthreads,
@@ -67,6 +76,20 @@ class kmeans_coordinator : public coordinator {
             return cltrs;
         }
 
+        /**
+          * Assign rows approximately by searching a graph over the centroids
+          *  (rebuilt every iteration) from each row's last centroid. For
+          *  very large k.
+          * \param degree graph out-degree, larger is slower to build.
+          * \param ef_search search beam width, trades speed for recall.
+          * \param nsample rows compared against exact assignment per
+          *  iteration to report the mismatch.
+          */
+        void set_approx_assign(const unsigned degree,
+                const unsigned ef_search=32, const unsigned ef_construction=64,
+                const size_t nsample=1000);
+        const double get_approx_mismatch() const { return approx_mismatch; }
+
         // Pass file handle to threads to read & numa alloc
         virtual base::cluster_t run(double* allocd_data=NULL,
             const bool numa_opt=false) override;
@@ -0,0 +1,320 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <limits>
+#include <algorithm>
+
+#include "kmeans_multi_coordinator.hpp"
+#include "kmeans_multi_thread.hpp"
+#include "io.hpp"
+
+namespace knor {
+kmeans_multi_coordinator::kmeans_multi_coordinator(const std::string fn,
+        const size_t nrow, const size_t ncol,
+        const std::vector<unsigned>& ks, const unsigned max_iters,
+        const unsigned nnodes, const unsigned nthreads,
+        const base::init_t it, const double tolerance,
+        const base::dist_t dt) :
+    coordinator(fn, nrow, ncol,
+            ks.empty() ? 0 : *std::max_element(ks.begin(), ks.end()),
+            max_iters, nnodes, nthreads, NULL, it, tolerance, dt),
+    nstart(ks.size()), ks(ks), best_start(0) {
+
+        if (!nstart)
+            throw base::parameter_exception("nstart must be > 0");
+        if (!*std::min_element(ks.begin(), ks.end()))
+            throw base::parameter_exception("Every k must be > 0");
+        if (it != base::init_t::PLUSPLUS && it != base::init_t::FORGY)
+            throw base::parameter_exception(
+                    "Concurrent restarts support only "
+                    "'kmeanspp' or 'forgy' init");
+
+        for (unsigned start = 0; start < nstart; start++) {
+            koffs.push_back(clust_start.size());
+            clust_start.insert(clust_start.end(), ks[start], start);
+        }
+
+        means.assign(clust_start.size()*ncol, 0);
+        active.assign(nstart, 1);
+        multi_assignments.assign(nrow*nstart, base::INVALID_CLUSTER_ID);
+        energy.assign(nstart, 0);
+        bic.assign(nstart, 0);
+        iters.assign(nstart, 0);
+        converged.assign(nstart, 0);
+        build_thread_state();
+    }
+
+void kmeans_multi_coordinator::build_thread_state() {
+    // NUMA node affinity binding policy is round-robin
+    unsigned thds_row = nrow / nthreads;
+    for (unsigned thd_id = 0; thd_id < nthreads; thd_id++) {
+        std::pair<unsigned, unsigned> tup = get_rid_len_tup(thd_id);
+        thd_max_row_idx.push_back((thd_id*thds_row) + tup.second);
+        threads.push_back(kmeans_multi_thread::create((thd_id % nnodes),
+                    thd_id, tup.first, tup.second, ncol, nstart, &ks[0],
+                    &koffs[0], &means[0], &active[0], &multi_assignments[0],
+                    fn, _dist_t));
+        threads[thd_id]->set_parent_cond(&cond);
+        threads[thd_id]->set_parent_pending_threads(&pending_threads);
+        threads[thd_id]->start(WAIT); // Thread puts itself to sleep
+    }
+}
+
+void kmeans_multi_coordinator::kmeanspp_init() {
+    multi_dist_v.assign(nrow*nstart, std::numeric_limits<double>::max());
+    set_thd_dist_v_ptr(&multi_dist_v[0]);
+
+    std::uniform_int_distribution<unsigned> distribution(0, nrow-1);
+    std::uniform_real_distribution<double> ur_distribution(0.0, 1.0);
+
+    // Choose c1 of every restart uniformly at random
+    for (unsigned start = 0; start < nstart; start++) {
+        unsigned selected_idx = distribution(generator);
+        std::copy(get_thd_data(selected_idx),
+                get_thd_data(selected_idx) + ncol,
+                &means[koffs[start]*ncol]);
+    }
+
+    // Every pass computes the distance to the newest center of all restarts
+    for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+        set_thread_clust_idx(clust_idx);
+        wake4run(KMSPP_INIT);
+        wait4complete();
+
+        for (unsigned start = 0; start < nstart; start++) {
+            if (clust_idx >= ks[start])
+                continue;
+
+            double cuml_dist = 0;
+            for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+                cuml_dist += std::static_pointer_cast<kmeans_multi_thread>(
+                        *it)->get_energy(start);
+            energy[start] = cuml_dist;
+
+            if (clust_idx + 1 == ks[start])
+                continue; // No more centers needed
+
+            // Choose the next center with probability proportional to D(x)
+            cuml_dist *= ur_distribution(generator);
+
+            // Skip whole threads using their partial sums
+            unsigned thd_id = 0;
+            for (; thd_id < nthreads - 1; thd_id++) {
+                double thd_dist =
+                    std::static_pointer_cast<kmeans_multi_thread>(
+                        threads[thd_id])->get_energy(start);
+                if (cuml_dist <= thd_dist)
+                    break;
+                cuml_dist -= thd_dist;
+            }
+
+            std::pair<unsigned, unsigned> tup = get_rid_len_tup(thd_id);
+            size_t selected_idx = tup.first + tup.second - 1;
+            for (size_t row = tup.first; row < tup.first + tup.second;
+                    row++) {
+                cuml_dist -=
+                    get_row_weight(row)*multi_dist_v[row*nstart+start];
+                if (cuml_dist <= 0) {
+                    selected_idx = row;
+                    break;
+                }
+            }
+
+            std::copy(get_thd_data(selected_idx),
+                    get_thd_data(selected_idx) + ncol,
+                    &means[(koffs[start] + clust_idx + 1)*ncol]);
+        }
+    }
+
+    // Release the distances
+    std::vector<double>().swap(multi_dist_v);
+    set_thd_dist_v_ptr(NULL);
+}
+
+void kmeans_multi_coordinator::forgy_init() {
+    std::uniform_int_distribution<unsigned> distribution(0, nrow-1);
+
+    for (unsigned start = 0; start < nstart; start++) {
+        for (unsigned clust_idx = 0; clust_idx < ks[start]; clust_idx++) {
+            unsigned rand_idx = distribution(generator);
+            std::copy(get_thd_data(rand_idx), get_thd_data(rand_idx) + ncol,
+                    &means[(koffs[start] + clust_idx)*ncol]);
+        }
+    }
+}
+
+void kmeans_multi_coordinator::update_clusters() {
+    std::vector<const double*> thd_sums;
+    std::vector<const double*> thd_weights;
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+        std::shared_ptr<kmeans_multi_thread> thd =
+            std::static_pointer_cast<kmeans_multi_thread>(*it);
+        thd_sums.push_back(thd->get_sums());
+        thd_weights.push_back(thd->get_memb_weights());
+    }
+
+    const size_t nclust = clust_start.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t idx = 0; idx < nclust; idx++) {
+        if (!active[clust_start[idx]])
+            continue;
+
+        double weight = 0;
+        for (unsigned thd_id = 0; thd_id < nthreads; thd_id++)
+            weight += thd_weights[thd_id][idx];
+
+        // An empty cluster keeps its previous mean
+        if (weight <= 0)
+            continue;
+
+        double* mean = &means[idx*ncol];
+        std::fill(mean, mean + ncol, 0);
+        for (unsigned thd_id = 0; thd_id < nthreads; thd_id++) {
+            const double* sum = &thd_sums[thd_id][idx*ncol];
+            for (size_t col = 0; col < ncol; col++)
+                mean[col] += sum[col];
+        }
+
+        for (size_t col = 0; col < ncol; col++)
+            mean[col] /= weight;
+    }
+}
+
+void kmeans_multi_coordinator::reduce_stats(const size_t iter) {
+    for (unsigned start = 0; start < nstart; start++) {
+        if (!active[start])
+            continue;
+
+        size_t nchanged = 0;
+        double start_energy = 0;
+        for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+            std::shared_ptr<kmeans_multi_thread> thd =
+                std::static_pointer_cast<kmeans_multi_thread>(*it);
+            nchanged += thd->get_nchanged(start);
+            start_energy += thd->get_energy(start);
+        }
+        assert(nchanged <= nrow);
+
+        energy[start] = start_energy;
+        iters[start] = iter;
+        if (nchanged == 0 || ((nchanged/(double)nrow)) <= tolerance)
+            converged[start] = 1;
+    }
+}
+
+base::cluster_t kmeans_multi_coordinator::get_start(const unsigned start) {
+    if (start >= nstart)
+        throw base::oob_exception("Restart index out of range");
+
+    std::fill(cluster_assignment_counts.begin(),
+            cluster_assignment_counts.end(), 0);
+    for (size_t row = 0; row < nrow; row++) {
+        unsigned asgnd = multi_assignments[row*nstart+start];
+        cluster_assignments[row] = asgnd;
+        if (asgnd != base::INVALID_CLUSTER_ID)
+            cluster_assignment_counts[asgnd]++;
+    }
+
+    std::vector<double> start_means(means.begin() + koffs[start]*ncol,
+            means.begin() + (koffs[start] + ks[start])*ncol);
+    return base::cluster_t(this->nrow, this->ncol, iters[start], ks[start],
+            &cluster_assignments[0], &cluster_assignment_counts[0],
+            start_means);
+}
+
+/**
+ * Main driver for concurrent multi-start kmeans
+ */
+base::cluster_t kmeans_multi_coordinator::run(
+        double* allocd_data, const bool numa_opt) {
+#ifdef PROFILER
+    ProfilerStart("libman/kmeans_multi_coordinator.perf");
+#endif
+
+    if (!numa_opt && NULL == allocd_data) {
+        wake4run(ALLOC_DATA);
+        wait4complete();
+    } else if (allocd_data) { // No NUMA opt
+        set_thread_data_ptr(allocd_data);
+    } // Do nothing for numa_opt .. done in binding/knori.hpp
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+    run_init(); // Initialize clusters of every restart
+
+    // Forgy restarts still need one assignment pass to be comparable
+    const unsigned nassign = (max_iters == 0 &&
+            _init_t != base::init_t::PLUSPLUS) ? 1 : max_iters;
+
+    // Every row is reassigned in the first iteration. Without iterations
+    //  kmeans++ already left each row with its nearest center.
+    if (nassign)
+        std::fill(multi_assignments.begin(), multi_assignments.end(),
+                base::INVALID_CLUSTER_ID);
+
+    for (size_t iter = 1; iter <= nassign; iter++) {
+        wake4run(EM);
+        wait4complete();
+
+        reduce_stats(std::min<size_t>(iter, max_iters));
+        if (iter <= max_iters)
+            update_clusters();
+
+        unsigned nactive = 0;
+        for (unsigned s = 0; s < nstart; s++) {
+            if (converged[s])
+                active[s] = 0;
+            nactive += active[s];
+        }
+        if (!nactive)
+            break;
+    }
+
+#ifdef PROFILER
+    ProfilerStop();
+#endif
+
+    for (unsigned s = 0; s < nstart; s++)
+        bic[s] = base::get_bic(energy[s], nrow, ncol, ks[s]);
+    best_start = std::min_element(bic.begin(), bic.end()) - bic.begin();
+
+    gettimeofday(&end, NULL);
+#ifndef BIND
+    // Seeding only (e.g. for a coreset) has no restarts to report
+    if (max_iters) {
+        printf("\n\nAlgorithmic time taken = %.6f sec\n",
+                base::time_diff(start, end));
+        printf("\n******************************************\n");
+        for (unsigned s = 0; s < nstart; s++) {
+            printf("Restart %u (k = %u): energy = %.6f, BIC = %.6f, "
+                    "%s in %lu iterations\n", s+1, ks[s], energy[s], bic[s],
+                    converged[s] ? "converged" : "did not converge",
+                    iters[s]);
+        }
+        printf("Best restart: %u\n", best_start+1);
+        printf("\n******************************************\n");
+    }
+#endif
+
+    return get_start(best_start);
+}
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __KNOR_KMEANS_MULTI_COORDINATOR_HPP__
+#define __KNOR_KMEANS_MULTI_COORDINATOR_HPP__
+
+#include <random>
+
+#include "coordinator.hpp"
+#include "util.hpp"
+
+namespace knor {
+
+/**
+  * k-means with nstart independent restarts run together. Every restart is
+  *  seeded in the same passes over the data and every EM pass compares each
+  *  row against the centroids of all restarts that haven't converged, so
+  *  nstart restarts cost about one pass of memory traffic per iteration.
+  *  The restart with the lowest energy (sum of each row's distance to its
+  *  centroid at its last assignment) is returned.
+  */
+class kmeans_multi_coordinator : public coordinator {
+    protected:
+        const unsigned nstart;
+        std::vector<unsigned> ks; // nstart, clusters of each restart
+        std::vector<size_t> koffs; // nstart, first centroid of each restart
+        std::vector<unsigned> clust_start; // nclust, restart of a centroid
+        std::vector<double> means; // nclust x ncol
+        std::vector<char> active; // Restarts still iterating
+        // Per row assignment and kmeans++ distance interleaved by restart
+        std::vector<unsigned> multi_assignments; // nrow x nstart
+        std::vector<double> multi_dist_v; // nrow x nstart
+
+        std::vector<double> energy; // nstart
+        std::vector<double> bic; // nstart
+        std::vector<size_t> iters; // nstart
+        std::vector<char> converged; // nstart
+        unsigned best_start;
+
+        std::default_random_engine generator;
+
+        kmeans_multi_coordinator(const std::string fn, const size_t nrow,
+                const size_t ncol, const std::vector<unsigned>& ks,
+                const unsigned max_iters, const unsigned nnodes,
+                const unsigned nthreads, const base::init_t it,
+                const double tolerance, const base::dist_t dt);
+
+        void update_clusters();
+        void reduce_stats(const size_t iter);
+
+    public:
+        static coordinator::ptr create(const std::string fn,
+                const size_t nrow,
+                const size_t ncol, const unsigned k, const unsigned max_iters,
+                const unsigned nnodes, const unsigned nthreads,
+                const unsigned nstart=1, const std::string init="kmeanspp",
+                const double tolerance=-1, const std::string dist_type="eucl") {
+
+            base::init_t _init_t = base::get_init_type(init);
+            base::dist_t _dist_t = base::get_dist_type(dist_type);
+#if KM_TEST
+#ifndef BIND
+            printf("kmeans multi coordinator => NUMA nodes: %u, nthreads: %u, "
+                    "nrow: %lu, ncol: %lu, nstart: %u, init: '%s', "
+                    "dist_t: '%s', fn: '%s'\n\n", nnodes, nthreads, nrow,
+                    ncol, nstart, init.c_str(), dist_type.c_str(), fn.c_str());
+#endif
+#endif
+            return coordinator::ptr(
+                    new kmeans_multi_coordinator(fn, nrow, ncol,
+                        std::vector<unsigned>(nstart, k), max_iters,
+                        nnodes, nthreads, _init_t, tolerance, _dist_t));
+        }
+
+        // A sweep with one restart per entry of ks
+        static coordinator::ptr create(const std::string fn,
+                const size_t nrow, const size_t ncol,
+                const std::vector<unsigned>& ks, const unsigned max_iters,
+                const unsigned nnodes, const unsigned nthreads,
+                const std::string init="kmeanspp",
+                const double tolerance=-1, const std::string dist_type="eucl") {
+
+            base::init_t _init_t = base::get_init_type(init);
+            base::dist_t _dist_t = base::get_dist_type(dist_type);
+            return coordinator::ptr(
+                    new kmeans_multi_coordinator(fn, nrow, ncol, ks,
+                        max_iters, nnodes, nthreads, _init_t, tolerance,
+                        _dist_t));
+        }
+
+        // Pass file handle to threads to read & numa alloc
+        virtual base::cluster_t run(double* allocd_data=NULL,
+            const bool numa_opt=false) override;
+        void kmeanspp_init() override;
+        void forgy_init() override;
+        virtual void build_thread_state() override;
+
+        // 1-based, as reported by kmeansPP
+        const unsigned get_best_start() const { return best_start + 1; }
+        const double get_energy(const unsigned start) const {
+            return energy[start];
+        }
+        const std::vector<double>& get_energies() const { return energy; }
+        const double get_bic(const unsigned start) const {
+            return bic[start];
+        }
+        const unsigned get_k(const unsigned start) const { return ks[start]; }
+        const unsigned get_nstart() const { return nstart; }
+        // The clustering of one restart, after run
+        base::cluster_t get_start(const unsigned start);
+};
+}
+#endif
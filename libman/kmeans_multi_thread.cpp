@@ -0,0 +1,159 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include "kmeans_multi_thread.hpp"
+#include "types.hpp"
+#include "util.hpp"
+
+namespace knor {
+kmeans_multi_thread::kmeans_multi_thread(const int node_id,
+        const unsigned thd_id, const unsigned start_rid,
+        const unsigned nprocrows, const unsigned ncol, const unsigned nstart,
+        const unsigned* ks, const size_t* koffs, const double* g_means,
+        const char* g_active,
+        unsigned* cluster_assignments, const std::string fn,
+        base::dist_t dist_metric) :
+            thread(node_id, thd_id, ncol,
+            cluster_assignments, start_rid, fn, dist_metric),
+        nstart(nstart), ks(ks), koffs(koffs),
+        nclust(koffs[nstart-1] + ks[nstart-1]), nprocrows(nprocrows),
+        g_means(g_means), g_active(g_active) {
+            set_data_size(sizeof(double)*nprocrows*ncol);
+        }
+
+void kmeans_multi_thread::run() {
+    switch(state) {
+        case TEST:
+            test();
+            break;
+        case ALLOC_DATA:
+            numa_alloc_mem();
+            break;
+        case KMSPP_INIT:
+            kmspp_dist();
+            break;
+        case EM:
+            EM_step();
+            break;
+        case EXIT:
+            throw base::thread_exception(
+                    "Thread state is EXIT but running!\n");
+        default:
+            throw base::thread_exception("Unknown thread state\n");
+    }
+    sleep();
+}
+
+void kmeans_multi_thread::start(const thread_state_t state=WAIT) {
+    this->state = state;
+    int rc = pthread_create(&hw_thd, NULL,
+            callback<kmeans_multi_thread>, this);
+    if (rc)
+        throw base::thread_exception(
+                "Thread creation (pthread_create) failed!", rc);
+}
+
+void kmeans_multi_thread::reset_stats(const bool clear_sums) {
+    if (sums.empty()) {
+        sums.resize(nclust*ncol);
+        memb_weights.resize(nclust);
+        nchanged.resize(nstart);
+        energy.resize(nstart);
+    }
+
+    if (clear_sums) {
+        std::fill(sums.begin(), sums.end(), 0);
+        std::fill(memb_weights.begin(), memb_weights.end(), 0);
+    }
+    std::fill(nchanged.begin(), nchanged.end(), 0);
+    std::fill(energy.begin(), energy.end(), 0);
+}
+
+void kmeans_multi_thread::EM_step() {
+    reset_stats(true);
+
+    for (unsigned row = 0; row < nprocrows; row++) {
+        const double* data = &local_data[row*ncol];
+        unsigned* asgnd = &cluster_assignments[
+            static_cast<size_t>(get_global_data_id(row))*nstart];
+        const double weight = get_weight(get_global_data_id(row));
+
+        for (unsigned start = 0; start < nstart; start++) {
+            if (!g_active[start])
+                continue;
+
+            const double* means = &g_means[koffs[start]*ncol];
+            unsigned asgnd_clust = base::INVALID_CLUSTER_ID;
+            double best = std::numeric_limits<double>::max();
+
+            for (unsigned clust_idx = 0; clust_idx < ks[start]; clust_idx++) {
+                double dist = base::dist_comp_raw<double>(data,
+                        &means[clust_idx*ncol], ncol, dist_metric);
+                if (dist < best) {
+                    best = dist;
+                    asgnd_clust = clust_idx;
+                }
+            }
+
+            assert(asgnd_clust != base::INVALID_CLUSTER_ID);
+            if (asgnd_clust != asgnd[start]) {
+                nchanged[start]++;
+                asgnd[start] = asgnd_clust;
+            }
+            energy[start] += weight*best;
+
+            double* sum = &sums[(koffs[start] + asgnd_clust)*ncol];
+            for (size_t col = 0; col < ncol; col++)
+                sum[col] += weight*data[col];
+            memb_weights[koffs[start] + asgnd_clust] += weight;
+        }
+    }
+}
+
+void kmeans_multi_thread::kmspp_dist() {
+    reset_stats(false);
+    const unsigned clust_idx = meta.clust_idx;
+
+    for (unsigned row = 0; row < nprocrows; row++) {
+        const double* data = &local_data[row*ncol];
+        const size_t offset =
+            static_cast<size_t>(get_global_data_id(row))*nstart;
+        const double weight = get_weight(get_global_data_id(row));
+
+        for (unsigned start = 0; start < nstart; start++) {
+            if (clust_idx >= ks[start])
+                continue; // This restart has all its centers
+
+            double dist = base::dist_comp_raw<double>(data,
+                    &g_means[(koffs[start] + clust_idx)*ncol], ncol,
+                    dist_metric);
+
+            // Found a closer cluster than before
+            if (dist < dist_v[offset+start]) {
+                dist_v[offset+start] = dist;
+                cluster_assignments[offset+start] = clust_idx;
+            }
+            energy[start] += weight*dist_v[offset+start];
+        }
+    }
+}
+} // End namespace knor
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of knor
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KNOR_KMEANS_MULTI_THREAD_HPP__
+#define __KNOR_KMEANS_MULTI_THREAD_HPP__
+
+#include "thread.hpp"
+
+namespace knor {
+/**
+  * Runs every restart of a multi-start k-means over this thread's rows.
+  *  Restart i has ks[i] clusters (all equal for restarts, distinct for a
+  *  k-sweep). Per row state (assignment & distance) is interleaved by
+  *  restart so a row is loaded once and compared against all centroids.
+  */
+class kmeans_multi_thread : public thread {
+    private:
+        const unsigned nstart;
+        const unsigned* ks; // nstart, clusters per restart
+        const size_t* koffs; // nstart, first centroid of each restart
+        size_t nclust; // Centroids across all restarts
+        unsigned nprocrows; // The number of rows in this threads partition
+        const double* g_means; // nclust x ncol
+        const char* g_active; // nstart, restarts still iterating
+
+        // Per restart sums of this thread's rows. First touched by the thread.
+        std::vector<double> sums; // nclust x ncol
+        std::vector<double> memb_weights; // nclust, member count if unweighted
+        std::vector<size_t> nchanged; // nstart
+        std::vector<double> energy; // nstart, also kmeans++ cumulative dist
+
+        kmeans_multi_thread(const int node_id, const unsigned thd_id,
+                const unsigned start_rid, const unsigned nprocrows,
+                const unsigned ncol, const unsigned nstart, const unsigned* ks,
+                const size_t* koffs, const double* g_means,
+                const char* g_active, unsigned* cluster_assignments,
+                const std::string fn, base::dist_t dist_metric);
+
+        void reset_stats(const bool clear_sums);
+    public:
+        static thread::ptr create(
+                const int node_id, const unsigned thd_id,
+                const unsigned start_rid, const unsigned nprocrows,
+                const unsigned ncol, const unsigned nstart, const unsigned* ks,
+                const size_t* koffs, const double* g_means,
+                const char* g_active, unsigned* cluster_assignments,
+                const std::string fn, base::dist_t dist_metric) {
+            return thread::ptr(
+                    new kmeans_multi_thread(node_id, thd_id, start_rid,
+                        nprocrows, ncol, nstart, ks, koffs, g_means, g_active,
+                        cluster_assignments, fn, dist_metric));
+        }
+
+        void start(const thread_state_t state) override;
+        // Assign each row to its nearest centroid in every active restart
+        void EM_step();
+        // Distance to centroid meta.clust_idx of every restart (kmeans++)
+        void kmspp_dist();
+        virtual void run() override;
+
+        const unsigned get_nprocrows() const { return nprocrows; }
+        const double* get_sums() const { return &sums[0]; }
+        const double* get_memb_weights() const { return &memb_weights[0]; }
+        const size_t get_nchanged(const unsigned start) const {
+            return nchanged[start];
+        }
+        const double get_energy(const unsigned start) const {
+            return energy[start];
+        }
+};
+}
+#endif
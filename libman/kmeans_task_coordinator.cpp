@@ -209,12 +209,12 @@ void kmeans_task_coordinator::kmeanspp_init() {
         wait4complete();
         double cuml_dist = reduction_on_cuml_sum(); // Sum the per thread cumulative dists
 
-        cuml_dist = (cuml_dist * ur_distribution(generator)) / (RAND_MAX - 1.0);
+        cuml_dist *= ur_distribution(generator);
         if (++clust_idx >= k)  // No more centers needed
             break;
 
         for (size_t row = 0; row < nrow; row++) {
-            cuml_dist -= dist_v[row];
+            cuml_dist -= get_row_weight(row)*dist_v[row];
             if (cuml_dist <= 0) {
 #if KM_TEST
 #ifndef BIND
@@ -296,7 +296,7 @@ void kmeans_task_coordinator::set_task_data_ptrs() {
 double kmeans_task_coordinator::compute_cluster_energy() {
     double cluster_energy = 0;
     for (size_t row = 0; row < nrow; row++)
-        cluster_energy += dist_v[row];
+        cluster_energy += get_row_weight(row)*dist_v[row];
     return cluster_energy;
 }
 
@@ -157,6 +157,21 @@ void kmeans_task_thread::mb_finalize_centroids(const double* eta) {
     mb_selected.clear();
 }
 
+void kmeans_task_thread::mb_batch_deltas(double* deltas, double* nbatch) {
+    for (unsigned local_rid : mb_selected) {
+        auto cid = cluster_assignments[start_rid + local_rid];
+        assert(cid < g_clusters->get_nclust());
+
+        const double* row = &(local_data[local_rid*ncol]);
+        const double* mean = &(g_clusters->get_means()[cid*ncol]);
+        for (size_t col = 0; col < ncol; col++)
+            deltas[cid*ncol+col] += row[col] - mean[col];
+        nbatch[cid]++;
+    }
+
+    mb_selected.clear();
+}
+
 void kmeans_task_thread::mb_EM_step() {
     for (unsigned row = 0; row < curr_task->get_nrow(); row++) {
         if (ur_distribution(generator) > mb_perctg)
@@ -254,13 +269,26 @@ void kmeans_task_thread::EM_step() {
 
         if (prune_init) {
             meta.num_changed++;
-            local_clusters->add_member(&(curr_task->get_data_ptr()[row*ncol]),
-                    cluster_assignments[true_row_id]);
+            if (is_weighted())
+                local_clusters->add_member(
+                        &(curr_task->get_data_ptr()[row*ncol]),
+                        cluster_assignments[true_row_id],
+                        weights[true_row_id]);
+            else
+                local_clusters->add_member(
+                        &(curr_task->get_data_ptr()[row*ncol]),
+                        cluster_assignments[true_row_id]);
         } else if (old_clust != cluster_assignments[true_row_id]) {
             meta.num_changed++;
-            local_clusters->swap_membership(
-                    &(curr_task->get_data_ptr()[row*ncol]),
-                    old_clust, cluster_assignments[true_row_id]);
+            if (is_weighted())
+                local_clusters->swap_membership(
+                        &(curr_task->get_data_ptr()[row*ncol]),
+                        old_clust, cluster_assignments[true_row_id],
+                        weights[true_row_id]);
+            else
+                local_clusters->swap_membership(
+                        &(curr_task->get_data_ptr()[row*ncol]),
+                        old_clust, cluster_assignments[true_row_id]);
         }
     }
 }
@@ -283,7 +311,7 @@ void kmeans_task_thread::kmspp_dist() {
             cluster_assignments[true_row_id] = clust_idx;
         }
 
-        cuml_dist += dist_v[true_row_id];
+        cuml_dist += get_weight(true_row_id)*dist_v[true_row_id];
     }
 }
 } } // End namespace knor, prune
@@ -61,6 +61,9 @@ public:
     // Mini-batch
     void set_mb_perctg(const double mb_perctg) { this->mb_perctg = mb_perctg; }
     void mb_finalize_centroids(const double* eta);
+    // Add each sampled row's (row - mean) to deltas (k x ncol) & count it in
+    //  nbatch (k) under its cluster, then clear the sample
+    void mb_batch_deltas(double* deltas, double* nbatch);
     const size_t sample_size() const { return mb_selected.size(); }
     // End Mini-batch
 
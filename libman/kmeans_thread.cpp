@@ -34,7 +34,8 @@ kmeans_thread::kmeans_thread(const int node_id, const unsigned thd_id,
         const std::string fn, kbase::dist_t dist_metric) :
             thread(node_id, thd_id, ncol,
             cluster_assignments, start_rid, fn, dist_metric),
-        g_clusters(g_clusters), nprocrows(nprocrows){
+        g_clusters(g_clusters), nprocrows(nprocrows), graph(nullptr),
+        ef_search(0) {
 
             local_clusters =
                 kbase::clusters::create(g_clusters->get_nclust(), ncol);
@@ -80,27 +81,40 @@ void kmeans_thread::EM_step() {
         unsigned asgnd_clust = kbase::INVALID_CLUSTER_ID;
         double best, dist;
         dist = best = std::numeric_limits<double>::max();
+        unsigned true_row_id = get_global_data_id(row);
 
-        for (unsigned clust_idx = 0;
-                clust_idx < g_clusters->get_nclust(); clust_idx++) {
-            dist = kbase::dist_comp_raw<double>(&local_data[row*ncol],
-                    &(g_clusters->get_means()[clust_idx*ncol]), ncol,
-                    dist_metric);
-
-            if (dist < best) {
-                best = dist;
-                asgnd_clust = clust_idx;
+        if (graph) {
+            // Start from the last centroid, it's likely still close
+            unsigned start = cluster_assignments[true_row_id];
+            if (start == kbase::INVALID_CLUSTER_ID)
+                start = 0;
+            asgnd_clust = graph->search(&local_data[row*ncol], start,
+                    ef_search, best, visits);
+        } else {
+            for (unsigned clust_idx = 0;
+                    clust_idx < g_clusters->get_nclust(); clust_idx++) {
+                dist = kbase::dist_comp_raw<double>(&local_data[row*ncol],
+                        &(g_clusters->get_means()[clust_idx*ncol]), ncol,
+                        dist_metric);
+
+                if (dist < best) {
+                    best = dist;
+                    asgnd_clust = clust_idx;
+                }
             }
         }
 
         assert(asgnd_clust != kbase::INVALID_CLUSTER_ID);
-        unsigned true_row_id = get_global_data_id(row);
 
         if (asgnd_clust != cluster_assignments[true_row_id])
             meta.num_changed++;
 
         cluster_assignments[true_row_id] = asgnd_clust;
-        local_clusters->add_member(&local_data[row*ncol], asgnd_clust);
+        if (is_weighted())
+            local_clusters->add_member(&local_data[row*ncol], asgnd_clust,
+                    weights[true_row_id]);
+        else
+            local_clusters->add_member(&local_data[row*ncol], asgnd_clust);
     }
 }
 
@@ -120,7 +134,7 @@ void kmeans_thread::kmspp_dist() {
             dist_v[true_row_id] = dist;
             cluster_assignments[true_row_id] = clust_idx;
         }
-        cuml_dist += dist_v[true_row_id];
+        cuml_dist += get_weight(true_row_id)*dist_v[true_row_id];
     }
 }
 
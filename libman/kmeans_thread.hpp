@@ -21,6 +21,7 @@
 #define __KNOR_KMEANS_THREAD_HPP__
 
 #include "thread.hpp"
+#include "centroid_graph.hpp"
 
 namespace knor { namespace base {
     class clusters;
@@ -34,6 +35,10 @@ class kmeans_thread : public thread {
          // Pointer to global cluster data
         std::shared_ptr<kbase::clusters> g_clusters;
         unsigned nprocrows; // The number of rows in this threads partition
+        // Centroid graph for approximate assignment. NULL means exact.
+        std::shared_ptr<kbase::centroid_graph> graph;
+        unsigned ef_search;
+        kbase::centroid_graph::visit_list visits;
 
         kmeans_thread(const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
@@ -56,6 +61,12 @@ class kmeans_thread : public thread {
         }
 
         void start(const thread_state_t state) override;
+        // Search the graph from each row's last centroid in the E-step
+        void set_graph(std::shared_ptr<kbase::centroid_graph> graph,
+                const unsigned ef_search) {
+            this->graph = graph;
+            this->ef_search = ef_search;
+        }
         // Allocate and move data using this thread
         void EM_step();
         void kmspp_dist();
@@ -19,6 +19,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 
 #include "medoid.hpp"
 #include "types.hpp"
@@ -35,12 +36,14 @@ medoid::medoid(const int node_id, const unsigned thd_id,
         const std::string fn, const double sample_rate):
             thread(node_id, thd_id, ncol, cluster_assignments, start_rid, fn),
             g_clusters(g_clusters), nprocrows(nprocrows),
-            sample_rate(sample_rate) {
+            sample_rate(sample_rate), cached_rows(0), computed_rows(0),
+            check_delta(0) {
 
             local_clusters =
                 kbase::clusters::create(g_clusters->get_nclust(), ncol);
             set_data_size(sizeof(double)*nprocrows*ncol);
             local_medoid_energy.assign(g_clusters->get_nclust(),0);
+            local_membership.resize(g_clusters->get_nclust());
 
             // For sampling
             ur_distribution = std::uniform_real_distribution<double>(0.0, 1.0);
@@ -58,7 +61,16 @@ void medoid::run() {
             EM_step();
             break;
         case MEDOID:
-            medoid_step();
+            if (coord->get_alg() == medoid_coordinator::ALTERNATE) {
+                if (dist_cache)
+                    cached_medoid_step();
+                else
+                    medoid_step();
+            } else
+                swap_step();
+            break;
+        case SWAP_CHECK:
+            swap_check();
             break;
         case EXIT:
             throw kbase::thread_exception(
@@ -81,12 +93,20 @@ void medoid::EM_step() {
     meta.num_changed = 0; // Always reset at the beginning of an EM-step
     local_clusters->clear();
     local_medoid_energy.assign(g_clusters->get_nclust(), 0);
+    for (auto& v : local_membership)
+        v.clear();
+    // First touch happens here so these are NUMA local
+    nearest_dist.resize(nprocrows);
+    second_dist.resize(nprocrows);
+    nearest_idx.resize(nprocrows);
+    second_idx.resize(nprocrows);
 
     for (unsigned row = 0; row < nprocrows; row++) {
         // Choose row as new cluster center
         unsigned asgnd_clust = kbase::INVALID_CLUSTER_ID;
-        double best, dist;
-        dist = best = std::numeric_limits<double>::max();
+        unsigned second_clust = kbase::INVALID_CLUSTER_ID;
+        double best, second, dist;
+        dist = best = second = std::numeric_limits<double>::max();
         unsigned true_rid = get_global_data_id(row);
 
         for (unsigned clust_idx = 0;
@@ -97,12 +117,22 @@ void medoid::EM_step() {
                     dist_metric);
 
             if (dist < best) {
+                second = best;
+                second_clust = asgnd_clust;
                 best = dist;
                 asgnd_clust = clust_idx;
+            } else if (dist < second) {
+                second = dist;
+                second_clust = clust_idx;
             }
         }
 
         assert(asgnd_clust != kbase::INVALID_CLUSTER_ID);
+        nearest_dist[row] = best;
+        second_dist[row] = second;
+        nearest_idx[row] = asgnd_clust;
+        second_idx[row] = second_clust;
+        local_membership[asgnd_clust].push_back(true_rid);
 
         if (asgnd_clust != cluster_assignments[true_rid])
             meta.num_changed++;
@@ -151,4 +181,242 @@ void medoid::medoid_step() {
     }
 }
 
+/**
+  * medoid_step that serves member distances from tiles. Members of a cluster
+  *  are split into blocks by rid range and tile (br, bj) holds the distances
+  *  between the members in blocks br and bj. Sampled candidates are batched
+  *  by block so each tile is fetched once per iteration, and only the rows of
+  *  sampled candidates are computed. A row is only served from the cache if
+  *  its candidate is sampled again while the members of both blocks are
+  *  unchanged, which is rare, so the coordinator reports the hit rate.
+  */
+void medoid::cached_medoid_step() {
+    const unsigned nclust = g_clusters->get_nclust();
+    candidate_medoids.assign(nclust, -1);
+    candidate_medoid_energy.assign(nclust,
+            std::numeric_limits<double>::max());
+
+    // Sample exactly as medoid_step
+    std::vector<std::pair<unsigned, unsigned> > cands; // (cid, rid)
+    for (unsigned row = 0; row < nprocrows; row++) {
+        if (ur_distribution(generator) > sample_rate)
+            continue;
+        unsigned true_rid = get_global_data_id(row);
+        cands.push_back(std::pair<unsigned, unsigned>(
+                    cluster_assignments[true_rid], true_rid));
+    }
+    // Group by cluster then block. rids are already ascending.
+    std::stable_sort(cands.begin(), cands.end(),
+            [](const std::pair<unsigned, unsigned>& a,
+                const std::pair<unsigned, unsigned>& b) {
+            return a.first < b.first; });
+
+    const size_t span = coord->get_member_block_span();
+    const size_t nblocks = coord->get_num_member_blocks();
+    std::vector<const double*> col_data;
+    std::vector<size_t> pos;
+    std::vector<double> energy, scratch;
+
+    size_t gstart = 0;
+    while (gstart < cands.size()) {
+        const unsigned cid = cands[gstart].first;
+        const size_t br = cands[gstart].second / span;
+        size_t gend = gstart;
+        while (gend < cands.size() && cands[gend].first == cid &&
+                cands[gend].second / span == br)
+            gend++;
+
+        const std::vector<unsigned>& members = coord->get_membership()[cid];
+        const std::vector<size_t>& offsets =
+            coord->get_member_block_offsets()[cid];
+        const std::vector<uint64_t>& sigs =
+            coord->get_member_block_sigs()[cid];
+
+        const unsigned* rows = members.data() + offsets[br];
+        const size_t nrows = offsets[br+1] - offsets[br];
+        // Position of each candidate within the row block
+        pos.clear();
+        for (size_t cand = gstart; cand < gend; cand++)
+            pos.push_back(std::lower_bound(rows, rows + nrows,
+                        cands[cand].second) - rows);
+        energy.assign(gend - gstart, 0);
+
+        for (size_t bj = 0; bj < nblocks; bj++) {
+            const unsigned* cols = members.data() + offsets[bj];
+            const size_t ncols = offsets[bj+1] - offsets[bj];
+            if (ncols == 0)
+                continue;
+
+            const uint64_t key = ((uint64_t)cid*nblocks + br)*nblocks + bj;
+            kbase::dist_tile* tile = dist_cache->get(key, sigs[br], sigs[bj]);
+            if (NULL == tile)
+                tile = dist_cache->put(key, sigs[br], sigs[bj], nrows, ncols);
+
+            col_data.clear();
+            for (size_t cand = 0; cand < pos.size(); cand++) {
+                const size_t i = pos[cand];
+                const double* drow;
+
+                if (tile && tile->row_done[i]) {
+                    drow = &(tile->dists[i*ncols]);
+                    cached_rows++;
+                } else {
+                    computed_rows++;
+                    if (col_data.empty())
+                        for (size_t j = 0; j < ncols; j++)
+                            col_data.push_back(coord->get_thd_data(cols[j]));
+
+                    // Rows of tiles too big for the budget use scratch space
+                    double* wrow;
+                    if (tile) {
+                        wrow = &(tile->dists[i*ncols]);
+                        tile->row_done[i] = 1;
+                    } else {
+                        scratch.resize(ncols);
+                        wrow = &scratch[0];
+                    }
+
+                    // Candidates are rows of this thread
+                    const double* x =
+                        &local_data[(rows[i] - start_rid)*ncol];
+                    for (size_t j = 0; j < ncols; j++)
+                        wrow[j] = kbase::dist_comp_raw<double>(x,
+                                col_data[j], ncol, dist_metric);
+                    drow = wrow;
+                }
+
+                for (size_t j = 0; j < ncols; j++)
+                    if (cols[j] != rows[i])
+                        energy[cand] += drow[j];
+            }
+        }
+
+        for (size_t cand = 0; cand < pos.size(); cand++) {
+            if (energy[cand] < candidate_medoid_energy[cid]) {
+                candidate_medoid_energy[cid] = energy[cand];
+                candidate_medoids[cid] = cands[gstart+cand].second;
+            }
+        }
+        gstart = gend;
+    }
+}
+
+/**
+  * FastPAM1 style evaluation of swapping every medoid with each candidate of
+  *  the coordinator's current block in one pass over the rows. For row o
+  *  with nearest medoid n, distances dn and ds to its nearest and second
+  *  nearest medoids and distance d to candidate c, replacing medoid i by c
+  *  changes the distance of o by:
+  *      min(d, dn) - dn                     if i != n
+  *      min(d, ds) - dn                     if i == n
+  *  The first term is shared by all i and accumulated once per candidate.
+  */
+void medoid::swap_step() {
+    const unsigned nclust = g_clusters->get_nclust();
+    const std::vector<double>& cands = coord->get_swap_candidates();
+    const size_t cstart = coord->get_swap_begin();
+    const size_t cend = coord->get_swap_end();
+    const std::vector<char>& eval_mask = coord->get_eval_mask();
+
+    swap_delta.assign((cend-cstart)*nclust, 0);
+    shared_delta.assign(cend-cstart, 0);
+
+    for (unsigned row = 0; row < nprocrows; row++) {
+        unsigned true_rid = get_global_data_id(row);
+        if (!eval_mask.empty() && !eval_mask[true_rid])
+            continue;
+
+        const double dn = nearest_dist[row];
+        const double ds = second_dist[row];
+        const unsigned near = cluster_assignments[true_rid];
+
+        for (size_t cand = cstart; cand < cend; cand++) {
+            double d = kbase::dist_comp_raw<double>(&local_data[row*ncol],
+                    &cands[cand*ncol], ncol, dist_metric);
+            double md = std::min(d, dn);
+            shared_delta[cand-cstart] += md - dn;
+            swap_delta[(cand-cstart)*nclust+near] += std::min(d, ds) - md;
+        }
+    }
+}
+
+/**
+  * Update the nearest and second nearest medoids of row after medoid cid
+  *  moved to a row at distance dist. Only rows that lost one of the two
+  *  are compared against every medoid again.
+  */
+void medoid::apply_swap(const unsigned row, const unsigned cid,
+        const double dist) {
+    if (nearest_idx[row] == cid || second_idx[row] == cid) {
+        double best, second;
+        best = second = std::numeric_limits<double>::max();
+        unsigned best_idx = kbase::INVALID_CLUSTER_ID;
+        unsigned sec_idx = kbase::INVALID_CLUSTER_ID;
+        for (unsigned clust_idx = 0;
+                clust_idx < g_clusters->get_nclust(); clust_idx++) {
+            double d = (clust_idx == cid) ? dist :
+                kbase::dist_comp_raw<double>(&local_data[row*ncol],
+                    &(g_clusters->get_means()[clust_idx*ncol]), ncol,
+                    dist_metric);
+            if (d < best) {
+                second = best;
+                sec_idx = best_idx;
+                best = d;
+                best_idx = clust_idx;
+            } else if (d < second) {
+                second = d;
+                sec_idx = clust_idx;
+            }
+        }
+        nearest_dist[row] = best;
+        nearest_idx[row] = best_idx;
+        second_dist[row] = second;
+        second_idx[row] = sec_idx;
+    } else if (dist < nearest_dist[row]) {
+        second_dist[row] = nearest_dist[row];
+        second_idx[row] = nearest_idx[row];
+        nearest_dist[row] = dist;
+        nearest_idx[row] = cid;
+    } else if (dist < second_dist[row]) {
+        second_dist[row] = dist;
+        second_idx[row] = cid;
+    }
+}
+
+/**
+  * The exact change in energy of the swap the coordinator checks, given the
+  *  swaps it already applied. The last applied swap is folded into the
+  *  nearest medoids of each row first.
+  */
+void medoid::swap_check() {
+    const unsigned nclust = g_clusters->get_nclust();
+    const std::vector<double>& cands = coord->get_swap_candidates();
+    const std::vector<char>& eval_mask = coord->get_eval_mask();
+    const unsigned applied = coord->get_applied_cid();
+    const double* applied_row = applied < nclust ?
+        &cands[coord->get_applied_cand()*ncol] : NULL;
+    const unsigned cid = coord->get_check_cid();
+    const double* cand_row = &cands[coord->get_check_cand()*ncol];
+
+    check_delta = 0;
+    for (unsigned row = 0; row < nprocrows; row++) {
+        unsigned true_rid = get_global_data_id(row);
+        if (!eval_mask.empty() && !eval_mask[true_rid])
+            continue;
+
+        const double* x = &local_data[row*ncol];
+        if (applied_row)
+            apply_swap(row, applied, kbase::dist_comp_raw<double>(x,
+                        applied_row, ncol, dist_metric));
+
+        const double d = kbase::dist_comp_raw<double>(x, cand_row, ncol,
+                dist_metric);
+        const double dn = nearest_dist[row];
+        if (nearest_idx[row] == cid)
+            check_delta += std::min(d, second_dist[row]) - dn;
+        else
+            check_delta += std::min(d, dn) - dn;
+    }
+}
+
 } // End namespace knor
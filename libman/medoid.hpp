@@ -22,6 +22,7 @@
 
 #include <vector>
 #include "thread.hpp"
+#include "dist_tile_cache.hpp"
 #include <random>
 
 namespace kprune = knor::prune;
@@ -46,6 +47,22 @@ class medoid : public thread {
         std::default_random_engine generator;
         std::uniform_real_distribution<double> ur_distribution;
         medoid_coordinator* coord;
+        // Member rids of each cluster within this threads partition
+        std::vector<std::vector<unsigned> > local_membership;
+        // Distances between members of the same cluster
+        kbase::dist_tile_cache::ptr dist_cache;
+        size_t cached_rows, computed_rows; // Candidate tile rows
+
+        // Swap (FastPAM) specific
+        std::vector<double> nearest_dist; // Distance to the closest medoid
+        std::vector<double> second_dist; // Distance to the 2nd closest medoid
+        std::vector<unsigned> nearest_idx; // The closest medoid
+        std::vector<unsigned> second_idx; // The 2nd closest medoid
+        double check_delta; // Energy change of the swap SWAP_CHECK evaluates
+        // Change in energy of the current candidate block (nblock x k) and
+        //  the part of it common to all swaps (nblock)
+        std::vector<double> swap_delta;
+        std::vector<double> shared_delta;
 
         // End Medoid specific
 
@@ -73,11 +90,24 @@ class medoid : public thread {
         // Allocate and move data using this thread
         void EM_step();
         void medoid_step();
+        void cached_medoid_step();
+        void swap_step();
+        void apply_swap(const unsigned row, const unsigned cid,
+                const double dist);
+        void swap_check();
         void run() override;
         void set_coordinator(medoid_coordinator* coord) {
             this->coord = coord;
         }
 
+        void set_dist_cache(const size_t budget) {
+            dist_cache = budget ? kbase::dist_tile_cache::create(budget) :
+                nullptr;
+        }
+
+        const size_t get_cached_rows() const { return cached_rows; }
+        const size_t get_computed_rows() const { return computed_rows; }
+
         // Medoid specific
         std::vector<double>& get_local_medoid_energy() {
             return local_medoid_energy;
@@ -90,6 +120,20 @@ class medoid : public thread {
         std::vector<double>& get_candidate_energy() {
             return candidate_medoid_energy;
         }
+
+        const std::vector<std::vector<unsigned> >&
+            get_local_membership() const {
+            return local_membership;
+        }
+
+        const std::vector<double>& get_swap_delta() const {
+            return swap_delta;
+        }
+
+        const std::vector<double>& get_shared_delta() const {
+            return shared_delta;
+        }
+        const double get_check_delta() const { return check_delta; }
         // End Medoid specific
 };
 }
@@ -19,6 +19,8 @@
 
 #include <random>
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
 
 #include "medoid_coordinator.hpp"
 #include "medoid.hpp"
@@ -26,15 +28,27 @@
 #include "clusters.hpp"
 #include "exception.hpp"
 
+// Expected members per side of a medoid distance tile
+#define MEDOID_TILE_DIM 64
+// Swap candidates per medoid per log2 of the evaluated rows
+#define SWAP_CANDS_PER_LOG 1
+// Swap candidates evaluated per pass over the rows. Bounds the per thread
+//  swap deltas to SWAP_BLOCK x k and keeps the block cache resident.
+#define SWAP_BLOCK 32
+
 namespace knor {
 medoid_coordinator::medoid_coordinator(const std::string fn, const size_t nrow,
         const size_t ncol, const unsigned k, const unsigned max_iters,
         const unsigned nnodes, const unsigned nthreads,
         const double* centers, const kbase::init_t it,
         const double tolerance, const kbase::dist_t dt,
-        const double sample_rate) :
+        const double sample_rate, const alg_t alg,
+        const size_t clara_nsamples, const size_t dist_cache_budget) :
     coordinator(fn, nrow, ncol, k, max_iters,
-            nnodes, nthreads, centers, it, tolerance, dt) {
+            nnodes, nthreads, centers, it, tolerance, dt),
+    dist_cache_budget(dist_cache_budget), alg(alg), applied_cid(k),
+    check_cid(k), applied_cand(0), check_cand(0), swap_begin(0),
+    swap_end(0) {
 
         cltrs = kbase::clusters::create(k, ncol);
         if (centers) {
@@ -53,19 +67,76 @@ medoid_coordinator::medoid_coordinator(const std::string fn, const size_t nrow,
         medoid_energy.assign(k, 0);
         medoids_changed = true; // Run at least 1 iter
 
-        // At least 1 element should be processed by each threads!
-        this->sample_rate = std::max(.2, sample_rate);
+        if (alg == ALTERNATE) {
+            // At least 1 element should be processed by each threads!
+            this->sample_rate = std::max(.2, sample_rate);
+        } else {
+            kbase::assert_msg(sample_rate > 0 && sample_rate <= 1,
+                    "[FATAL]: sample_rate must be in (0, 1]");
+            this->sample_rate = sample_rate;
+        }
+
+        // Default CLARA sample size from Kaufman & Rousseeuw
+        this->clara_nsamples = std::min(nrow,
+                clara_nsamples ? clara_nsamples : (size_t)(40 + 2*k));
+        // Blocks hold MEDOID_TILE_DIM members when clusters are balanced
+        member_block_span = MEDOID_TILE_DIM*k;
+        num_member_blocks = (nrow + member_block_span - 1) / member_block_span;
+        if (alg != ALTERNATE)
+            this->dist_cache_budget = 0; // Only used by the medoid step
+
         build_thread_state();
     }
 
+/**
+  * Threads record the members of each cluster in their partition during the
+  *  EM step. Partitions are contiguous so concatenating them in thread order
+  *  keeps each list sorted by rid.
+  */
 void medoid_coordinator::populate_membership() {
 #ifdef _OPENMP
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (unsigned cid = 0; cid < k; cid++) {
+        size_t nmemb = 0;
+        for (auto const& th : threads)
+            nmemb += std::static_pointer_cast<medoid>(
+                    th)->get_local_membership()[cid].size();
+
+        membership[cid].clear();
+        membership[cid].reserve(nmemb);
+        for (auto const& th : threads) {
+            auto const& lm = std::static_pointer_cast<medoid>(
+                    th)->get_local_membership()[cid];
+            membership[cid].insert(membership[cid].end(),
+                    lm.begin(), lm.end());
+        }
+    }
+}
+
+void medoid_coordinator::compute_member_blocks() {
+    member_block_offsets.resize(k);
+    member_block_sigs.resize(k);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
 #endif
     for (unsigned cid = 0; cid < k; cid++) {
-        for (size_t rid = 0; rid < nrow; rid++) {
-            if (cluster_assignments[rid] == cid)
-                membership[cid].push_back(rid);
+        const std::vector<unsigned>& members = membership[cid];
+        std::vector<size_t>& offsets = member_block_offsets[cid];
+        std::vector<uint64_t>& sigs = member_block_sigs[cid];
+        offsets.assign(num_member_blocks+1, members.size());
+        sigs.resize(num_member_blocks);
+
+        // Members are sorted by rid
+        size_t idx = 0;
+        for (size_t block = 0; block < num_member_blocks; block++) {
+            offsets[block] = idx;
+            while (idx < members.size() &&
+                    members[idx] / member_block_span == block)
+                idx++;
+            sigs[block] = kbase::dist_tile_cache::signature(
+                    members.data() + offsets[block], idx - offsets[block]);
         }
     }
 }
@@ -84,6 +155,8 @@ void medoid_coordinator::build_thread_state() {
         threads[thd_id]->set_parent_pending_threads(&pending_threads);
         threads[thd_id]->start(WAIT); // Thread puts itself to sleep
         std::static_pointer_cast<medoid>(threads[thd_id])->set_coordinator(this);
+        std::static_pointer_cast<medoid>(threads[thd_id])->set_dist_cache(
+                dist_cache_budget / nthreads);
     }
 }
 
@@ -101,6 +174,7 @@ void medoid_coordinator::choose_global_medoids(double* gdata) {
     std::vector<unsigned> agg_candidate_medoids;
     std::vector<double> agg_candidate_medoid_energy;
 
+    medoids_changed = false; // Reset
     agg_candidate_medoids.assign(cltrs->get_nclust(), -1);
     agg_candidate_medoid_energy.assign(cltrs->get_nclust(),
             std::numeric_limits<double>::max());
@@ -137,9 +211,141 @@ void medoid_coordinator::choose_global_medoids(double* gdata) {
     }
 }
 
+/**
+  * Choose the rows swap energies are evaluated on in CLARA mode
+  */
+void medoid_coordinator::clara_sample() {
+    eval_mask.assign(nrow, 0);
+    eval_rows.clear();
+
+    std::uniform_int_distribution<size_t> distribution(0, nrow-1);
+    while (eval_rows.size() < clara_nsamples) {
+        size_t rid = distribution(generator);
+        if (!eval_mask[rid]) {
+            eval_mask[rid] = 1;
+            eval_rows.push_back(rid);
+        }
+    }
+}
+
+/**
+  * Draw sample_rate of the evaluated rows, at most O(k log n) of them, as
+  *  swap candidates and copy them to a contiguous matrix so threads never
+  *  touch remote rows. The swap step costs ncand distances per row.
+  */
+void medoid_coordinator::sample_swap_candidates() {
+    const size_t neval = (alg == CLARA) ? eval_rows.size() : nrow;
+    const size_t max_cand = SWAP_CANDS_PER_LOG*k*
+        (size_t)std::ceil(std::log2((double)neval + 1));
+    const size_t ncand = std::max((size_t)1, std::min(max_cand,
+            (size_t)std::ceil(sample_rate*neval)));
+
+    std::uniform_int_distribution<size_t> distribution(0, neval-1);
+    swap_cand_ids.resize(ncand);
+    swap_cands.resize(ncand*ncol);
+
+    for (size_t cand = 0; cand < ncand; cand++) {
+        size_t idx = distribution(generator);
+        unsigned rid = (alg == CLARA) ? eval_rows[idx] : idx;
+        swap_cand_ids[cand] = rid;
+        const double* row = get_thd_data(rid);
+        std::copy(row, row + ncol, &swap_cands[cand*ncol]);
+    }
+}
+
+/**
+  * Evaluate the swap candidates a block at a time, keeping the best
+  *  improving swap of each medoid, then greedily apply them (FastPAM2),
+  *  never reusing a candidate. The deltas assume every other medoid stays
+  *  put, so once a swap is applied the next ones are re-evaluated against
+  *  the current medoids and only applied if they still lower the energy.
+  */
+void medoid_coordinator::apply_swaps() {
+    const size_t ncand = swap_cand_ids.size();
+    std::vector<double> best_delta(k, 0);
+    std::vector<size_t> best_cand(k, ncand);
+
+    // Ignore improvements that are within rounding error
+    double energy = 0;
+    for (auto const& e : medoid_energy)
+        energy += e;
+    const double eps = -energy*1E-12;
+
+    std::vector<double> delta(SWAP_BLOCK*k);
+    for (swap_begin = 0; swap_begin < ncand; swap_begin = swap_end) {
+        swap_end = std::min(ncand, swap_begin + SWAP_BLOCK);
+        wake4run(MEDOID);
+        wait4complete();
+
+        const size_t nblock = swap_end - swap_begin;
+        std::fill(delta.begin(), delta.begin() + nblock*k, 0);
+        for (auto const& th : threads) {
+            auto t = std::static_pointer_cast<medoid>(th);
+            for (size_t cand = 0; cand < nblock; cand++) {
+                const double shared = t->get_shared_delta()[cand];
+                const double* sd = &(t->get_swap_delta()[cand*k]);
+                for (unsigned cid = 0; cid < k; cid++)
+                    delta[cand*k+cid] += shared + sd[cid];
+            }
+        }
+
+        for (size_t cand = 0; cand < nblock; cand++) {
+            for (unsigned cid = 0; cid < k; cid++) {
+                if (delta[cand*k+cid] < best_delta[cid] &&
+                        delta[cand*k+cid] < eps) {
+                    best_delta[cid] = delta[cand*k+cid];
+                    best_cand[cid] = swap_begin + cand;
+                }
+            }
+        }
+    }
+
+    std::vector<unsigned> order;
+    for (unsigned cid = 0; cid < k; cid++)
+        if (best_cand[cid] != ncand)
+            order.push_back(cid);
+    std::sort(order.begin(), order.end(),
+            [&best_delta](const unsigned a, const unsigned b) {
+            return best_delta[a] < best_delta[b]; });
+
+    medoids_changed = false;
+    applied_cid = k;
+    std::vector<unsigned> used;
+    for (auto const& cid : order) {
+        const size_t cand = best_cand[cid];
+        const unsigned rid = swap_cand_ids[cand];
+        if (std::find(used.begin(), used.end(), rid) != used.end())
+            continue;
+
+        if (medoids_changed) {
+            check_cid = cid;
+            check_cand = cand;
+            wake4run(SWAP_CHECK);
+            wait4complete();
+            applied_cid = k; // Threads folded it into their nearest medoids
+
+            double delta = 0;
+            for (auto const& th : threads)
+                delta += std::static_pointer_cast<medoid>(
+                        th)->get_check_delta();
+            if (!(delta < eps))
+                continue;
+        }
+        used.push_back(rid);
+
+        medoids_changed = true;
+        cltrs->get_num_members_v()[cid] = rid;
+        cltrs->set_mean(&swap_cands[cand*ncol], cid);
+        applied_cid = cid;
+        applied_cand = cand;
+    }
+}
+
 void medoid_coordinator::compute_globals() {
     // Compute the membership assignments
     populate_membership();
+    if (dist_cache_budget)
+        compute_member_blocks();
     // Always reset here since there's no pruning
     num_changed = 0;
     std::fill(cluster_assignment_counts.begin(),
@@ -179,6 +385,9 @@ void medoid_coordinator::forgy_init() {
 }
 
 void medoid_coordinator::run_init() {
+    if (alg == CLARA)
+        clara_sample();
+
     if (_init_t == kbase::init_t::FORGY) {
         forgy_init();
         // Run one EM step to assign samples to a cluster
@@ -224,13 +433,21 @@ kbase::cluster_t medoid_coordinator::run(
 #ifndef BIND
         printf("Medoid step ...\n");
 #endif
-        wake4run(MEDOID);
-        wait4complete();
         // (Possibly) Sets: 1. new medoids, new energy
+        if (alg == ALTERNATE) {
+            wake4run(MEDOID);
+            wait4complete();
 #ifndef BIND
-        printf("Choosing global medoids ...\n");
+            printf("Choosing global medoids ...\n");
 #endif
-        choose_global_medoids(allocd_data);
+            choose_global_medoids(allocd_data);
+        } else {
+            sample_swap_candidates();
+#ifndef BIND
+            printf("Choosing global medoids ...\n");
+#endif
+            apply_swaps();
+        }
 
 #ifndef BIND
         printf("Medoid Energy:\n");
@@ -242,7 +459,6 @@ kbase::cluster_t medoid_coordinator::run(
 #ifndef BIND
             printf("EM step ...\n");
 #endif
-            clear_membership();
             wake4run(EM);
             wait4complete();
             compute_globals();
@@ -257,8 +473,9 @@ kbase::cluster_t medoid_coordinator::run(
             break;
         }
 
-        if (num_changed == 0 ||
-                ((num_changed/(double)nrow)) <= tolerance) {
+        // Swap algorithms converge only when no improving swap is found
+        if (alg == ALTERNATE && (num_changed == 0 ||
+                ((num_changed/(double)nrow)) <= tolerance)) {
             converged = true;
             break;
         }
@@ -286,6 +503,18 @@ kbase::cluster_t medoid_coordinator::run(
     }
 
 #ifndef BIND
+    if (dist_cache_budget) {
+        size_t cached = 0, computed = 0;
+        for (auto const& th : threads) {
+            auto t = std::static_pointer_cast<medoid>(th);
+            cached += t->get_cached_rows();
+            computed += t->get_computed_rows();
+        }
+        printf("Medoid distance cache hit rate: %.2f%% (%lu of %lu rows)\n",
+                (cached + computed) ? 100.0*cached/(cached + computed) : 0,
+                cached, cached + computed);
+    }
+
     printf("Final cluster counts: \n");
     kbase::print(cluster_assignment_counts);
     printf("\n******************************************\n");
@@ -19,6 +19,8 @@
 #ifndef __KNOR_MEDOID_COORDINATOR_HPP__
 #define __KNOR_MEDOID_COORDINATOR_HPP__
 
+#include <cstdint>
+
 #include "coordinator.hpp"
 #include "util.hpp"
 
@@ -31,6 +33,12 @@ namespace base {
 class thread;
 
 class medoid_coordinator : public coordinator {
+    public:
+        // ALTERNATE: Voronoi iteration over sampled cluster members
+        // FASTPAM: FastPAM swaps against sampled candidate rows
+        // CLARA: FASTPAM with energies evaluated on a fixed row sample
+        enum alg_t { ALTERNATE, FASTPAM, CLARA };
+
     protected:
         // Metadata
         // max index stored within each threads partition
@@ -43,12 +51,35 @@ class medoid_coordinator : public coordinator {
         // Need for medoid step. Contains the rid of members of each cluster
         std::vector<std::vector<unsigned> > membership;
 
+        // Member rids of each cluster split into blocks of rids with the same
+        //  rid / member_block_span. Used to key the medoid distance tiles.
+        size_t dist_cache_budget; // In bytes. 0 disables the cache.
+        size_t member_block_span;
+        size_t num_member_blocks;
+        std::vector<std::vector<size_t> > member_block_offsets; // k x nblocks+1
+        std::vector<std::vector<uint64_t> > member_block_sigs; // k x nblocks
+
+        // Swap specific
+        alg_t alg;
+        size_t clara_nsamples; // Rows in the CLARA evaluation sample
+        std::vector<double> swap_cands; // Candidate rows (ncand x ncol)
+        std::vector<unsigned> swap_cand_ids; // rids of the candidates
+        std::vector<char> eval_mask; // Rows used to evaluate swaps (CLARA)
+        std::vector<unsigned> eval_rows; // rids set in eval_mask
+        // The swap applied since the threads last updated their nearest
+        //  medoids (k if none) and the swap SWAP_CHECK re-evaluates
+        unsigned applied_cid, check_cid;
+        size_t applied_cand, check_cand;
+        size_t swap_begin, swap_end; // Candidates the MEDOID step evaluates
+        std::default_random_engine generator;
+
         medoid_coordinator(const std::string fn, const size_t nrow,
                 const size_t ncol, const unsigned k, const unsigned max_iters,
                 const unsigned nnodes, const unsigned nthreads,
                 const double* centers, const base::init_t it,
                 const double tolerance, const base::dist_t dt,
-                const double sample_rate);
+                const double sample_rate, const alg_t alg,
+                const size_t clara_nsamples, const size_t dist_cache_budget);
 
     public:
         static coordinator::ptr create(const std::string fn,
@@ -57,10 +88,23 @@ class medoid_coordinator : public coordinator {
                 const unsigned nnodes, const unsigned nthreads,
                 const double* centers=NULL, const std::string init="random",
                 const double tolerance=-1, const std::string dist_type="taxi",
-                const double sample_rate=.2) {
+                const double sample_rate=.2,
+                const std::string alg="alternate",
+                const size_t clara_nsamples=0,
+                const size_t dist_cache_budget=0) {
 
             base::init_t _init_t = base::get_init_type(init);
             base::dist_t _dist_t = base::get_dist_type(dist_type);
+            alg_t _alg;
+            if (alg == "alternate")
+                _alg = ALTERNATE;
+            else if (alg == "fastpam")
+                _alg = FASTPAM;
+            else if (alg == "clara")
+                _alg = CLARA;
+            else
+                throw base::parameter_exception("param alg must be one of: "
+                        "'alternate', 'fastpam', 'clara'", alg);
 #if KM_TEST
 #ifndef BIND
             printf("medoid coordinator => NUMA nodes: %u, nthreads: %u, "
@@ -72,7 +116,7 @@ class medoid_coordinator : public coordinator {
             return coordinator::ptr(
                     new medoid_coordinator(fn, nrow, ncol, k, max_iters,
                     nnodes, nthreads, centers, _init_t, tolerance, _dist_t,
-                    sample_rate));
+                    sample_rate, _alg, clara_nsamples, dist_cache_budget));
         }
 
         std::shared_ptr<base::clusters> get_gcltrs() {
@@ -88,6 +132,42 @@ class medoid_coordinator : public coordinator {
             return membership;
         }
 
+        const alg_t get_alg() const { return alg; }
+
+        const size_t get_member_block_span() const {
+            return member_block_span;
+        }
+
+        const size_t get_num_member_blocks() const {
+            return num_member_blocks;
+        }
+
+        const std::vector<std::vector<size_t> >&
+            get_member_block_offsets() const {
+            return member_block_offsets;
+        }
+
+        const std::vector<std::vector<uint64_t> >&
+            get_member_block_sigs() const {
+            return member_block_sigs;
+        }
+
+        const std::vector<double>& get_swap_candidates() const {
+            return swap_cands;
+        }
+
+        const std::vector<char>& get_eval_mask() const {
+            return eval_mask;
+        }
+
+        const size_t get_swap_begin() const { return swap_begin; }
+        const size_t get_swap_end() const { return swap_end; }
+
+        const unsigned get_applied_cid() const { return applied_cid; }
+        const size_t get_applied_cand() const { return applied_cand; }
+        const unsigned get_check_cid() const { return check_cid; }
+        const size_t get_check_cand() const { return check_cand; }
+
         // Pass file handle to threads to read & numa alloc
         virtual base::cluster_t run(double* allocd_data,
                 const bool numa_opt=false) override;
@@ -95,12 +175,21 @@ class medoid_coordinator : public coordinator {
         void run_init() override;
         void forgy_init() override;
         void build_thread_state() override;
+        // Every row counts once
+        void set_thd_weights_ptr(const double* w) override {
+            if (w)
+                throw base::not_implemented_exception();
+        }
 
         // medoid specific
         void populate_membership();
+        void compute_member_blocks();
         void compute_globals();
         void sanity_check(); // Always call compute_globals before this
         void choose_global_medoids(double* gdata=NULL);
+        void clara_sample();
+        void sample_swap_candidates();
+        void apply_swaps();
 };
 }
 #endif
@@ -151,12 +151,12 @@ void skmeans_coordinator::kmeanspp_init() {
         wait4complete();
         double cuml_dist = reduction_on_cuml_sum(); // Sum the per thread cumulative dists
 
-        cuml_dist = (cuml_dist * ur_distribution(generator)) / (RAND_MAX - 1.0);
+        cuml_dist *= ur_distribution(generator);
         if (++clust_idx >= k)  // No more centers needed
             break;
 
         for (size_t row = 0; row < nrow; row++) {
-            cuml_dist -= dist_v[row];
+            cuml_dist -= get_row_weight(row)*dist_v[row];
             if (cuml_dist <= 0) {
                 cltrs->set_mean(get_thd_data(row), clust_idx);
                 cluster_assignments[row] = clust_idx;
@@ -177,7 +177,10 @@ void skmeans_coordinator::random_partition_init() {
         unsigned asgnd_clust = distribution(generator);
         const double* dp = get_thd_data(row);
 
-        cltrs->add_member(dp, asgnd_clust);
+        if (row_weights)
+            cltrs->add_member(dp, asgnd_clust, row_weights[row]);
+        else
+            cltrs->add_member(dp, asgnd_clust);
         cluster_assignments[row] = asgnd_clust;
     }
 
@@ -116,13 +116,15 @@ void thread::numa_alloc_mem() {
 #else
     local_data = new double [blob_size/sizeof(double)];
 #endif
-    fseek(f, start_rid*ncol*sizeof(double), SEEK_SET); // start position
+    if (!defer_read) {
+        fseek(f, start_rid*ncol*sizeof(double), SEEK_SET); // start position
 #ifdef NDEBUG
-    size_t nread = fread(local_data, blob_size, 1, f);
-    nread = nread + 1 - 1; // Silence compiler warning
+        size_t nread = fread(local_data, blob_size, 1, f);
+        nread = nread + 1 - 1; // Silence compiler warning
 #else
-    assert(fread(local_data, blob_size, 1, f) == 1);
+        assert(fread(local_data, blob_size, 1, f) == 1);
 #endif
+    }
     close_file_handle();
 }
 
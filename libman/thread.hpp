@@ -111,6 +111,8 @@ protected:
     double* dist_v;
     double cuml_dist;
     bool preallocd_data; // Is our data pre-allocated?
+    bool defer_read; // Allocate only, the coordinator fills local_data
+    const double* weights; // Per row weights (global ids). NULL if unweighted
 
     friend void* callback(void* arg);
 
@@ -121,7 +123,7 @@ protected:
             kbase::dist_t dist_metric=kbase::dist_t::EUCL) :
         node_id(node_id), thd_id(thd_id), ncol(ncol),
         start_rid(start_rid), local_clusters(nullptr), dist_metric(dist_metric),
-        preallocd_data(false) {
+        preallocd_data(false), defer_read(false), weights(NULL) {
 
         this->cluster_assignments = cluster_assignments;
         pthread_mutexattr_init(&mutex_attr);
@@ -181,6 +183,16 @@ public:
         dist_v = v;
     }
 
+    void set_weights_ptr(const double* w) {
+        weights = w;
+    }
+
+    const bool is_weighted() const { return weights != NULL; }
+
+    const double get_weight(const unsigned true_row_id) const {
+        return weights ? weights[true_row_id] : 1;
+    }
+
     const knor::thread_state_t get_state() const {
         return this->state;
     }
@@ -193,6 +205,14 @@ public:
         return local_data;
     }
 
+    double* get_local_data() {
+        return local_data;
+    }
+
+    void set_defer_read(const bool defer_read) {
+        this->defer_read = defer_read;
+    }
+
     const unsigned get_num_changed() const {
         return meta.num_changed;
     }
@@ -32,7 +32,7 @@ namespace knor {
     xmeans::xmeans(const int node_id, const unsigned thd_id,
             const unsigned start_rid, const unsigned nprocrows,
             const unsigned ncol, unsigned k,
-            hclust_map& g_hcltrs,
+            base::hcluster_arena::ptr g_hcltrs,
             unsigned* cluster_assignments,
             const std::string fn, base::dist_t dist_metric,
             const base::thd_safe_bool_vector::ptr cltr_active_vec,
@@ -73,21 +73,8 @@ void xmeans::partition_mean() {
 
 
 void xmeans::H_EM_step() {
-    local_hcltrs.clear();
-
-    nchanged.clear();
-
-    auto itr = g_hcltrs.get_iterator();
-    while (itr.has_next()) {
-        auto kv = itr.next();
-        if (kv.second->has_converged()) {
-            continue;
-        }
-
-        // No need to set id, zeroid, oneid because global hcltrs knows them
-        local_hcltrs[kv.first] = base::h_clusters::create(2, ncol);
-        local_hcltrs[kv.first]->clear(); // NOTE: Could be combined into ctor
-    }
+    // Allocated (first touch) by this thread & only grown
+    local_hcltrs.reset(g_hcltrs->nslots(), ncol);
 
     for (unsigned row = 0; row < nprocrows; row++) {
         // What cluster is this row in?
@@ -104,7 +91,7 @@ void xmeans::H_EM_step() {
 
         // Not active
         if (!cltr_active_vec->get(cluster_assignments[true_row_id]) ||
-                g_hcltrs[rpart_id]->has_converged())
+                g_hcltrs->has_converged(rpart_id))
             continue; // Skip it
 
         unsigned asgnd_clust = base::INVALID_CLUSTER_ID;
@@ -114,14 +101,14 @@ void xmeans::H_EM_step() {
 
         for (unsigned clust_idx = 0; clust_idx < 2; clust_idx++) {
             dist = base::dist_comp_raw<double>(&local_data[row*ncol],
-                    &(g_hcltrs[rpart_id]->
-                        get_means()[clust_idx*ncol]), ncol, dist_metric);
+                    g_hcltrs->get_mean(rpart_id, clust_idx), ncol,
+                    dist_metric);
             if (dist < best) {
                 best = dist;
                 if (clust_idx == 0) {
-                    asgnd_clust = g_hcltrs[rpart_id]->get_zeroid();
+                    asgnd_clust = g_hcltrs->get_zeroid(rpart_id);
                 } else {
-                    asgnd_clust = g_hcltrs[rpart_id]->get_oneid();
+                    asgnd_clust = g_hcltrs->get_oneid(rpart_id);
                     flag = 1;
                 }
             }
@@ -130,9 +117,10 @@ void xmeans::H_EM_step() {
         nearest_cdist[true_row_id] = best; // Update the best dist
         assert(asgnd_clust != base::INVALID_CLUSTER_ID);
 
+        const unsigned slot = g_hcltrs->get_slot(rpart_id);
         if (asgnd_clust != cluster_assignments[true_row_id])
-            nchanged[rpart_id]++;
-        local_hcltrs[rpart_id]->add_member(&local_data[row*ncol], flag);
+            local_hcltrs.nchanged[slot]++;
+        local_hcltrs.add_member(&local_data[row*ncol], slot, flag, ncol);
         cluster_assignments[true_row_id] = asgnd_clust;
     }
 }
@@ -33,7 +33,7 @@ class xmeans : public hclust {
         xmeans(const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
                 const unsigned ncol, unsigned k,
-                hclust_map& g_hcltrs,
+                base::hcluster_arena::ptr g_hcltrs,
                 unsigned* cluster_assignments,
                 const std::string fn, base::dist_t dist_metric,
                 const std::shared_ptr<base::thd_safe_bool_vector> cltr_active_vec,
@@ -45,7 +45,7 @@ class xmeans : public hclust {
                 const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
                 const unsigned ncol, unsigned k,
-                hclust_map& g_hcltrs,
+                base::hcluster_arena::ptr g_hcltrs,
                 unsigned* cluster_assignments, const std::string fn,
                 base::dist_t dist_metric,
                 const std::shared_ptr<base::thd_safe_bool_vector> cltr_active_vec,
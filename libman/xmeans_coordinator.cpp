@@ -20,6 +20,11 @@
 #include <random>
 #include <stdexcept>
 #include <math.h>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "xmeans_coordinator.hpp"
 
@@ -29,6 +34,8 @@
 #include "clusters.hpp"
 #include "hclust_id_generator.hpp"
 #include "thd_safe_bool_vector.hpp"
+#include "member_index.hpp"
+#include "hcluster_arena.hpp"
 
 namespace knor {
 
@@ -89,27 +96,17 @@ void xmeans_coordinator::combine_partition_means() {
      hcltrs -- children values
      nearest_cdist -- data point-assigned cluster dist
      partition dist -- data point-partition dist
+     psigma_sums, csigma_sums -- the above summed per child cluster
  */
-void xmeans_coordinator::bic(split_score_t& score,
-        std::unordered_map<unsigned, std::vector<unsigned>>& memb_cltrs) {
+void xmeans_coordinator::bic(split_score_t& score) {
 
     // Compute for parent
     double pK = 1; // parent K
     double cK = 2; // children K
     double N = cluster_assignment_counts[score.lid]
                         + cluster_assignment_counts[score.rid];
-    double psigma = 0;
-    double csigma = 0;
-
-    for (auto const& idx : memb_cltrs[score.lid]) {
-            psigma += partition_dist[idx];
-            csigma += nearest_cdist[idx];
-    }
-
-    for (auto const& idx : memb_cltrs[score.rid]) {
-            psigma += partition_dist[idx];
-            csigma += nearest_cdist[idx];
-    }
+    double psigma = psigma_sums[score.lid] + psigma_sums[score.rid];
+    double csigma = csigma_sums[score.lid] + csigma_sums[score.rid];
 
     // Parent
     if (N - pK > 0) {
@@ -145,43 +142,81 @@ void xmeans_coordinator::bic(split_score_t& score,
     }
 }
 
+// Each thread sums a contiguous block of rows, then clusters are reduced
+//  in parallel so the cost doesn't depend on how skewed the sizes are.
+void xmeans_coordinator::accumulate_sigmas() {
+    const size_t nclust = max_nodes;
+#ifdef _OPENMP
+    const int nparts = std::max(1, std::min(omp_get_max_threads(),
+                static_cast<int>(nrow / 4096) + 1));
+#else
+    const int nparts = 1;
+#endif
+    std::vector<double> part_sums(2*nparts*nclust, 0);
+    psigma_sums.resize(nclust);
+    csigma_sums.resize(nclust);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nparts)
+#endif
+    for (int part = 0; part < nparts; part++) {
+        double* psums = &part_sums[2*part*nclust];
+        double* csums = psums + nclust;
+        const size_t stop = (nrow*(part+1)) / nparts;
+        for (size_t rid = (nrow*part) / nparts; rid < stop; rid++) {
+            psums[cluster_assignments[rid]] += partition_dist[rid];
+            csums[cluster_assignments[rid]] += nearest_cdist[rid];
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t cid = 0; cid < nclust; cid++) {
+        double psigma = 0, csigma = 0;
+        for (int part = 0; part < nparts; part++) {
+            psigma += part_sums[2*part*nclust + cid];
+            csigma += part_sums[(2*part+1)*nclust + cid];
+        }
+        psigma_sums[cid] = psigma;
+        csigma_sums[cid] = csigma;
+    }
+}
+
 void xmeans_coordinator::compute_bic_scores(
-        std::vector<split_score_t>& bic_scores,
-    std::unordered_map<unsigned, std::vector<unsigned>>& memb_cltrs) {
+        std::vector<split_score_t>& bic_scores) {
 
     // Creates structures to store bic scores & cluster membership
-    auto itr = hcltrs.get_iterator();
-    while (itr.has_next()) {
-        auto kv = itr.next();
-        assert(kv.first == kv.second->get_id());
+    std::vector<size_t> ids;
+    hcltrs->get_keys(ids);
+    for (auto const& id : ids) {
 #ifndef BIND
 #if VERBOSE
         printf("BIC evaluation for pid: %lu, lid: %u, rid: %u\n",
-                kv.first, kv.second->get_zeroid(), kv.second->get_oneid());
+                id, hcltrs->get_zeroid(id), hcltrs->get_oneid(id));
 #endif
 #endif
-        bic_scores.push_back(split_score_t(kv.second->get_id(),
-                    kv.second->get_zeroid(), kv.second->get_oneid()));
+        bic_scores.push_back(split_score_t(id,
+                    hcltrs->get_zeroid(id), hcltrs->get_oneid(id)));
     }
 
-    // TODO: Slow
-    // Creates structures to hold cluster membership
-    accumulate(cluster_assignments, memb_cltrs);
+    accumulate_sigmas();
 
     // Computes the bic scores for each parent, child combo
 #ifdef _OPENMP
-#pragma omp parallel for shared (bic_scores) schedule (dynamic)
+#pragma omp parallel for shared (bic_scores)
 #endif
     for (size_t idx = 0; idx < bic_scores.size(); idx++) {
-        bic(bic_scores[idx], memb_cltrs);
+        bic(bic_scores[idx]);
     }
 }
 
 // NOTE: This modifies hcltrs
 void xmeans_coordinator::partition_decision() {
     std::vector<split_score_t> bic_scores;
-    std::unordered_map<unsigned, std::vector<unsigned>> memb_cltrs; // Parent
-    compute_bic_scores(bic_scores, memb_cltrs);
+    compute_bic_scores(bic_scores);
+    // Members of children whose split is rejected are reverted below
+    build_member_index();
 
     base::thd_safe_bool_vector::ptr remove_cache =
         base::thd_safe_bool_vector::create(bic_scores.size(), false);
@@ -199,13 +234,13 @@ void xmeans_coordinator::partition_decision() {
 #endif
 #endif
             // Move all in children clusters to (parent) partition
-            auto const& lmembers = memb_cltrs[score.lid];
-            for (size_t i = 0; i < memb_cltrs[score.lid].size(); i++)
-               cluster_assignments[lmembers[i]] = score.pid;
+            for (auto idx = memb_index->begin(score.lid);
+                    idx != memb_index->end(score.lid); idx++)
+               cluster_assignments[*idx] = score.pid;
 
-            auto const& rmembers = memb_cltrs[score.rid];
-            for (size_t i = 0; i < memb_cltrs[score.rid].size(); i++)
-               cluster_assignments[rmembers[i]] = score.pid;
+            for (auto idx = memb_index->begin(score.rid);
+                    idx != memb_index->end(score.rid); idx++)
+               cluster_assignments[*idx] = score.pid;
 
             // Revert the counts
             cluster_assignment_counts[score.pid] =
@@ -220,16 +255,6 @@ void xmeans_coordinator::partition_decision() {
             // Deactivate pid
             deactivate(score.pid);
             remove_cache->set(i, true);
-#ifdef _OPENMP
-#pragma omp critical
-#endif
-            {
-                ider->reclaim_id(score.lid);
-                ider->reclaim_id(score.rid);
-                final_centroids[score.pid] = std::vector<double>(
-                        cltrs->get_mean_rawptr(score.pid),
-                        cltrs->get_mean_rawptr(score.pid) + ncol);
-            }
         } else {
 #ifndef BIND
 #if VERBOSE
@@ -240,9 +265,17 @@ void xmeans_coordinator::partition_decision() {
         }
     }
 
+    // Ids are reclaimed in partition order so the ids handed out next are
+    //  the same on every run
     for (size_t i = 0; i < remove_cache->size(); i++) {
         if (remove_cache->get(i)) {
-            hcltrs.erase(bic_scores[i].pid);
+            auto const& score = bic_scores[i];
+            hcltrs->erase(score.pid);
+            ider->reclaim_id(score.lid);
+            ider->reclaim_id(score.rid);
+            final_centroids[score.pid] = std::vector<double>(
+                    cltrs->get_mean_rawptr(score.pid),
+                    cltrs->get_mean_rawptr(score.pid) + ncol);
         }
     }
 }
@@ -286,6 +319,7 @@ base::cluster_t xmeans_coordinator::run(
             printf("Iteration: %lu ", iter);
 #endif
             // Now pick between the cluster splits
+            hcltrs->assign_slots();
             wake4run(H_EM);
             wait4complete();
             update_clusters();
@@ -312,7 +346,7 @@ base::cluster_t xmeans_coordinator::run(
         init_splits(); // Initialize possible splits
 
         // Break when clusters are inactive due to size
-        if (hcltrs.keyless()) {
+        if (hcltrs->keyless()) {
             assert(steady_state()); // NOTE: Comment when benchmarking
 #ifndef BIND
             printf("\n\nSTEADY STATE EXIT!\n");
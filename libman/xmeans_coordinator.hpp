@@ -62,6 +62,9 @@ class xmeans_coordinator : public hclust_coordinator {
         std::vector<double> nearest_cdist; // Data point to centroid dist
         std::shared_ptr<base::clusters> cltrs; // Record partition -> data point
         bool compute_pdist; // Should threads comp the partition_dist this iter?
+        // Per cluster sums of partition_dist and nearest_cdist for the BIC
+        std::vector<double> psigma_sums;
+        std::vector<double> csigma_sums;
 
         static hclust_coordinator::ptr create(const std::string fn,
                 const size_t nrow,
@@ -87,26 +90,15 @@ class xmeans_coordinator : public hclust_coordinator {
                     min_clust_size));
         }
 
-        template <typename T>
-        void accumulate(const std::vector<T>& in,
-                std::unordered_map<T, std::vector<T>>& out) {
-            for (size_t i = 0; i < in.size(); i++) {
-                out[in[i]].push_back(i);
-            }
-        }
         virtual void build_thread_state() override;
         // Pass file handle to threads to read & numa alloc
         virtual base::cluster_t run(double* allocd_data=NULL,
             const bool numa_opt=false) override;
         virtual void combine_partition_means();
         virtual void partition_decision();
-        void bic(split_score_t& score,
-                std::unordered_map<unsigned, std::vector<unsigned>>& memb_cltrs);
-
-        void compute_bic_scores(
-                std::vector<split_score_t>& bic_scores,
-                std::unordered_map<unsigned,
-                std::vector<unsigned>>& memb_cltrs);
+        virtual void accumulate_sigmas();
+        void bic(split_score_t& score);
+        void compute_bic_scores(std::vector<split_score_t>& bic_scores);
 };
 }
 #endif